@@ -6,11 +6,17 @@ import os
 import re
 import ucd
 import math
+from typing import Callable
 from datetime import datetime
 
 IN_DIR = "template"
 OUT_DIR = "out"
 
+# log2 of the number of codepoints per block of a multi-stage table
+BLOCK_BITS = 8
+# Number of codepoint blocks spanning the entire unicode range
+BLOCKS = 0x110000 >> BLOCK_BITS
+
 # Matches a `$identifier` placeholder.
 _VAR_RE = re.compile(r"\$[a-zA-Z_]+")
 
@@ -42,6 +48,366 @@ def _gc_enum() -> str:
 
     return '\t' + "\n\t".join(out)
 
+def _gc_names() -> list[tuple[str, str]]:
+    """Every name of every general category, along with its enum value"""
+
+    return [
+        (name, gc.full_id)
+        for gc in ucd.GENERAL_CATEGORIES.values()
+        for name in (gc.shorthand, gc.full_name)
+    ]
+
+def _stages(name: str, ctype: str, values: list[int], width: int, fmt: Callable[[int], str]) -> str:
+    """Build a two-stage table of the given values, each block of which spans `width` entries.
+        The index `ucdb_<name>_index` maps every block of codepoints to one of the distinct blocks in `ucdb_<name>_blocks`.
+    """
+
+    blocks: dict[tuple[int, ...], int] = {}
+    index: list[int] = []
+
+    for b in range(BLOCKS):
+        block = tuple(values[b * width : (b + 1) * width])
+        index.append(blocks.setdefault(block, len(blocks)))
+
+    assert len(blocks) <= 256, f"too many distinct blocks for {name}"
+
+    def rows(items: list[str], per_row: int) -> str:
+        return ",\n\t".join(", ".join(items[r : r + per_row]) for r in range(0, len(items), per_row))
+
+    out = [f"const uint8_t ucdb_{name}_index[UCDB_BLOCKS] =", "{", "\t" + rows([str(i) for i in index], 32), "};", ""]
+    out += [f"const {ctype} ucdb_{name}_blocks[][{width}] =", "{"]
+    out.append(",\n".join("\t{\n\t\t" + rows([fmt(v) for v in block], 16).replace("\n", "\n\t") + "\n\t}" for block in blocks))
+    out.append("};")
+
+    return "\n".join(out)
+
+def _bitset(name: str, ranges: list[tuple[int, int]]) -> str:
+    """Build a two-stage bitset of the given codepoint ranges, packing the bits of every block into 64-bit words"""
+
+    bitmap = [0] * (0x110000 // 64)
+
+    for first, last in ranges:
+        for c in range(first, last + 1):
+            bitmap[c // 64] |= 1 << (c % 64)
+
+    return _stages(name, "uint64_t", bitmap, (1 << BLOCK_BITS) // 64, lambda w: f"0x{w:016X}")
+
+def _scripts() -> list[ucd.Script]:
+    """Every script in enum order: Unknown, Common and Inherited, followed by the rest by name"""
+
+    special = ["Zzzz", "Zyyy", "Zinh"]
+    rest = sorted((s for s in ucd.SCRIPTS.values() if s.shorthand not in special), key=lambda s: s.full_name)
+
+    return [ucd.SCRIPTS[s] for s in special] + rest
+
+def _script_enum() -> str:
+    """Build the `enum unic_script` body"""
+
+    out: list[str] = []
+
+    for sc in _scripts():
+        out.append(f"{sc.full_id},")
+
+        if sc.short_id != sc.full_id:
+            out.append(f"/** Alias for {sc.full_id} */")
+            out.append(f"{sc.short_id} = {sc.full_id},")
+
+    return '\t' + "\n\t".join(out)
+
+def _script_tables() -> str:
+    """Build the two-stage script table and the script extension lists"""
+
+    ids = { sc.full_name: i for i, sc in enumerate(_scripts()) }
+    short = { sc.shorthand: i for i, sc in enumerate(_scripts()) }
+    values = [0] * 0x110000
+
+    for first, last, name in ucd.SCRIPT_RANGES:
+        values[first : last + 1] = [ids[name]] * (last + 1 - first)
+
+    out = [_stages("script", "uint8_t", values, 1 << BLOCK_BITS, str), ""]
+    ext: list[str] = []
+    lists: list[str] = []
+
+    for first, last, names in ucd.SCRIPT_EXTENSIONS:
+        ext.append(f"{{ {to_hex_c(first)}, {to_hex_c(last)}, {len(lists)}, {len(names)} }}")
+        lists += [_scripts()[short[n]].full_id for n in names]
+
+    out += ["const struct ucdb_script_ext ucdb_script_ext[] =", "{", "\t" + ",\n\t".join(ext), "};", ""]
+    out += ["const uint8_t ucdb_script_ext_list[] =", "{", "\t" + ",\n\t".join(lists), "};"]
+
+    return "\n".join(out)
+
+def _digit_zeros() -> list[int]:
+    """The zero digit of every run of decimal digits.
+        Unicode guarantees that decimal digits are encoded in contiguous runs from 0 to 9.
+    """
+
+    zeros = [c.value for c in ucd.CODEPOINTS.values() if c.decimal_value == 0]
+
+    for z in zeros:
+        assert all(ucd.CODEPOINTS[z + d].decimal_value == d for d in range(10)), f"broken digit run at {to_hex_c(z)}"
+
+    return zeros
+
+# Grapheme_Cluster_Break values in enum order, with Extended_Pictographic as an additional value.
+# Characters with an Indic_Conjunct_Break value get classes of their own, which GB9c distinguishes from `Other` and `Extend`.
+GCB_CLASSES = [
+    "Other", "CR", "LF", "Control", "Extend", "ZWJ", "Regional_Indicator", "Prepend", "SpacingMark",
+    "L", "V", "T", "LV", "LVT", "Extended_Pictographic", "InCB_Consonant", "InCB_Linker", "InCB_Extend"
+]
+# Additional states of the grapheme cluster state machine: after `InCB=Consonant [InCB=Extend InCB=Linker]*` with at least one linker,
+# after `ExtPict Extend* ZWJ`, after a pair of regional indicators, and at the start of text.
+# The InCB_Consonant state continues through `InCB=Extend` characters that follow a consonant.
+GCB_STATES = GCB_CLASSES + ["InCB_Linked", "EP_ZWJ", "RI_PAIR", "Start"]
+# The Grapheme_Cluster_Break value of the Indic_Conjunct_Break classes and states, which every rule but GB9c sees
+GCB_BASE = { "InCB_Consonant": "Other", "InCB_Linker": "Extend", "InCB_Extend": "Extend", "InCB_Linked": "Other" }
+
+def _gcb_id(name: str) -> str:
+    return "GCB_" + name.upper()
+
+def _incb_extends(c: str) -> bool:
+    """Determines if a class continues a conjunct, i.e. is `InCB=Extend` or `InCB=Linker`"""
+    return c in ("InCB_Extend", "InCB_Linker") or (c == "ZWJ" and _incb_zwj())
+
+def _incb_zwj() -> bool:
+    """Determines if ZERO WIDTH JOINER is `InCB=Extend`, as it is since Unicode 15.1"""
+    return any(first <= 0x200D <= last for first, last in ucd.CORE_PROPERTIES.get("InCB=Extend", []))
+
+def _gcb_step(state: str, c: str) -> tuple[bool, str]:
+    """Applies the rules of UAX #29 to the current state and the class of the next character.
+        Extended_Pictographic followed by Extend characters keeps the Extended_Pictographic state.
+        @returns Whether there is a cluster boundary before the character, and the next state
+    """
+
+    conjunct, linked = state in ("InCB_Consonant", "InCB_Linked"), state == "InCB_Linked"
+    state, c0, c = GCB_BASE.get(state, state), c, GCB_BASE.get(c, c)
+
+    if state == "Start":
+        brk = True
+    elif state == "CR" and c == "LF":
+        brk = False # GB3
+    elif state in ("Control", "CR", "LF") or c in ("Control", "CR", "LF"):
+        brk = True # GB4, GB5
+    elif state == "L" and c in ("L", "V", "LV", "LVT"):
+        brk = False # GB6
+    elif state in ("LV", "V") and c in ("V", "T"):
+        brk = False # GB7
+    elif state in ("LVT", "T") and c == "T":
+        brk = False # GB8
+    elif c in ("Extend", "ZWJ", "SpacingMark") or state == "Prepend":
+        brk = False # GB9, GB9a, GB9b
+    elif conjunct and c0 == "InCB_Consonant":
+        brk = not linked # GB9c
+    elif state == "EP_ZWJ" and c == "Extended_Pictographic":
+        brk = False # GB11
+    elif state == "Regional_Indicator" and c == "Regional_Indicator":
+        brk = False # GB12, GB13
+    else:
+        brk = True # GB999
+
+    if c0 == "InCB_Consonant":
+        nxt = c0
+    elif conjunct and _incb_extends(c0):
+        nxt = "InCB_Linked" if linked or c0 == "InCB_Linker" else "InCB_Consonant"
+    elif c == "Extend" and state == "Extended_Pictographic":
+        nxt = state
+    elif c == "ZWJ" and state == "Extended_Pictographic":
+        nxt = "EP_ZWJ"
+    elif c == "Regional_Indicator" and state == "Regional_Indicator":
+        nxt = "RI_PAIR"
+    else:
+        nxt = c0
+
+    return brk, nxt
+
+def _grapheme_tables() -> str:
+    """Build the two-stage table of grapheme break classes and the transitions of the state machine"""
+
+    values = [0] * 0x110000
+
+    for first, last, name in ucd.GRAPHEME_BREAKS:
+        values[first : last + 1] = [GCB_CLASSES.index(name)] * (last + 1 - first)
+    for first, last in ucd.EXTENDED_PICTOGRAPHIC:
+        for c in range(first, last + 1):
+            assert values[c] == 0, f"{to_hex_c(c)} is Extended_Pictographic, but has a Grapheme_Cluster_Break"
+            values[c] = GCB_CLASSES.index("Extended_Pictographic")
+    # ZERO WIDTH JOINER keeps its own class, see `_incb_extends()`
+    for name in ("Consonant", "Linker", "Extend"):
+        for first, last in ucd.CORE_PROPERTIES.get("InCB=" + name, []):
+            for c in range(first, last + 1):
+                if GCB_CLASSES[values[c]] != "ZWJ":
+                    assert GCB_CLASSES[values[c]] == GCB_BASE["InCB_" + name], f"{to_hex_c(c)} is InCB={name}, but not {GCB_BASE['InCB_' + name]}"
+                    values[c] = GCB_CLASSES.index("InCB_" + name)
+
+    out = [_stages("gcb", "uint8_t", values, 1 << BLOCK_BITS, str), ""]
+    out += ["const uint8_t ucdb_gcb_dfa[GCB_STATES][GCB_CLASSES] =", "{"]
+    rows: list[str] = []
+
+    for state in GCB_STATES:
+        cells = []
+
+        for c in GCB_CLASSES:
+            brk, nxt = _gcb_step(state, c)
+            cells.append(("UCDB_BREAK | " if brk else "") + _gcb_id(nxt))
+
+        rows.append(f"\t[{_gcb_id(state)}] = {{ " + ", ".join(cells) + " }")
+
+    out.append(",\n".join(rows))
+    out.append("};")
+
+    return "\n".join(out)
+
+# Word_Break values in enum order
+WB_CLASSES = [
+    "Other", "CR", "LF", "Newline", "Extend", "ZWJ", "Regional_Indicator", "Format", "Katakana", "Hebrew_Letter",
+    "ALetter", "Single_Quote", "Double_Quote", "MidNumLet", "MidLetter", "MidNum", "Numeric", "ExtendNumLet", "WSegSpace"
+]
+
+def _word_tables() -> str:
+    """Build the two-stage table of Word_Break values, with UCDB_WB_EXTPICT set for Extended_Pictographic characters"""
+
+    values = [0] * 0x110000
+
+    for first, last, name in ucd.WORD_BREAKS:
+        values[first : last + 1] = [WB_CLASSES.index(name)] * (last + 1 - first)
+    for first, last in ucd.EXTENDED_PICTOGRAPHIC:
+        for c in range(first, last + 1):
+            values[c] |= 1 << bits(len(WB_CLASSES) - 1)
+
+    return _stages("wb", "uint8_t", values, 1 << BLOCK_BITS, str)
+
+# Normalization forms in the order of their bits in `ucdb_norm_blocks`
+NORM_FORMS = ["NFD", "NFKD", "NFC", "NFKC"]
+# Hangul syllable constants, as per section 3.12 of the Unicode standard
+HANGUL_S, HANGUL_L, HANGUL_V, HANGUL_T = 0xAC00, 0x1100, 0x1161, 0x11A7
+HANGUL_T_COUNT, HANGUL_N_COUNT, HANGUL_S_COUNT = 28, 21 * 28, 19 * 21 * 28
+
+def _decompose(c: int, compat: bool) -> list[int]:
+    """The full canonical or compatibility decomposition of a character"""
+
+    if HANGUL_S <= c < HANGUL_S + HANGUL_S_COUNT:
+        s = c - HANGUL_S
+        t = s % HANGUL_T_COUNT
+        return [HANGUL_L + s // HANGUL_N_COUNT, HANGUL_V + s % HANGUL_N_COUNT // HANGUL_T_COUNT] + ([HANGUL_T + t] if t else [])
+
+    cp = ucd.CODEPOINTS.get(c)
+
+    if cp is None or not cp.decomposition or (cp.compatibility and not compat):
+        return [c]
+
+    return [d for part in cp.decomposition for d in _decompose(part, compat)]
+
+def _ccc(c: int) -> int:
+    cp = ucd.CODEPOINTS.get(c)
+    return cp.combining_class if cp else 0
+
+def _compositions() -> list[tuple[int, int, int]]:
+    """Every primary composite as `(first, second, composite)`, in ascending order.
+        Hangul syllables are composed algorithmically instead.
+    """
+
+    excluded = { c for first, last in ucd.NORMALIZATION_PROPERTIES["Full_Composition_Exclusion"] for c in range(first, last + 1) }
+
+    return sorted(
+        (cp.decomposition[0], cp.decomposition[1], cp.value)
+        for cp in ucd.CODEPOINTS.values()
+        if len(cp.decomposition) == 2 and not cp.compatibility and cp.value not in excluded
+    )
+
+def _normalization_tables() -> str:
+    """Build the two-stage tables of combining classes, quick check flags and decompositions,
+        along with the decomposition data and the list of primary composites
+    """
+
+    def flags(name: str) -> set[int]:
+        return { c for key, ranges in ucd.NORMALIZATION_PROPERTIES.items() if key.startswith(name + "=") for first, last in ranges for c in range(first, last + 1) }
+
+    qc = { form: flags(form + "_QC") for form in NORM_FORMS }
+    maybe = { form: { c for first, last in ucd.NORMALIZATION_PROPERTIES.get(form + "_QC=M", []) for c in range(first, last + 1) } for form in NORM_FORMS }
+    ccc = [0] * 0x110000
+    norm = [0] * 0x110000
+    decomp = [0] * 0x110000
+
+    for cp in ucd.CODEPOINTS.values():
+        ccc[cp.value] = cp.combining_class
+
+    entries = ["{ 0, 0, 0, 0 }"]
+    chars: list[int] = []
+    offsets: dict[tuple[int, ...], int] = {}
+
+    def offset(seq: list[int]) -> int:
+        if tuple(seq) not in offsets:
+            offsets[tuple(seq)] = len(chars)
+            chars.extend(seq)
+        return offsets[tuple(seq)]
+
+    candidates = set(ucd.CODEPOINTS) | set(range(HANGUL_S, HANGUL_S + HANGUL_S_COUNT)) | set().union(*qc.values())
+
+    for c in sorted(candidates):
+        for i, form in enumerate(NORM_FORMS):
+            first = _decompose(c, "K" in form)[0]
+
+            if c in qc[form]:
+                norm[c] |= 1 << i
+            # a character is a boundary if nothing before it interacts with it or anything after it
+            if ccc[c] or ccc[first] or (form.endswith("C") and first in maybe[form]):
+                norm[c] |= 0x10 << i
+
+        cp = ucd.CODEPOINTS.get(c)
+
+        if cp and cp.decomposition:
+            canonical, compat = _decompose(c, False), _decompose(c, True)
+            canonical = canonical if canonical != [c] else []
+            decomp[c] = len(entries)
+            entries.append(f"{{ {offset(canonical) if canonical else 0}, {offset(compat)}, {len(canonical)}, {len(compat)} }}")
+
+    assert len(chars) < 0x10000 and len(entries) < 0x10000, "too much decomposition data"
+
+    out = [_stages("ccc", "uint8_t", ccc, 1 << BLOCK_BITS, str), ""]
+    out += [_stages("norm", "uint8_t", norm, 1 << BLOCK_BITS, lambda v: f"0x{v:02X}"), ""]
+    out += [_stages("decomp", "uint16_t", decomp, 1 << BLOCK_BITS, str), ""]
+    out += ["const struct ucdb_decomp ucdb_decomps[] =", "{", "\t" + ",\n\t".join(entries), "};", ""]
+    out += ["const uchar_t ucdb_decomp_chars[] =", "{"]
+    out.append("\t" + ",\n\t".join(", ".join(to_hex_c(c) for c in chars[r : r + 8]) for r in range(0, len(chars), 8)))
+    out += ["};", ""]
+    out += ["const struct ucdb_composition ucdb_compositions[] =", "{"]
+    out.append("\t" + ",\n\t".join(f"{{ {to_hex_c(a)}, {to_hex_c(b)}, {to_hex_c(c)} }}" for a, b, c in _compositions()))
+    out.append("};")
+
+    return "\n".join(out)
+
+def _collation_tables() -> str:
+    """Build the two-stage table of collation elements and the ranges of special implicit weights.
+        Every table entry is the offset of the character's elements in `ucdb_coll_elements`, shifted left by 5, plus their count.
+    """
+
+    values = [0] * 0x110000
+    elements: list[int] = []
+    offsets: dict[tuple[int, ...], int] = {}
+
+    for c, ces in sorted(ucd.COLLATION_ELEMENTS.items()):
+        packed = tuple((p << 16) | (s << 5) | t for p, s, t in ces)
+
+        # sort keys encode secondary weights as single bytes above the level separator
+        assert all(p < 0x10000 and (s == 0 or 0x20 <= s < 0x11E) and t < 0x20 for p, s, t in ces), f"collation weights of {to_hex_c(c)} out of range"
+        assert 0 < len(packed) < 32, f"too many collation elements for {to_hex_c(c)}"
+
+        if packed not in offsets:
+            offsets[packed] = len(elements)
+            elements.extend(packed)
+
+        values[c] = (offsets[packed] << 5) | len(packed)
+
+    out = [_stages("coll", "uint32_t", values, 1 << BLOCK_BITS, str), ""]
+    out += ["const uint32_t ucdb_coll_elements[] =", "{"]
+    out.append("\t" + ",\n\t".join(", ".join(f"0x{e:08X}" for e in elements[r : r + 8]) for r in range(0, len(elements), 8)))
+    out += ["};", ""]
+    out += ["const struct ucdb_implicit ucdb_coll_implicit[] =", "{"]
+    out.append("\t" + ",\n\t".join(f"{{ {to_hex_c(a)}, {to_hex_c(b)}, {to_hex_c(base)} }}" for a, b, base in ucd.IMPLICIT_WEIGHTS))
+    out.append("};")
+
+    return "\n".join(out)
+
 def expand(key : str) -> str:
     """ Computes the replacement of the given placeholder key """
     super_categories = [g for g in ucd.GENERAL_CATEGORIES.values() if g.is_super]
@@ -63,11 +429,51 @@ def expand(key : str) -> str:
             return str(super_bits + sub_bits)
         case "GC":
             return _gc_enum()
+        case "GC_NAMES":
+            return '\t' + ',\n\t'.join([f'{{ "{name}", {id} }}' for name, id in _gc_names()])
+        case "gc_names":
+            return str(len(_gc_names()))
         case "UCDB":
             return '\t' + ',\n\t'.join([
                 f"{{ {to_hex_c(chr.value)}, {ucd.GeneralCategory.PREFIX}_{chr.general_category.upper()}, {chr.simple_uppercase_delta}, {chr.simple_lowercase_delta} }}"
                 for chr in ucd.CODEPOINTS.values()
             ])
+        case "block_bits":
+            return str(BLOCK_BITS)
+        case "XID_TABLES":
+            return _bitset("xid_start", ucd.CORE_PROPERTIES["XID_Start"]) + "\n\n" \
+                + _bitset("xid_continue", ucd.CORE_PROPERTIES["XID_Continue"])
+        case "DIGIT_ZEROS":
+            zeros = [to_hex_c(z) for z in _digit_zeros()]
+            return '\t' + ',\n\t'.join(", ".join(zeros[r : r + 8]) for r in range(0, len(zeros), 8))
+        case "digit_runs":
+            return str(len(_digit_zeros()))
+        case "SCRIPTS":
+            return _script_enum()
+        case "scripts":
+            return str(len(_scripts()))
+        case "SCRIPT_TABLES":
+            return _script_tables()
+        case "script_exts":
+            return str(len(ucd.SCRIPT_EXTENSIONS))
+        case "GCB":
+            return "\t" + ",\n\t".join(_gcb_id(s) for s in GCB_STATES)
+        case "GRAPHEME_TABLES":
+            return _grapheme_tables()
+        case "WB":
+            return "\t" + ",\n\t".join("WB_" + c.upper() for c in WB_CLASSES)
+        case "wb_bits":
+            return str(bits(len(WB_CLASSES) - 1))
+        case "WORD_TABLES":
+            return _word_tables()
+        case "NORMALIZATION_TABLES":
+            return _normalization_tables()
+        case "COLLATION_TABLES":
+            return _collation_tables()
+        case "implicits":
+            return str(len(ucd.IMPLICIT_WEIGHTS))
+        case "compositions":
+            return str(len(_compositions()))
         case "count":
             return str(len(ucd.CODEPOINTS))
         case "ucd_bits":
@@ -27,6 +27,46 @@ const struct ucdb_entry *ucdb_get(uchar_t u)
 	return NULL;
 }
 
+const struct ucdb_script_ext *ucdb_script_ext_get(uchar_t u)
+{
+	size_t l = 0, r = UCDB_SCRIPT_EXTS;
+
+	while(l < r)
+	{
+		size_t m = (l + r) / 2;
+		if(ucdb_script_ext[m].last < u)
+			l = m + 1;
+		else if(ucdb_script_ext[m].first > u)
+			r = m;
+		else
+			return ucdb_script_ext + m;
+	}
+
+	return NULL;
+}
+
+const struct ucdb_class_name ucdb_class_names[] =
+{
+$GC_NAMES
+};
+
+const uchar_t ucdb_digit_zeros[] =
+{
+$DIGIT_ZEROS
+};
+
+$XID_TABLES
+
+$SCRIPT_TABLES
+
+$GRAPHEME_TABLES
+
+$WORD_TABLES
+
+$NORMALIZATION_TABLES
+
+$COLLATION_TABLES
+
 const struct ucdb_entry ucdb[] =
 {
 $UCDB
@@ -8,6 +8,22 @@
 /** The highest character with its UCDB index and codepoint are equal */
 #define UCDB_DIRECT_MAX $max_direct
 
+/** log2 of the number of codepoints per block of a multi-stage table */
+#define UCDB_BLOCK_BITS $block_bits
+/** The number of blocks of a multi-stage table */
+#define UCDB_BLOCKS (0x110000 >> UCDB_BLOCK_BITS)
+/** The number of 64-bit words per block of a bitset */
+#define UCDB_BLOCK_WORDS ((1 << UCDB_BLOCK_BITS) / 64)
+
+/** The amount of entries in ucdb_digit_zeros */
+#define UCDB_DIGIT_RUNS $digit_runs
+
+/** The amount of entries in ucdb_script_ext */
+#define UCDB_SCRIPT_EXTS $script_exts
+
+/** The amount of entries in ucdb_class_names */
+#define UCDB_CLASS_NAMES $gc_names
+
 /** The type of a ucdb entry */
 struct ucdb_entry
 {
@@ -22,4 +38,182 @@ struct ucdb_entry
 extern const struct ucdb_entry ucdb[];
 
 /** Gets the ucdb entry for the given character */
-const struct ucdb_entry *ucdb_get(uchar_t u);
\ No newline at end of file
+const struct ucdb_entry *ucdb_get(uchar_t u);
+
+/** Associates a general category with one of its names as per PropertyValueAliases.txt */
+struct ucdb_class_name
+{
+	const char *name;
+	enum unic_gc class;
+};
+
+/** Every short and long name of every general category */
+extern const struct ucdb_class_name ucdb_class_names[];
+
+/** The zero of every run of decimal digits (Numeric_Type=Decimal) in ascending order.
+	Every run is contiguous and encodes the values 0 through 9.
+*/
+extern const uchar_t ucdb_digit_zeros[];
+
+/** Maps blocks of codepoints to blocks of `ucdb_xid_start_blocks` */
+extern const uint8_t ucdb_xid_start_index[UCDB_BLOCKS];
+/** Distinct blocks of the XID_Start bitset */
+extern const uint64_t ucdb_xid_start_blocks[][UCDB_BLOCK_WORDS];
+/** Maps blocks of codepoints to blocks of `ucdb_xid_continue_blocks` */
+extern const uint8_t ucdb_xid_continue_index[UCDB_BLOCKS];
+/** Distinct blocks of the XID_Continue bitset */
+extern const uint64_t ucdb_xid_continue_blocks[][UCDB_BLOCK_WORDS];
+
+/** Looks up a codepoint in a two-stage bitset */
+#define UCDB_BITSET(name, c) ((c) < 0x110000 \
+	&& (ucdb_##name##_blocks[ucdb_##name##_index[(c) >> UCDB_BLOCK_BITS]][((c) >> 6) % UCDB_BLOCK_WORDS] >> ((c) % 64)) & 1)
+
+/** Maps blocks of codepoints to blocks of `ucdb_script_blocks` */
+extern const uint8_t ucdb_script_index[UCDB_BLOCKS];
+/** Distinct blocks of the Script property, as `enum unic_script` values */
+extern const uint8_t ucdb_script_blocks[][1 << UCDB_BLOCK_BITS];
+
+/** The Script_Extensions of a range of characters */
+struct ucdb_script_ext
+{
+	uchar_t first, last;
+	/** Index of the first script in `ucdb_script_ext_list` */
+	uint16_t offset;
+	/** Number of scripts */
+	uint8_t count;
+};
+
+/** Every range of characters with explicit Script_Extensions, in ascending order */
+extern const struct ucdb_script_ext ucdb_script_ext[];
+/** The `enum unic_script` values referenced by `ucdb_script_ext` */
+extern const uint8_t ucdb_script_ext_list[];
+
+/** Gets the Script_Extensions of the given character, or NULL if they only consist of its Script property */
+const struct ucdb_script_ext *ucdb_script_ext_get(uchar_t u);
+
+/** Grapheme_Cluster_Break values, followed by additional states of the grapheme cluster state machine */
+enum ucdb_gcb
+{
+$GCB
+};
+
+/** The number of character classes of the grapheme cluster state machine */
+#define GCB_CLASSES (GCB_INCB_EXTEND + 1)
+/** The number of states of the grapheme cluster state machine */
+#define GCB_STATES (GCB_START + 1)
+/** Set in a transition of a segmentation state machine if there is a boundary before the character */
+#define UCDB_BREAK 0x80
+
+/** Maps blocks of codepoints to blocks of `ucdb_gcb_blocks` */
+extern const uint8_t ucdb_gcb_index[UCDB_BLOCKS];
+/** Distinct blocks of the Grapheme_Cluster_Break property, as `enum ucdb_gcb` values.
+	Extended_Pictographic characters are GCB_EXTENDED_PICTOGRAPHIC, and characters with an Indic_Conjunct_Break are GCB_INCB_*.
+*/
+extern const uint8_t ucdb_gcb_blocks[][1 << UCDB_BLOCK_BITS];
+/** Transitions of the grapheme cluster state machine, indexed by state and character class.
+	Every entry is the next state, possibly combined with UCDB_BREAK.
+*/
+extern const uint8_t ucdb_gcb_dfa[GCB_STATES][GCB_CLASSES];
+
+/** Word_Break values */
+enum ucdb_wb
+{
+$WB
+};
+
+/** Set in a `ucdb_wb_blocks` entry for Extended_Pictographic characters */
+#define UCDB_WB_EXTPICT (1 << $wb_bits)
+
+/** Maps blocks of codepoints to blocks of `ucdb_wb_blocks` */
+extern const uint8_t ucdb_wb_index[UCDB_BLOCKS];
+/** Distinct blocks of the Word_Break property, as `enum ucdb_wb` values possibly combined with UCDB_WB_EXTPICT */
+extern const uint8_t ucdb_wb_blocks[][1 << UCDB_BLOCK_BITS];
+
+/** Normalization forms, in the order of their flags in `ucdb_norm_blocks` */
+enum ucdb_norm_form
+{
+	UCDB_NFD,
+	UCDB_NFKD,
+	UCDB_NFC,
+	UCDB_NFKC
+};
+
+/** Set in a `ucdb_norm_blocks` entry if the character's quick check property for a form isn't Yes */
+#define UCDB_NORM_QC(form) (1 << (form))
+/** Set in a `ucdb_norm_blocks` entry if normalizing to a form may change the text around a character,
+	i.e. if it is no boundary that text before and after it can be normalized independently at.
+	Always set for characters with a nonzero combining class.
+*/
+#define UCDB_NORM_STICKY(form) (0x10 << (form))
+
+/** The amount of entries in ucdb_compositions */
+#define UCDB_COMPOSITIONS $compositions
+
+/** The full decompositions of a character, as ranges of `ucdb_decomp_chars` */
+struct ucdb_decomp
+{
+	/** Offset of the canonical decomposition */
+	uint16_t canonical;
+	/** Offset of the compatibility decomposition */
+	uint16_t compat;
+	/** Length of the canonical decomposition. 0 if the character only has a compatibility decomposition. */
+	uint8_t canonicalLength;
+	/** Length of the compatibility decomposition */
+	uint8_t compatLength;
+};
+
+/** A primary composite and the pair of characters it is canonically equivalent to */
+struct ucdb_composition
+{
+	uchar_t first, second, composite;
+};
+
+/** Maps blocks of codepoints to blocks of `ucdb_ccc_blocks` */
+extern const uint8_t ucdb_ccc_index[UCDB_BLOCKS];
+/** Distinct blocks of the Canonical_Combining_Class property */
+extern const uint8_t ucdb_ccc_blocks[][1 << UCDB_BLOCK_BITS];
+/** Maps blocks of codepoints to blocks of `ucdb_norm_blocks` */
+extern const uint8_t ucdb_norm_index[UCDB_BLOCKS];
+/** Distinct blocks of quick check flags, as combinations of UCDB_NORM_QC and UCDB_NORM_STICKY */
+extern const uint8_t ucdb_norm_blocks[][1 << UCDB_BLOCK_BITS];
+/** Maps blocks of codepoints to blocks of `ucdb_decomp_blocks` */
+extern const uint8_t ucdb_decomp_index[UCDB_BLOCKS];
+/** Distinct blocks of indices into `ucdb_decomps`. 0 for characters without a decomposition, including Hangul syllables. */
+extern const uint16_t ucdb_decomp_blocks[][1 << UCDB_BLOCK_BITS];
+/** The full decompositions of every character with a decomposition mapping */
+extern const struct ucdb_decomp ucdb_decomps[];
+/** The characters referenced by `ucdb_decomps` */
+extern const uchar_t ucdb_decomp_chars[];
+/** Every primary composite except Hangul syllables, ordered by `first`, then `second` */
+extern const struct ucdb_composition ucdb_compositions[];
+
+/** The amount of entries in ucdb_coll_implicit */
+#define UCDB_COLL_IMPLICITS $implicits
+
+/** Extracts the weights of a collation element in `ucdb_coll_elements` */
+#define UCDB_COLL_PRIMARY(e) ((e) >> 16)
+#define UCDB_COLL_SECONDARY(e) (((e) >> 5) & 0x1FF)
+#define UCDB_COLL_TERTIARY(e) ((e) & 0x1F)
+
+/** A range of characters whose implicit primary weights have a dedicated base */
+struct ucdb_implicit
+{
+	uchar_t first, last;
+	/** The first half of the implicit primary weight */
+	uint16_t base;
+};
+
+/** Maps blocks of codepoints to blocks of `ucdb_coll_blocks` */
+extern const uint8_t ucdb_coll_index[UCDB_BLOCKS];
+/** Distinct blocks of the DUCET, as the offset of a character's collation elements in `ucdb_coll_elements` shifted left by 5, plus their count.
+	0 for characters with implicit weights.
+*/
+extern const uint32_t ucdb_coll_blocks[][1 << UCDB_BLOCK_BITS];
+/** Collation elements of the DUCET, packed as the primary weight shifted left by 16, the secondary weight shifted left by 5, and the tertiary weight */
+extern const uint32_t ucdb_coll_elements[];
+/** Ranges of characters with special implicit weights, in ascending order */
+extern const struct ucdb_implicit ucdb_coll_implicit[];
+
+/** Looks up a codepoint in a two-stage table */
+#define UCDB_STAGES(name, c) ((c) < 0x110000 \
+	? ucdb_##name##_blocks[ucdb_##name##_index[(c) >> UCDB_BLOCK_BITS]][(c) % (1 << UCDB_BLOCK_BITS)] : 0)
@@ -34,6 +34,15 @@ enum unic_gc
 $GC
 };
 
+/** The amount of distinct enum unic_script values */
+#define UNIC_SCRIPTS $scripts
+
+/** A unicode script, as per the Script property */
+enum unic_script
+{
+$SCRIPTS
+};
+
 /** Specified the size of a string.*/
 typedef struct
 {
@@ -145,6 +154,123 @@ NONNULL_UNIC(3)
 */
 extern void u8nenc(uchar_t uc, size_t l, char *buf);
 
+NONNULL_UNIC(1)
+/** Transcodes little-endian UTF-16 to utf-8.
+	Unpaired surrogates and an incomplete final code unit are replaced with U+FFFD.
+
+	@param src The UTF-16 encoded source. Need not be aligned. May not be NULL.
+	@param size Size of `src` in bytes
+	@param dst The destination buffer, may be NULL to just check the resulting size. The function behaves identical otherwise.
+	@param cap Capacity of `dst` in bytes.
+	@param nulTerminate If true, content written to `dst` is NUL terminated, meaning that NUL characters are over-encoded as UNUL, and a closing NUL terminator is appended.
+	@returns The size of the string written to `dst`. The `*exact` flags are set iff. the output was not truncated.
+			 If `nulTerminate` is set, the byte count includes the final NUL terminator, but the char count does not.
+	@see u8_strmap
+*/
+extern u8size_t u8_from_utf16le(const void *src, size_t size, char *dst, size_t cap, bool nulTerminate);
+
+NONNULL_UNIC(1)
+/** Variant of `u8_from_utf16le()` for big-endian UTF-16 */
+extern u8size_t u8_from_utf16be(const void *src, size_t size, char *dst, size_t cap, bool nulTerminate);
+
+NONNULL_UNIC(1)
+/** Variant of `u8_from_utf16le()` for little-endian UTF-32.
+	Surrogates and code units above U+10FFFF are replaced with U+FFFD.
+*/
+extern u8size_t u8_from_utf32le(const void *src, size_t size, char *dst, size_t cap, bool nulTerminate);
+
+NONNULL_UNIC(1)
+/** Variant of `u8_from_utf32le()` for big-endian UTF-32 */
+extern u8size_t u8_from_utf32be(const void *src, size_t size, char *dst, size_t cap, bool nulTerminate);
+
+NONNULL_UNIC(1)
+/** Transcodes a utf-8 encoded string to little-endian UTF-16.
+	Characters outside the BMP are written as surrogate pairs. Decoded surrogates are replaced with U+FFFD.
+
+	@param str The source string, may not be NULL.
+	@param dst The destination buffer, may be NULL to just check the resulting size. Need not be aligned.
+	@param cap Capacity of `dst` in bytes.
+	@param nulTerminate If true, a closing NUL code unit is appended.
+	@returns The size of the content written to `dst`, counting bytes of UTF-16 and characters.
+			 The `*exact` flags are set iff. the output was not truncated. The byte count includes a NUL terminator, the char count does not.
+*/
+extern u8size_t u8_to_utf16le(const char *str, void *dst, size_t cap, bool nulTerminate);
+
+NONNULL_UNIC(1)
+/** Variant of `u8_to_utf16le()` for big-endian UTF-16 */
+extern u8size_t u8_to_utf16be(const char *str, void *dst, size_t cap, bool nulTerminate);
+
+NONNULL_UNIC(1)
+/** Variant of `u8_to_utf16le()` for little-endian UTF-32 */
+extern u8size_t u8_to_utf32le(const char *str, void *dst, size_t cap, bool nulTerminate);
+
+NONNULL_UNIC(1)
+/** Variant of `u8_to_utf16le()` for big-endian UTF-32 */
+extern u8size_t u8_to_utf32be(const char *str, void *dst, size_t cap, bool nulTerminate);
+
+/** Variant of `u8_to_utf16le()` on a sized prefix */
+extern u8size_t u8z_to_utf16le(const char *str, u8size_t size, void *dst, size_t cap, bool nulTerminate);
+
+/** Variant of `u8_to_utf16be()` on a sized prefix */
+extern u8size_t u8z_to_utf16be(const char *str, u8size_t size, void *dst, size_t cap, bool nulTerminate);
+
+/** Variant of `u8_to_utf32le()` on a sized prefix */
+extern u8size_t u8z_to_utf32le(const char *str, u8size_t size, void *dst, size_t cap, bool nulTerminate);
+
+/** Variant of `u8_to_utf32be()` on a sized prefix */
+extern u8size_t u8z_to_utf32be(const char *str, u8size_t size, void *dst, size_t cap, bool nulTerminate);
+
+NONNULL_UNIC(1)
+/** Transcodes ISO 8859-1 (Latin-1) to utf-8. Every byte maps to the character of the same value.
+
+	@param src The Latin-1 encoded source. May not be NULL.
+	@param size Size of `src` in bytes
+	@param dst The destination buffer, may be NULL to just check the resulting size. The function behaves identical otherwise.
+	@param cap Capacity of `dst` in bytes.
+	@param nulTerminate If true, content written to `dst` is NUL terminated, meaning that NUL characters are over-encoded as UNUL, and a closing NUL terminator is appended.
+	@returns The size of the string written to `dst`. The `*exact` flags are set iff. the output was not truncated.
+			 If `nulTerminate` is set, the byte count includes the final NUL terminator, but the char count does not.
+	@see u8_strmap
+*/
+extern u8size_t u8_from_latin1(const char *src, size_t size, char *dst, size_t cap, bool nulTerminate);
+
+NONNULL_UNIC(1)
+/** Variant of `u8_from_latin1()` for Windows-1252.
+	The five bytes Windows-1252 leaves undefined map to the C1 controls of the same value, just like invalid bytes in `u8dec()`.
+*/
+extern u8size_t u8_from_cp1252(const char *src, size_t size, char *dst, size_t cap, bool nulTerminate);
+
+NONNULL_UNIC(1)
+/** Repairs text that mixes utf-8 and Windows-1252 in a single pass.
+	Well-formed utf-8 sequences are kept, every other byte is read as Windows-1252.
+	Unlike `u8dec()`, over-encoded characters (except UNUL), surrogates and characters above U+10FFFF count as malformed.
+	@see u8_from_cp1252
+*/
+extern u8size_t u8_repair_cp1252(const char *src, size_t size, char *dst, size_t cap, bool nulTerminate);
+
+NONNULL_UNIC(1)
+/** Transcodes a utf-8 encoded string to ISO 8859-1 (Latin-1).
+	Characters above U+00FF are replaced with '?'.
+
+	@param str The source string, may not be NULL.
+	@param dst The destination buffer, may be NULL to just check the resulting size. The function behaves identical otherwise.
+	@param cap Capacity of `dst` in bytes.
+	@param nulTerminate If true, a closing NUL terminator is appended, and NUL characters are replaced with '?'.
+	@returns The size of the content written to `dst`. The `*exact` flags are set iff. the output was not truncated.
+			 If `nulTerminate` is set, the byte count includes the final NUL terminator, but the char count does not.
+*/
+extern u8size_t u8_to_latin1(const char *str, char *dst, size_t cap, bool nulTerminate);
+
+NONNULL_UNIC(1)
+/** Variant of `u8_to_latin1()` for Windows-1252. Characters it can't represent are replaced with '?'. */
+extern u8size_t u8_to_cp1252(const char *str, char *dst, size_t cap, bool nulTerminate);
+
+/** Variant of `u8_to_latin1()` on a sized prefix */
+extern u8size_t u8z_to_latin1(const char *str, u8size_t size, char *dst, size_t cap, bool nulTerminate);
+
+/** Variant of `u8_to_cp1252()` on a sized prefix */
+extern u8size_t u8z_to_cp1252(const char *str, u8size_t size, char *dst, size_t cap, bool nulTerminate);
+
 // #endregion utf8.c
 
 // #region util.c
@@ -179,6 +305,37 @@ extern bool uclass_is(enum unic_gc general, enum unic_gc specific);
 */
 extern bool uchar_is(uchar_t chr, enum unic_gc class);
 
+/** Determines if a character may start an identifier, as per the XID_Start property of UAX #31.
+	Looks up a two-stage bitset in constant time.
+*/
+extern bool uchar_isIdStart(uchar_t c);
+
+/** Determines if a character may continue an identifier, as per the XID_Continue property of UAX #31.
+	Looks up a two-stage bitset in constant time.
+*/
+extern bool uchar_isIdContinue(uchar_t c);
+
+/** Retrieves the Script property of a character in constant time
+	@param c The character
+	@returns Its script, USCRIPT_COMMON or USCRIPT_INHERITED if it's shared by many scripts,
+	or USCRIPT_UNKNOWN if it is unassigned or invalid.
+*/
+extern enum unic_script uchar_script(uchar_t c);
+
+/** Determines if a character is used with a script, as per its Script_Extensions property.
+	For example, U+0964 DEVANAGARI DANDA has the script USCRIPT_COMMON but is used with Devanagari, Bengali and others.
+	@param c The character
+	@param script A script
+	@returns Whether `script` is in the character's Script_Extensions, which default to its Script property
+*/
+extern bool uchar_hasScript(uchar_t c, enum unic_script script);
+
+/** Determines the value of a decimal digit, i.e. a character in the DECIMAL_NUMBER general category
+	@param c The character
+	@returns Its numeric value from 0 to 9, or -1 if it isn't a decimal digit
+*/
+extern int uchar_digit(uchar_t c);
+
 /** Determines if the given unicode character is whitespace
 	@param c The character
 	@returns c is in the SEPARATOR general category,
@@ -198,6 +355,24 @@ extern uchar_t uchar_lower(uchar_t c);
 */
 extern uchar_t uchar_upper(uchar_t c);
 
+/** Returns the case-folding key of the given character, i.e. the lowercase mapping of its uppercase mapping.
+	Unlike `uchar_alike()`, equality of keys is transitive, so they order characters consistently, e.g. U+017F LATIN SMALL LETTER LONG S,
+	`s` and `S` share a key.
+	@param c The character
+	@returns Its case-folding key
+*/
+extern uchar_t uchar_fold(uchar_t c);
+
+NONNULL_UNIC(1,3)
+/** Looks up a general category by its short (`Lu`) or long (`Uppercase_Letter`) name.
+	Names are matched loosely, i.e. ignoring case, underscores, hyphens and spaces.
+	@param name The name. Need not be NUL-terminated.
+	@param len The length of `name`, in bytes
+	@param out Overwritten with the category on success
+	@returns Whether the name is known
+*/
+extern bool uclass_byname(const char *name, size_t len, enum unic_gc *out);
+
 // #endregion util.c
 
 // #region u8string.c
@@ -362,6 +537,23 @@ NONNULL_UNIC(1,2)
 */
 extern bool u8_prefixI(const char *prefix, const char *full);
 
+NONNULL_UNIC(1,2)
+/** Compares two utf-8 encoded strings in codepoint order.
+	Identical byte sequences are skipped without decoding, so for normalized strings this is as fast as `memcmp`.
+	A string compares less than every string it is a proper prefix of.
+	@param a A string. May not be NULL.
+	@param b Another string. May not be NULL.
+	@returns A negative number, zero, or a positive number if `a` is respectively less than, equal to, or greater than `b`
+*/
+extern int u8_strcmp(const char *a, const char *b);
+
+NONNULL_UNIC(1,2)
+/** Case-insensitive `u8_strcmp`.
+	Characters are ordered by their case-folding key (see `uchar_fold()`), which is a consistent order unlike `uchar_alike()`.
+	@returns Zero iff. both strings consist of characters with the same case-folding keys
+*/
+extern int u8_strcmpI(const char *a, const char *b);
+
 NONNULL_UNIC(1)
 /** Determines if the given utf-8 encoded string is normalized utf-8.
 	This means that every character is encoded with its normal length.
@@ -435,6 +627,15 @@ extern uint64_t u8_hash(const char *str);
 NONNULL_UNIC(2)
 extern uint64_t u8_hashF(const char *str, uchar_t (*map_f)(uchar_t));
 
+NONNULL_UNIC(1)
+/** Determines the length of the identifier at the start of a string.
+	An identifier is an underscore or XID_Start character, followed by any number of XID_Continue characters (see `uchar_isIdStart()`).
+	Runs of ASCII letters, digits and underscores are scanned 16 bytes at a time.
+	@param str The string
+	@returns The exact size of the identifier, in both bytes and characters. Zero if the string doesn't start with an identifier.
+*/
+extern u8size_t u8_scan_ident(const char *str);
+
 // #endregion u8string.c
 
 // #region u8sized.c
@@ -504,6 +705,14 @@ extern bool u8z_prefix(const char *prefix, u8size_t n, const char *full, u8size_
 /** Variant of `u8_prefixI()` over sized prefixes */
 extern bool u8z_prefixI(const char *prefix, u8size_t n, const char *full, u8size_t m);
 
+/** Variant of `u8_strcmp()` over sized prefixes.
+	The common prefix is only skipped bytewise if neither size has a character limit.
+*/
+extern int u8z_strcmp(const char *a, u8size_t n, const char *b, u8size_t m);
+
+/** Variant of `u8_strcmpI()` over sized prefixes */
+extern int u8z_strcmpI(const char *a, u8size_t n, const char *b, u8size_t m);
+
 /** Variant of `u8_isnorm()` on a sized prefix */
 extern bool u8z_isnorm(const char *str, u8size_t size);
 
@@ -527,5 +736,743 @@ extern uint64_t u8z_hash(const char *str, u8size_t size);
 NONNULL_UNIC(3)
 extern uint64_t u8z_hashF(const char *str, u8size_t size, uchar_t (*map_f)(uchar_t));
 
+/** Variant of `u8_scan_ident()` on a sized prefix */
+extern u8size_t u8z_scan_ident(const char *str, u8size_t size);
+
 // #endregion u8sized.c
+
+// #region u8buf.c
+
+/** A growable output buffer for UTF-8 text.
+	Grows by amortized doubling, starting out in optional caller-provided storage.
+	Create with `u8buf_init()`, release with `u8buf_finish()` or `u8buf_free()`.
+*/
+typedef struct
+{
+	/** Start of the buffer's content. Either `arena`, heap memory owned by the buffer, or NULL. */
+	char *bytes;
+	/** Number of bytes written to `bytes` */
+	size_t byteCount;
+	/** Number of characters written to `bytes` */
+	size_t charCount;
+	/** Capacity of `bytes` */
+	size_t cap;
+	/** Caller-provided storage used before any heap allocation. Never freed by the buffer. */
+	char *arena;
+	/** Capacity of `arena` */
+	size_t arenaSize;
+	/** If set, NULs are over-encoded as UNUL, and `u8buf_finish()` appends a NUL terminator. */
+	bool nulTerminate;
+} u8buf_t;
+
+/** Creates an empty buffer.
+	@param arena Storage to use until it runs out, may be NULL to allocate on first write.
+	@param size Capacity of `arena` in bytes
+	@param nulTerminate If true, NUL characters written to the buffer are over-encoded as UNUL, and the finished buffer is NUL-terminated.
+	@returns An empty buffer. Does not allocate.
+*/
+extern u8buf_t u8buf_init(char *arena, size_t size, bool nulTerminate);
+
+NONNULL_UNIC(1)
+/** Releases any heap memory held by a buffer and empties it.
+	The buffer may be reused afterwards.
+*/
+extern void u8buf_free(u8buf_t *buf);
+
+NONNULL_UNIC(1)
+/** Ensures that at least `n` more bytes can be written to a buffer without reallocating.
+	@returns 0 on success
+	@returns -1 and sets errno on allocation failure. The buffer is left unchanged.
+*/
+extern int u8buf_reserve(u8buf_t *buf, size_t n);
+
+NONNULL_UNIC(1)
+/** Appends a single character to a buffer.
+	@returns 0 on success
+	@returns -1 and sets errno on allocation failure
+*/
+extern int u8buf_appendc(u8buf_t *buf, uchar_t c);
+
+NONNULL_UNIC(1)
+/** Appends a normalized copy of a string to a buffer.
+	@see u8z_strcpy_into
+	@returns 0 on success
+	@returns -1 and sets errno on allocation failure. The content appended so far is kept.
+*/
+extern int u8buf_append(u8buf_t *buf, const char *str, u8size_t size);
+
+NONNULL_UNIC(1)
+/** Finishes a buffer, handing its content over to the caller.
+	Appends a NUL terminator if the buffer was created with `nulTerminate` set.
+	The buffer is emptied and detached from its arena afterwards.
+
+	@param out_size Unless NULL, overwritten with the size of the result.
+			If `nulTerminate` is set, the byte count includes the final NUL terminator, but the char count does not.
+	@returns The buffer's content. Must be passed to `free()` unless it is the buffer's arena.
+	@returns NULL and sets errno on allocation failure. The buffer is left unchanged.
+*/
+extern char *u8buf_finish(u8buf_t *buf, u8size_t *out_size);
+
+NONNULL_UNIC(3,4)
+/** Single-pass variant of `u8z_strmap()` that appends to a growable buffer.
+	@param buf The buffer to append to
+	@returns The size of the appended content. The `*exact` flags are unset iff. an allocation failed, in which case errno is set.
+*/
+extern u8size_t u8z_strmap_into(const char *str, u8size_t size, u8buf_t *buf, uchar_t (*map_f)(uchar_t));
+
+NONNULL_UNIC(3)
+/** Single-pass variant of `u8z_strcpy()` that appends to a growable buffer.
+	Runs of plain ASCII are copied verbatim.
+	@returns The size of the appended content. The `*exact` flags are unset iff. an allocation failed, in which case errno is set.
+*/
+extern u8size_t u8z_strcpy_into(const char *str, u8size_t size, u8buf_t *buf);
+
+NONNULL_UNIC(3)
+/** Allocating variant of `u8z_strmap()`.
+	@param out_size Unless NULL, overwritten with the size of the result, including its NUL terminator.
+	@returns A NUL-terminated, heap-allocated string that must be passed to `free()`
+	@returns NULL and sets errno on allocation failure
+*/
+extern char *u8z_strmapdup(const char *str, u8size_t size, uchar_t (*map_f)(uchar_t), u8size_t *out_size);
+
+/** Variant of `u8z_strmap_into()` on a NUL-terminated string */
+NONNULL_UNIC(1,2,3)
+extern u8size_t u8_strmap_into(const char *str, u8buf_t *buf, uchar_t (*map_f)(uchar_t));
+
+/** Variant of `u8z_strcpy_into()` on a NUL-terminated string */
+NONNULL_UNIC(1,2)
+extern u8size_t u8_strcpy_into(const char *str, u8buf_t *buf);
+
+// #endregion u8buf.c
+
+// #region u8slice.c
+
+/** A view into a UTF-8 string. Never owns its content. */
+typedef struct
+{
+	/** Start of the slice */
+	const char *bytes;
+	/** Size of the slice. Both exact flags are always set. */
+	u8size_t size;
+	/** Byte offset of `bytes` in the string the slice was originally taken from */
+	size_t byteOffset;
+	/** Character offset of `bytes` in the string the slice was originally taken from */
+	size_t charOffset;
+} u8slice_t;
+
+/** An iterator that splits a slice into sub-slices without allocating.
+	Create with `u8_split()`, `u8_split_ws()`, `u8_lines()` or `u8_words()`, and advance with `u8split_next()`.
+*/
+typedef struct
+{
+	/** The part of the input that hasn't been split yet */
+	u8slice_t rest;
+	/** The delimiter character */
+	uchar_t delim;
+	/** Private iteration state */
+	int _mode;
+} u8split_t;
+
+/** Creates a slice spanning an entire string.
+	@param size The size of `str`. Is resolved to an exact size, which requires a scan unless both exact flags are set.
+	@returns A slice with both offsets set to 0
+*/
+extern u8slice_t u8slice(const char *str, u8size_t size);
+
+/** Splits a slice at every occurrence of a delimiter.
+	Consecutive delimiters produce empty slices, so `n` delimiters always produce `n+1` slices.
+	@param s The slice to split
+	@param delim The delimiter. Over-encoded occurrences are recognized as well.
+*/
+extern u8split_t u8_split(u8slice_t s, uchar_t delim);
+
+/** Splits a slice into the runs of non-whitespace characters between whitespace, as determined by `u_isspace()`.
+	Never produces empty slices.
+*/
+extern u8split_t u8_split_ws(u8slice_t s);
+
+/** Splits a slice into lines.
+	The produced slices exclude the line terminator `\n`, and a preceding `\r`.
+	A final line terminator doesn't start another, empty line.
+*/
+extern u8split_t u8_lines(u8slice_t s);
+
+/** Splits a slice into words, as delimited by word boundaries as per UAX #29 (see `u8z_next_word()`).
+	Only produces word-like segments, i.e. those starting with a letter, number or connector punctuation like `_`.
+	Skips the spaces and punctuation between them.
+*/
+extern u8split_t u8_words(u8slice_t s);
+
+NONNULL_UNIC(1,2)
+/** Advances a splitting iterator.
+	@param it The iterator
+	@param out Overwritten with the next slice on success.
+			Its offsets are relative to the string the iterator's input was taken from.
+	@returns true if a slice was produced
+	@returns false if the input is exhausted
+*/
+extern bool u8split_next(u8split_t *it, u8slice_t *out);
+
+// #endregion u8slice.c
+
+// #region u8charset.c
+
+/** A set of codepoints */
+typedef struct Charset *u8charset_t;
+
+NONNULL_UNIC(1)
+/** Creates a set containing every character of a string.
+	Further members can be added via `u8charset_add()`, `u8charset_addRange()` and `u8charset_addClass()`.
+	@param chars The initial members, e.g. `",;\"\n"`
+	@param size The size of `chars`
+	@returns A new set. Must be freed via `u8charset_free()`.
+	@returns NULL and sets errno on malloc failure
+*/
+extern u8charset_t u8charset_new(const char *chars, u8size_t size);
+
+/** Frees a set
+	@param set A set. Noop if NULL.
+*/
+extern void u8charset_free(u8charset_t set);
+
+NONNULL_UNIC(1)
+/** Adds a character to a set
+	@returns 0 on success
+	@returns -1 and sets errno on malloc failure
+*/
+extern int u8charset_add(u8charset_t set, uchar_t c);
+
+NONNULL_UNIC(1)
+/** Adds an inclusive range of characters to a set
+	@returns 0 on success
+	@returns -1 and sets errno to EINVAL if `lo > hi`
+	@returns -1 and sets errno on malloc failure
+*/
+extern int u8charset_addRange(u8charset_t set, uchar_t lo, uchar_t hi);
+
+NONNULL_UNIC(1)
+/** Adds every character of a general category to a set.
+	@see uchar_is
+*/
+extern void u8charset_addClass(u8charset_t set, enum unic_gc class);
+
+NONNULL_UNIC(1)
+/** Checks if a character is in a set */
+extern bool u8charset_has(u8charset_t set, uchar_t c);
+
+NONNULL_UNIC(1,3)
+/** Finds the first character of a string that is in a set.
+	Runs of ASCII characters are classified 16 bytes at a time.
+	@param str A string
+	@param size The size of `str`
+	@param set The characters to search for
+	@returns A pointer to the first character in `set`, or NULL if there is none
+*/
+extern const char *u8z_strpbrk(const char *str, u8size_t size, u8charset_t set);
+
+NONNULL_UNIC(1,3)
+/** Determines the longest prefix of a string that consists only of characters in a set.
+	@param str A string
+	@param size The size of `str`
+	@param set The characters to accept
+	@returns The exact size of that prefix, in both bytes and characters
+*/
+extern u8size_t u8z_strspn(const char *str, u8size_t size, u8charset_t set);
+
+NONNULL_UNIC(1,3)
+/** Determines the longest prefix of a string that contains no character of a set.
+	@param str A string
+	@param size The size of `str`
+	@param set The characters to reject
+	@returns The exact size of that prefix, in both bytes and characters
+*/
+extern u8size_t u8z_strcspn(const char *str, u8size_t size, u8charset_t set);
+
+NONNULL_UNIC(1,2)
+/** Variant of `u8z_strpbrk()` over a NUL-terminated string */
+extern const char *u8_strpbrk(const char *str, u8charset_t set);
+
+NONNULL_UNIC(1,2)
+/** Variant of `u8z_strspn()` over a NUL-terminated string */
+extern u8size_t u8_strspn(const char *str, u8charset_t set);
+
+NONNULL_UNIC(1,2)
+/** Variant of `u8z_strcspn()` over a NUL-terminated string */
+extern u8size_t u8_strcspn(const char *str, u8charset_t set);
+
+// #endregion u8charset.c
+
+// #region u8parse.c
+
+NONNULL_UNIC(1,3)
+/** Parses an unsigned decimal integer at the start of a string.
+	The number is an optional `+` sign followed by decimal digits of any script (see `uchar_digit()`), e.g. `42`, `٤٢` or `４２`.
+	All digits of a number must belong to the same script, i.e. the same run of digits from 0 to 9.
+	Runs of ASCII digits are found 16 bytes at a time and converted 8 at a time.
+	@param str A string
+	@param size The size of `str`
+	@param out Overwritten with the value on success
+	@returns A pointer to the first character after the number
+	@returns NULL and sets errno to EINVAL if `str` doesn't start with a number, or its digits mix scripts
+	@returns NULL and sets errno to ERANGE if the value doesn't fit into `*out`
+*/
+extern const char *u8z_parse_u64(const char *str, u8size_t size, uint64_t *out);
+
+NONNULL_UNIC(1,3)
+/** Parses a signed decimal integer at the start of a string.
+	Behaves like `u8z_parse_u64()`, but also accepts a leading `-` or U+2212 MINUS SIGN.
+*/
+extern const char *u8z_parse_i64(const char *str, u8size_t size, int64_t *out);
+
+NONNULL_UNIC(1,2)
+/** Variant of `u8z_parse_u64()` over a NUL-terminated string */
+extern const char *u8_parse_u64(const char *str, uint64_t *out);
+
+NONNULL_UNIC(1,2)
+/** Variant of `u8z_parse_i64()` over a NUL-terminated string */
+extern const char *u8_parse_i64(const char *str, int64_t *out);
+
+// #endregion u8parse.c
+
+// #region u8script.c
+
+/** Receives a run of text in a single script
+	@param run The start of the run
+	@param size The exact size of the run
+	@param script The script of the run
+	@param ctx The context passed to `u8z_script_runs()`
+	@returns 0 to continue with the next run, or any other value to stop
+*/
+typedef int (*script_run_f)(const char *run, u8size_t size, enum unic_script script, void *ctx);
+
+NONNULL_UNIC(1,3)
+/** Splits a string into maximal runs of characters of the same script, in a single pass.
+	Characters of USCRIPT_COMMON and USCRIPT_INHERITED, like spaces, punctuation and combining marks, join the surrounding run.
+	Characters with Script_Extensions (see `uchar_hasScript()`) join a run if it is in one of their scripts.
+	A run consisting only of such shared characters is reported as USCRIPT_COMMON.
+	@param str A string
+	@param size The size of `str`
+	@param callback Called for every run, in order
+	@param ctx Passed to every call of `callback`
+	@returns 0 after every run was reported, or the nonzero value returned by `callback`
+*/
+extern int u8z_script_runs(const char *str, u8size_t size, script_run_f callback, void *ctx);
+
+NONNULL_UNIC(1,2)
+/** Variant of `u8z_script_runs()` over a NUL-terminated string */
+extern int u8_script_runs(const char *str, script_run_f callback, void *ctx);
+
+// #endregion u8script.c
+
+// #region u8grapheme.c
+
+NONNULL_UNIC(1)
+/** Determines the size of the first extended grapheme cluster of a string, as per UAX #29.
+	A cluster is what a user perceives as a single character, like `e` followed by a combining accent, or an emoji ZWJ sequence.
+	@param str A string
+	@param size The size of `str`
+	@returns The exact size of the cluster, in both bytes and characters. Zero if the string is empty.
+*/
+extern u8size_t u8z_next_grapheme(const char *str, u8size_t size);
+
+NONNULL_UNIC(1)
+/** Counts the extended grapheme clusters of a string, as per UAX #29.
+	Runs of ASCII characters are counted 16 bytes at a time.
+	@param str A string
+	@param size The size of `str`
+	@returns The number of clusters
+*/
+extern size_t u8z_grapheme_count(const char *str, u8size_t size);
+
+NONNULL_UNIC(1)
+/** Variant of `u8z_next_grapheme()` over a NUL-terminated string */
+extern u8size_t u8_next_grapheme(const char *str);
+
+NONNULL_UNIC(1)
+/** Variant of `u8z_grapheme_count()` over a NUL-terminated string */
+extern size_t u8_grapheme_count(const char *str);
+
+// #endregion u8grapheme.c
+
+// #region u8word.c
+
+NONNULL_UNIC(1)
+/** Determines the size of the first segment of a string, as delimited by word boundaries as per UAX #29.
+	Segments are words like `can't`, `3.14` or `e.g`, but also single spaces, punctuation or ideographs.
+	Runs of ASCII letters, digits and underscores within a word are skipped 16 bytes at a time.
+	@param str A string
+	@param size The size of `str`
+	@returns The exact size of the segment, in both bytes and characters. Zero if the string is empty.
+*/
+extern u8size_t u8z_next_word(const char *str, u8size_t size);
+
+NONNULL_UNIC(1)
+/** Variant of `u8z_next_word()` over a NUL-terminated string */
+extern u8size_t u8_next_word(const char *str);
+
+// #endregion u8word.c
+
+// #region u8norm.c
+
+NONNULL_UNIC(3)
+/** Appends the canonical decomposition (NFD) of a string to a buffer, as per UAX #15.
+	Text that passes the NFD_Quick_Check is copied as-is, only the characters around others are decomposed and reordered.
+	@param str The string to normalize
+	@param size The size of `str`
+	@param buf The buffer to append to
+	@returns The size of the appended content. The `*exact` flags are unset iff. an allocation failed, in which case errno is set.
+*/
+extern u8size_t u8z_nfd(const char *str, u8size_t size, u8buf_t *buf);
+
+NONNULL_UNIC(3)
+/** Appends the compatibility decomposition (NFKD) of a string to a buffer.
+	@see u8z_nfd
+*/
+extern u8size_t u8z_nfkd(const char *str, u8size_t size, u8buf_t *buf);
+
+NONNULL_UNIC(3)
+/** Appends the canonical composition (NFC) of a string to a buffer, as per UAX #15.
+	Text that passes the NFC_Quick_Check is copied with `memcpy()`, so normalizing text that is already in NFC costs little more than a copy.
+	Canonically equivalent strings, like precomposed and decomposed `é`, have the same NFC.
+	@param str The string to normalize
+	@param size The size of `str`
+	@param buf The buffer to append to
+	@returns The size of the appended content. The `*exact` flags are unset iff. an allocation failed, in which case errno is set.
+*/
+extern u8size_t u8z_nfc(const char *str, u8size_t size, u8buf_t *buf);
+
+NONNULL_UNIC(3)
+/** Appends the compatibility composition (NFKC) of a string to a buffer, which also folds compatibility characters like `ﬁ` or `²`.
+	@see u8z_nfc
+*/
+extern u8size_t u8z_nfkc(const char *str, u8size_t size, u8buf_t *buf);
+
+NONNULL_UNIC(1,2)
+/** Variant of `u8z_nfd()` on a NUL-terminated string */
+extern u8size_t u8_nfd(const char *str, u8buf_t *buf);
+
+NONNULL_UNIC(1,2)
+/** Variant of `u8z_nfkd()` on a NUL-terminated string */
+extern u8size_t u8_nfkd(const char *str, u8buf_t *buf);
+
+NONNULL_UNIC(1,2)
+/** Variant of `u8z_nfc()` on a NUL-terminated string */
+extern u8size_t u8_nfc(const char *str, u8buf_t *buf);
+
+NONNULL_UNIC(1,2)
+/** Variant of `u8z_nfkc()` on a NUL-terminated string */
+extern u8size_t u8_nfkc(const char *str, u8buf_t *buf);
+
+// #endregion u8norm.c
+
+// #region u8collate.c
+
+/** Comparison strengths of `u8z_sortkey()` */
+enum u8collate_level
+{
+	/** Compare base characters only, ignoring accents and case */
+	U8COLLATE_PRIMARY = 1,
+	/** Compare accents as well, ignoring case */
+	U8COLLATE_SECONDARY,
+	/** Compare accents and case */
+	U8COLLATE_TERTIARY
+};
+
+NONNULL_UNIC(1)
+/** Computes a sort key for a string, such that comparing the keys of two strings with `memcmp()` orders them by the
+	Unicode Collation Algorithm (UTS #10). Keys can be computed once and then sorted or indexed like plain bytes.
+	Uses a subset of the DUCET without contractions and with non-ignorable variable weighting,
+	so spaces and punctuation are compared like letters, and the input should be in NFD or NFC.
+	Keys of different sizes compare by their common prefix first, and the shorter one first if that is equal.
+	@param str The string
+	@param size The size of `str`
+	@param level How many levels of weights to include
+	@param out The buffer to write the key to. May be NULL to only compute the key's size.
+	@param cap Capacity of `out` in bytes. The key is truncated beyond it.
+	@returns The size of the entire key, which exceeds `cap` iff. the key was truncated. Keys may contain NUL bytes.
+*/
+extern size_t u8z_sortkey(const char *str, u8size_t size, enum u8collate_level level, char *out, size_t cap);
+
+NONNULL_UNIC(1)
+/** Variant of `u8z_sortkey()` over a NUL-terminated string */
+extern size_t u8_sortkey(const char *str, enum u8collate_level level, char *out, size_t cap);
+
+// #endregion u8collate.c
+
+// #region u8json.c
+
+NONNULL_UNIC(1)
+/** Escapes a string for use in a JSON string literal, without the enclosing quotes.
+	Double quotes, backslashes and control characters (including NUL) are escaped, with the short forms `\n`, `\t` etc. where available.
+	All other characters are written as utf-8. Spans that need no escaping are found 16 bytes at a time and copied as a whole.
+
+	@param str The source string
+	@param size The size of `str`
+	@param dst The destination buffer, may be NULL to just check the resulting size. The function behaves identical otherwise.
+	@param cap Capacity of `dst` in bytes.
+	@param nulTerminate If true, a closing NUL terminator is appended.
+	@returns The size of the string written to `dst`. The `*exact` flags are set iff. the output was not truncated.
+			 If `nulTerminate` is set, the byte count includes the final NUL terminator, but the char count does not.
+	@see u8z_strmap
+*/
+extern u8size_t u8z_json_escape(const char *str, u8size_t size, char *dst, size_t cap, bool nulTerminate);
+
+NONNULL_UNIC(1)
+/** Resolves the escape sequences of the content of a JSON string literal.
+	`\uXXXX` escapes of surrogate pairs are combined. Unpaired surrogates, escaped or not, become U+FFFD.
+	Malformed escape sequences are kept as-is.
+
+	@param str The content of the literal, without the enclosing quotes
+	@param size The size of `str`
+	@param dst The destination buffer, may be NULL to just check the resulting size. The function behaves identical otherwise.
+	@param cap Capacity of `dst` in bytes.
+	@param nulTerminate If true, content written to `dst` is NUL terminated, meaning that NUL characters are over-encoded as UNUL, and a closing NUL terminator is appended.
+	@returns The size of the string written to `dst`. The `*exact` flags are set iff. the output was not truncated.
+			 If `nulTerminate` is set, the byte count includes the final NUL terminator, but the char count does not.
+	@see u8z_strmap
+*/
+extern u8size_t u8z_json_unescape(const char *str, u8size_t size, char *dst, size_t cap, bool nulTerminate);
+
+NONNULL_UNIC(1)
+/** Variant of `u8z_json_escape()` over a NUL-terminated string */
+extern u8size_t u8_json_escape(const char *str, char *dst, size_t cap, bool nulTerminate);
+
+NONNULL_UNIC(1)
+/** Variant of `u8z_json_unescape()` over a NUL-terminated string */
+extern u8size_t u8_json_unescape(const char *str, char *dst, size_t cap, bool nulTerminate);
+
+// #endregion u8json.c
+
+// #region u8str.c
+
+/** An immutable string of fixed-width characters, which allows for indexing characters in constant time.
+	Stores every character in the narrowest width that fits the largest one, i.e. 1, 2 or 4 bytes, as per PEP 393.
+	Create with `u8str_init()` and release with `u8str_free()`.
+*/
+typedef struct
+{
+	/** The characters, `width` bytes each, in host byte order. May be NULL if `length` is 0. */
+	const void *chars;
+	/** Number of characters */
+	size_t length;
+	/** Size of every character in bytes, either 1, 2 or 4 */
+	unsigned width;
+	/** Heap memory owned by the string, or NULL for slices */
+	void *_alloc;
+} u8str_t;
+
+NONNULL_UNIC(1,2)
+/** Converts a utf-8 encoded string to a fixed-width string, in two passes over `str`.
+	Characters are read like `u8dec()` does, except that surrogates and values above U+10FFFF become U+FFFD.
+	@param s Overwritten with the new string
+	@param str A string
+	@param size The size of `str`
+	@returns 0 on success
+	@returns -1 and sets errno on allocation failure
+*/
+extern int u8str_init(u8str_t *s, const char *str, u8size_t size);
+
+NONNULL_UNIC(1)
+/** Releases the memory of a string created with `u8str_init()`, and empties it.
+	Slices taken from it become invalid. Does nothing for slices.
+*/
+extern void u8str_free(u8str_t *s);
+
+/** Retrieves a character in constant time
+	@param s A string
+	@param i A character index
+	@returns The character at index `i`, or UEOF if `i` is out of range
+*/
+extern uchar_t u8str_at(u8str_t s, size_t i);
+
+/** Takes a part of a string in constant time, without copying.
+	The slice keeps the width of `s`, and must not outlive the string it was taken from.
+	@param s A string
+	@param start Index of the first character. Clamped to `end`.
+	@param end Index after the last character. Clamped to the length of `s`.
+	@returns The characters `start` through `end - 1`
+*/
+extern u8str_t u8str_slice(u8str_t s, size_t start, size_t end);
+
+/** Converts a fixed-width string back to utf-8.
+	@param s A string
+	@param dst The destination buffer, may be NULL to just check the resulting size. The function behaves identical otherwise.
+	@param cap Capacity of `dst` in bytes.
+	@param nulTerminate If true, content written to `dst` is NUL terminated, meaning that NUL characters are over-encoded as UNUL, and a closing NUL terminator is appended.
+	@returns The size of the string written to `dst`. The `*exact` flags are set iff. the output was not truncated.
+			 If `nulTerminate` is set, the byte count includes the final NUL terminator, but the char count does not.
+	@see u8z_strmap
+*/
+extern u8size_t u8str_encode(u8str_t s, char *dst, size_t cap, bool nulTerminate);
+
+NONNULL_UNIC(2)
+/** Variant of `u8str_encode()` that appends to a growable buffer.
+	@param buf The buffer to append to
+	@returns The size of the appended content. The `*exact` flags are unset iff. an allocation failed, in which case errno is set.
+*/
+extern u8size_t u8str_encode_into(u8str_t s, u8buf_t *buf);
+
+// #endregion u8str.c
+
+// #region u8sort.c
+
+/** Flags for `u8_sort()` */
+enum u8sort_flags
+{
+	/** Order by raw bytes. Equivalent to codepoint order only on normalized strings, but avoids decoding. */
+	U8SORT_BYTES = 1,
+	/** Order by the case-folding key of every character (see `uchar_fold()`), like `u8_strcmpI()`. Ignored if `U8SORT_BYTES` is set. */
+	U8SORT_FOLD = 2,
+	/** Spread the work across every online processor */
+	U8SORT_PARALLEL = 4
+};
+
+NONNULL_UNIC(1)
+/** Sorts an array of NUL-terminated utf-8 strings in codepoint order using a stable MSD radix sort.
+	Without `U8SORT_BYTES`, characters are compared by their normalized encoding, so the order matches `u8_strcmp()`.
+	@param strings The strings to sort. Only the pointers are reordered.
+	@param n The number of strings
+	@param flags A combination of `enum u8sort_flags`
+	@returns 0 on success
+	@returns -1 and sets errno on malloc failure. `strings` is left unchanged.
+*/
+extern int u8_sort(const char **strings, size_t n, int flags);
+
+// #endregion u8sort.c
+
+// #region u8editdist.c
+
+/** Flags for `u8z_editdist()` */
+enum u8dist_flags
+{
+	/** Count a transposition of two adjacent characters as a single edit (optimal string alignment distance) */
+	U8DIST_DAMERAU = 1,
+	/** Consider characters that are alike (see `uchar_alike()`) equal */
+	U8DIST_FOLD = 2
+};
+
+NONNULL_UNIC(1,3)
+/** Computes the Levenshtein distance between two utf-8 strings, counting insertions, deletions and substitutions of codepoints.
+	Uses the bit-parallel algorithm by Myers and Hyyrö, which processes 64 characters of the shorter string at once.
+	@param a A string
+	@param n The size of `a`
+	@param b Another string
+	@param m The size of `b`
+	@param maxDist The maximum distance of interest. Computation stops as soon as it is certainly exceeded.
+		Pass `SIZE_MAX` for an unbounded distance.
+	@param flags A combination of `enum u8dist_flags`
+	@returns The edit distance, or `maxDist + 1` if it is greater than `maxDist`
+	@returns `SIZE_MAX` on malloc failure
+*/
+extern size_t u8z_editdist(const char *a, u8size_t n, const char *b, u8size_t m, size_t maxDist, int flags);
+
+NONNULL_UNIC(1,2)
+/** Variant of `u8z_editdist()` over NUL-terminated strings */
+extern size_t u8_editdist(const char *a, const char *b, size_t maxDist, int flags);
+
+// #endregion u8editdist.c
+
+// #region u8glob.c
+
+/** A compiled glob pattern */
+typedef struct Glob *u8glob_t;
+
+/** Flags for `u8glob_compile()` */
+enum u8glob_flags
+{
+	/** Match characters that are alike (see `uchar_alike()`). Applies to literals and ranges, but not to named classes. */
+	U8GLOB_FOLD = 1,
+	/** `*`, `?` and bracket expressions don't match `/`. `**` matches any sequence of characters, including `/`. */
+	U8GLOB_PATHNAME = 2
+};
+
+NONNULL_UNIC(1)
+/** Compiles a glob pattern.
+	Supports `*`, `?`, and bracket expressions like `[a-zä]` or `[!0-9]` over codepoint ranges.
+	Bracket expressions may contain general categories like `[[:L:]]` or `[[:Uppercase_Letter:]]` (see `uclass_byname()`),
+	as well as `[:alpha:]`, `[:alnum:]`, `[:digit:]`, `[:lower:]`, `[:upper:]`, `[:punct:]`, `[:space:]` and `[:word:]`.
+	A backslash matches the next character literally.
+	Matching runs in linear time, independent of the arrangement of stars.
+	@param pattern The pattern
+	@param flags A combination of `enum u8glob_flags`
+	@returns A compiled glob. Must be freed via `u8glob_free()`.
+	@returns NULL and sets errno to EINVAL if the pattern is malformed
+	@returns NULL and sets errno on malloc failure
+*/
+extern u8glob_t u8glob_compile(const char *pattern, int flags);
+
+/** Frees a compiled glob
+	@param glob A compiled glob. Noop if NULL.
+*/
+extern void u8glob_free(u8glob_t glob);
+
+NONNULL_UNIC(1,2)
+/** Matches a string against a compiled glob
+	@param glob A compiled glob
+	@param str A string
+	@param size The size of `str`
+	@returns 1 if the entire string matches, 0 otherwise
+	@returns -1 and sets errno on malloc failure, which can only happen for patterns with hundreds of elements
+*/
+extern int u8glob_match(u8glob_t glob, const char *str, u8size_t size);
+
+// #endregion u8glob.c
+
+// #region u8regex.c
+
+/** A compiled regular expression */
+typedef struct Regex *u8regex_t;
+
+/** Flags for `u8regex_compile()` */
+enum u8regex_flags
+{
+	/** Match characters that are alike (see `uchar_alike()`). Applies to literals and ranges, but not to named classes. */
+	U8RE_ICASE = 1,
+	/** Make `.` match newlines as well */
+	U8RE_DOTALL = 2
+};
+
+NONNULL_UNIC(1)
+/** Compiles a regular expression.
+	Supports literals, `.`, groups `(...)` and `(?:...)`, alternation `|`, and the quantifiers `*`, `+`, `?`, `{n}`, `{n,}` and `{n,m}`.
+	Bracket expressions like `[^a-zä]` may contain escapes and the named classes accepted by `u8glob_compile()`.
+	The escapes `\p{..}` and `\P{..}` (or `\pL`) match characters in (or not in) a general category, see `uclass_byname()`.
+	`\d`, `\w` and `\s` match unicode decimal digits, word characters and whitespace, their uppercase variants match the complement.
+	`\xHH` and `\x{H...}` match a codepoint.
+	`^` and `$` are only supported at the start and end of a pattern without a top-level alternation.
+	Matching runs in linear time over a lazily built DFA.
+	A compiled regex caches that DFA internally and must not be used by multiple threads at once.
+	@param pattern The pattern
+	@param flags A combination of `enum u8regex_flags`
+	@returns A compiled regex. Must be freed via `u8regex_free()`.
+	@returns NULL and sets errno to EINVAL if the pattern is malformed
+	@returns NULL and sets errno on malloc failure
+*/
+extern u8regex_t u8regex_compile(const char *pattern, int flags);
+
+/** Frees a compiled regex
+	@param re A compiled regex. Noop if NULL.
+*/
+extern void u8regex_free(u8regex_t re);
+
+NONNULL_UNIC(1,2)
+/** Determines whether an entire string matches a regex. Anchors are implied.
+	@param re A compiled regex
+	@param str A string
+	@param size The size of `str`
+	@returns Whether the entire string matches
+*/
+extern bool u8regex_match(u8regex_t re, const char *str, u8size_t size);
+
+NONNULL_UNIC(1,2)
+/** Finds the leftmost-longest match of a regex in a string
+	@param re A compiled regex
+	@param str A string
+	@param size The size of `str`
+	@param out_len If not NULL, overwritten with the length of the match in bytes
+	@returns A pointer to the start of the match, or NULL if there is none
+*/
+extern const char *u8regex_search(u8regex_t re, const char *str, u8size_t size, size_t *out_len);
+
+// #endregion u8regex.c
 #endif
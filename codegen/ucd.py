@@ -6,11 +6,34 @@ from dataclasses import dataclass
 from typing import Callable, Iterable, Optional, TypeVar, Iterator
 
 URL = "https://www.unicode.org/Public/UCD/latest/ucd/"
+# Files that aren't part of the UCD proper -> the URL of the directory they are downloaded from
+URLS = { "allkeys.txt": "https://www.unicode.org/Public/UCA/latest/" }
 CACHE_DIR = "cache"
 
 # Populated by the parsers below.
 GENERAL_CATEGORIES: dict[str, "GeneralCategory"] = {}
 CODEPOINTS: dict[int, "Codepoint"] = {}
+# Shorthand (e.g. `Latn`) -> script, as per PropertyValueAliases.txt
+SCRIPTS: dict[str, "Script"] = {}
+# Inclusive codepoint ranges and the full name of their script, as per Scripts.txt
+SCRIPT_RANGES: list[tuple[int, int, str]] = []
+# Inclusive codepoint ranges and the shorthands of their script extensions, as per ScriptExtensions.txt
+SCRIPT_EXTENSIONS: list[tuple[int, int, list[str]]] = []
+# Inclusive codepoint ranges and their Grapheme_Cluster_Break value, as per GraphemeBreakProperty.txt
+GRAPHEME_BREAKS: list[tuple[int, int, str]] = []
+# Inclusive codepoint ranges and their Word_Break value, as per WordBreakProperty.txt
+WORD_BREAKS: list[tuple[int, int, str]] = []
+# Sorted, inclusive codepoint ranges of Extended_Pictographic characters, as per emoji-data.txt
+EXTENDED_PICTOGRAPHIC: list[tuple[int, int]] = []
+# Codepoint -> its collation elements as `(primary, secondary, tertiary)`, as per the DUCET in allkeys.txt.
+# Contractions, i.e. entries for sequences of several codepoints, are left out.
+COLLATION_ELEMENTS: dict[int, list[tuple[int, int, int]]] = {}
+# Inclusive codepoint ranges and the base of their implicit primary weights, as per the @implicitweights lines of allkeys.txt
+IMPLICIT_WEIGHTS: list[tuple[int, int, int]] = []
+# Binary property name, or `name=value` for enumerated properties -> sorted, inclusive codepoint ranges, as per DerivedCoreProperties.txt
+CORE_PROPERTIES: dict[str, list[tuple[int, int]]] = {}
+# Property name, or `name=value` for quick check properties -> sorted, inclusive codepoint ranges, as per DerivedNormalizationProps.txt
+NORMALIZATION_PROPERTIES: dict[str, list[tuple[int, int]]] = {}
 VERSION: tuple[int, int, int] = (0, 0, 0)
 ParserFn = Callable[[list[str]], None]
 
@@ -27,6 +50,19 @@ def remove_comments(lines: Iterable[str], cc: str = "#") -> Iterator[str]:
         elif idx > 0:
             yield line[:idx]
 
+def parse_ranges(lines: Iterable[str]) -> Iterator[tuple[int, int, list[str]]]:
+    """Parses the lines of a UCD property file of the form `XXXX..YYYY ; value ; ...`.
+        Yields the inclusive codepoint range and the remaining fields of each line.
+    """
+
+    for raw in remove_comments(lines):
+        fields = [field.strip() for field in raw.split(";")]
+        if not fields[0]:
+            continue
+
+        first, _, last = fields[0].partition("..")
+        yield int(first, 16), int(last or first, 16), fields[1:]
+
 def parser(filename: str) -> Callable[[ParserFn], ParserFn]:
     """Register a function as the parser for the given UCD file"""
 
@@ -77,6 +113,26 @@ class GeneralCategory:
         ]
 
 
+@dataclass(frozen=True)
+class Script:
+    """A Unicode script (e.g. `Latn`/`Latin`)."""
+
+    PREFIX = "USCRIPT"
+
+    # The four character shorthand.
+    shorthand: str
+    # The alternative full name.
+    full_name: str
+
+    @property
+    def full_id(self) -> str:
+        return f"{self.PREFIX}_{self.full_name.upper()}"
+
+    @property
+    def short_id(self) -> str:
+        return f"{self.PREFIX}_{self.shorthand.upper()}"
+
+
 @dataclass(frozen=True)
 class Codepoint:
     """A single assigned Unicode codepoint and its simple case mappings."""
@@ -89,6 +145,14 @@ class Codepoint:
     simple_lowercase_mapping: int
     # The general category shorthand it belongs to.
     general_category: str
+    # Its value as a decimal digit, if it has Numeric_Type=Decimal.
+    decimal_value: Optional[int] = None
+    # Its Canonical_Combining_Class.
+    combining_class: int = 0
+    # The characters of its single-level decomposition mapping, if any.
+    decomposition: tuple[int, ...] = ()
+    # Whether the decomposition is a compatibility decomposition, i.e. carries a `<tag>`.
+    compatibility: bool = False
 
     @property
     def simple_lowercase_delta(self) -> int:
@@ -126,12 +190,18 @@ def parse_codepoints(lines: list[str]) -> None:
         value = int(fields[0], 16)
         upper = _try_hex(fields[12]) if len(fields) > 12 else None
         lower = _try_hex(fields[13]) if len(fields) > 13 else None
+        decomposition = fields[5].split() if len(fields) > 5 else []
+        compatibility = bool(decomposition) and decomposition[0].startswith("<")
 
         codepoints[value] = Codepoint(
             value=value,
             simple_uppercase_mapping=upper if upper is not None else value,
             simple_lowercase_mapping=lower if lower is not None else value,
             general_category=fields[2],
+            decimal_value=int(fields[6]) if len(fields) > 6 and fields[6].strip() else None,
+            combining_class=int(fields[3]) if len(fields) > 3 and fields[3].strip() else 0,
+            decomposition=tuple(int(d, 16) for d in decomposition[compatibility:]),
+            compatibility=compatibility,
         )
 
     global CODEPOINTS
@@ -146,15 +216,104 @@ def parse_general_categories(lines: list[str]) -> None:
     VERSION = (parts[0], parts[1], parts[2])
 
     categories: dict[str, GeneralCategory] = {}
+    scripts: dict[str, Script] = {}
 
     for raw in remove_comments(lines):
         fields = [field.strip() for field in raw.split(";")]
         if fields and fields[0] == "gc":
             gc = GeneralCategory(shorthand=fields[1], full_name=fields[2])
             categories[gc.shorthand] = gc
+        elif fields and fields[0] == "sc":
+            sc = Script(shorthand=fields[1], full_name=fields[2])
+            scripts[sc.shorthand] = sc
 
-    global GENERAL_CATEGORIES
+    global GENERAL_CATEGORIES, SCRIPTS
     GENERAL_CATEGORIES = categories
+    SCRIPTS = scripts
+
+
+@parser("Scripts.txt")
+def parse_scripts(lines: list[str]) -> None:
+    global SCRIPT_RANGES
+    SCRIPT_RANGES = sorted((first, last, fields[0]) for first, last, fields in parse_ranges(lines))
+
+
+@parser("ScriptExtensions.txt")
+def parse_script_extensions(lines: list[str]) -> None:
+    global SCRIPT_EXTENSIONS
+    SCRIPT_EXTENSIONS = sorted((first, last, fields[0].split()) for first, last, fields in parse_ranges(lines))
+
+
+@parser("DerivedCoreProperties.txt")
+def parse_core_properties(lines: list[str]) -> None:
+    properties: dict[str, list[tuple[int, int]]] = {}
+
+    for first, last, fields in parse_ranges(lines):
+        # enumerated properties like `InCB; Linker` are stored as `InCB=Linker`
+        properties.setdefault("=".join(fields[:2]), []).append((first, last))
+
+    global CORE_PROPERTIES
+    CORE_PROPERTIES = { name: sorted(ranges) for name, ranges in properties.items() }
+
+
+@parser("DerivedNormalizationProps.txt")
+def parse_normalization_properties(lines: list[str]) -> None:
+    properties: dict[str, list[tuple[int, int]]] = {}
+
+    for first, last, fields in parse_ranges(lines):
+        properties.setdefault("=".join(fields[:2]), []).append((first, last))
+
+    global NORMALIZATION_PROPERTIES
+    NORMALIZATION_PROPERTIES = { name: sorted(ranges) for name, ranges in properties.items() }
+
+
+@parser("allkeys.txt")
+def parse_collation_elements(lines: list[str]) -> None:
+    elements: dict[int, list[tuple[int, int, int]]] = {}
+    implicit: list[tuple[int, int, int]] = []
+
+    for raw in remove_comments(lines):
+        if raw.startswith("@implicitweights"):
+            first, _, rest = raw[len("@implicitweights"):].strip().partition("..")
+            last, _, base = rest.partition(";")
+            implicit.append((int(first, 16), int(last, 16), int(base, 16)))
+            continue
+
+        chars, _, weights = raw.partition(";")
+        chars = chars.split()
+        if len(chars) != 1 or not weights.strip():
+            continue
+
+        elements[int(chars[0], 16)] = [
+            (int(p, 16), int(s, 16), int(t, 16))
+            for p, s, t in re.findall(r"\[[.*]([0-9A-F]+)\.([0-9A-F]+)\.([0-9A-F]+)\]", weights)
+        ]
+
+    global COLLATION_ELEMENTS, IMPLICIT_WEIGHTS
+    COLLATION_ELEMENTS = elements
+    IMPLICIT_WEIGHTS = sorted(implicit)
+
+
+@parser("auxiliary/GraphemeBreakProperty.txt")
+def parse_grapheme_breaks(lines: list[str]) -> None:
+    global GRAPHEME_BREAKS
+    GRAPHEME_BREAKS = sorted((first, last, fields[0]) for first, last, fields in parse_ranges(lines))
+
+
+@parser("auxiliary/WordBreakProperty.txt")
+def parse_word_breaks(lines: list[str]) -> None:
+    global WORD_BREAKS
+    WORD_BREAKS = sorted((first, last, fields[0]) for first, last, fields in parse_ranges(lines))
+
+
+@parser("emoji/emoji-data.txt")
+def parse_emoji_data(lines: list[str]) -> None:
+    global EXTENDED_PICTOGRAPHIC
+    EXTENDED_PICTOGRAPHIC = sorted(
+        (first, last)
+        for first, last, fields in parse_ranges(lines)
+        if fields[0] == "Extended_Pictographic"
+    )
 
 
 def _download(filename: str) -> str:
@@ -165,11 +324,14 @@ def _download(filename: str) -> str:
     if os.path.exists(out_path):
         return "CACHED"
 
+    # some files live in subdirectories like `auxiliary/`
+    os.makedirs(os.path.dirname(out_path), exist_ok=True)
+
     temp_path = out_path + ".part"
     if os.path.exists(temp_path):
         os.remove(temp_path)
 
-    with urllib.request.urlopen(URL + filename) as response, open(
+    with urllib.request.urlopen(URLS.get(filename, URL) + filename) as response, open(
         temp_path, "wb"
     ) as out_file:
         out_file.write(response.read())
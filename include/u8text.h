@@ -30,9 +30,42 @@ struct TextFile;
 /** A handle to a UTF-8 text file */
 typedef struct TextFile *u8file_t;
 
+/** A handle to an editable UTF-8 text */
+typedef struct TextEditor *u8edit_t;
+
 /** Callback function invoked to free the content of a text file before freeing. NULL indicates noop. */
 typedef void (*cleanup_f)(u8file_t file);
 
+/** Options for `u8txt_load_ex()`. Zeroed fields select the defaults. */
+typedef struct {
+	/** Number of bytes between the locations that are indexed, 2048 by default.
+		Every lookup decodes up to this many bytes, while the index takes `sizeof(u8loc_t)` bytes per stride.
+		Strides below `UTF8_MAX` are raised to it.
+	*/
+	size_t stride;
+	/** Maximum number of threads that build the index, by default the limit set by `u8txt_threads()` */
+	unsigned threads;
+	/** Whether to build the index incrementally, only as far as the file is queried, instead of scanning the entire
+		file when it's loaded. Until the index is complete, the character size and line count of the file are unknown.
+		@see u8txt_size
+		@see u8txt_lines
+		@note Queries on a lazily loaded file modify its index, so they must not run concurrently.
+	*/
+	bool lazy;
+	/** Whether to also index the start of every line, which makes looking up lines and nearby columns constant time.
+		Takes about 8 bytes per line, and is built along with the rest of the index.
+		Lookups fall back to the regular index if the line index can't be allocated, or a line spans over 4 GiB.
+		@see u8txt_lineRange
+	*/
+	bool lineIndex;
+	/** Number of characters between the locations in the character index, which makes `u8txt_chr()` decode
+		at most this many characters. 0 builds no character index, which is the default.
+		Takes 16 bytes per stride, and is built along with the rest of the index.
+		Lookups fall back to the regular index if the character index can't be allocated.
+	*/
+	size_t charStride;
+} u8txt_opts;
+
 struct TextFile
 {
 	/** Arbitrary userdata tagged onto this file.
@@ -40,9 +73,13 @@ struct TextFile
 		Initialized to NULL on creation.
 	*/
 	void *udata;
-	/** Size of `bytes`. Guaranteed to be exact. DO NOT MODIFY. */
+	/** Size of `bytes`. Guaranteed to be exact. DO NOT MODIFY.
+		The character count of a lazily loaded file is only exact after `u8txt_size()` or `u8txt_lines()`.
+	*/
 	const u8size_t size;
-	/** Total number of lines in the file */
+	/** Total number of lines in the file.
+		Zero for a lazily loaded file until `u8txt_size()` or `u8txt_lines()`.
+	*/
 	const unsigned lines;
 	/** Points to the raw file contents. DO NOT MODIFY. */
 	const char *const bytes;
@@ -107,6 +144,11 @@ extern size_t u8txt_count(u8list_t list);
 */
 extern u8file_t u8txt_open(int fd);
 
+/** Variant of `u8txt_open()` that accepts load options
+	@param opts The options passed to `u8txt_load_ex()`, or NULL for the defaults
+*/
+extern u8file_t u8txt_open_ex(int fd, const u8txt_opts *opts);
+
 /** Prefab for passing a mmap()ed buffer to `u8txt_load()`. 
 	Note that `size` must be exactly what was passed to mmap().
  */
@@ -125,6 +167,30 @@ extern void u8txt_cleanup_munmap(u8file_t file);
 */
 extern u8file_t u8txt_load(const char *bytes, size_t size, cleanup_f cleanup);
 
+/** Variant of `u8txt_load()` that accepts load options
+	@param opts Options that control the index of the file, or NULL for the defaults
+	@see u8txt_load
+*/
+extern u8file_t u8txt_load_ex(const char *bytes, size_t size, cleanup_f cleanup, const u8txt_opts *opts);
+
+/** Limits the number of threads that `u8txt_load()` splits the indexing of big files across.
+	Files are only split into chunks of at least 1 MiB. Not thread-safe with concurrent loads.
+	@param n The maximum number of threads. 0 selects the number of online processors, which is the default.
+			1 indexes every file on the calling thread.
+	@returns The previous limit
+*/
+extern unsigned u8txt_threads(unsigned n);
+
+/** Determines the exact size of a file, finishing the index of a lazily loaded file.
+	@returns The `size` of the file, which is now exact
+*/
+extern u8size_t u8txt_size(u8file_t file);
+
+/** Determines the number of lines of a file, finishing the index of a lazily loaded file.
+	@returns The `lines` of the file, which are now exact
+*/
+extern unsigned u8txt_lines(u8file_t file);
+
 /** Prefab for passing a malloc()ed buffer to `u8txt_load()` */
 extern void u8txt_cleanup_free(u8file_t file);
 
@@ -156,6 +222,14 @@ extern int u8txt_loc(u8file_t file, const char *chr, u8loc_t *out_loc);
 */
 extern const char *u8txt_line(u8file_t file, unsigned line, u8size_t *out_size);
 
+/** Retrieves a range of consecutive lines of the file
+	@param first The 1-based index of the first line
+	@param last The 1-based index of the last line, inclusive
+	@param out_size If not NULL, overwritten with the size of the returned string, which includes the newline ending `last`
+	@returns The start of line `first`, or NULL if either line index is out of bounds or `last < first`
+*/
+extern const char *u8txt_lineRange(u8file_t file, unsigned first, unsigned last, u8size_t *out_size);
+
 /** Looks up a character by its index
 	@param out_loc Unless NULL, overwritten with the complete location of that character
 	@returns A pointer to the first byte of the character at `index`
@@ -173,5 +247,115 @@ extern const char *u8txt_chr(u8file_t file, size_t index, u8loc_t *out_loc);
 */
 extern const char *u8txt_unLoc(u8file_t file, unsigned line, unsigned col, size_t *out_charIndex);
 
+//#endregion
+
+//#region Editable text
+
+/** Opens a text for editing.
+	The text is kept as a balanced tree of pieces that cache their size and line count,
+	so that edits and lookups take logarithmic time regardless of the size of the text.
+	@param file The initial text, or NULL for an empty text.
+			Its content is referenced rather than copied, so it must not be freed before the editor.
+	@returns The editor
+	@returns NULL and sets errno on malloc failure
+*/
+extern u8edit_t u8edit_open(u8file_t file);
+
+/** Frees an editor. Does NOT free the file it was opened from. */
+extern void u8edit_free(u8edit_t ed);
+
+/** @returns The exact size of the edited text */
+extern u8size_t u8edit_size(u8edit_t ed);
+
+/** @returns The number of lines of the edited text */
+extern unsigned u8edit_lines(u8edit_t ed);
+
+/** Inserts text.
+	@note Inserted text is copied into storage that is only freed along with the editor.
+	@param off The byte offset to insert at. Must be a character boundary, or the end of the text.
+	@param str The text to insert, which may join with incomplete sequences around `off`
+	@param size The number of bytes in `str`
+	@returns 0 on success
+	@returns -1 and sets errno to EINVAL if `off` is out of bounds or not a character boundary
+	@returns -1 and sets errno on malloc failure, leaving the text unchanged
+*/
+extern int u8edit_insert(u8edit_t ed, size_t off, const char *str, size_t size);
+
+/** Variant of `u8edit_insert()` that inserts at a line/col location, as accepted by `u8edit_unLoc()` */
+extern int u8edit_insertAt(u8edit_t ed, unsigned line, unsigned col, const char *str, size_t size);
+
+/** Deletes a range of text.
+	@param from The byte offset of the start of the range. Must be a character boundary.
+	@param to The byte offset after the end of the range. Must be a character boundary, or the end of the text.
+	@returns 0 on success
+	@returns -1 and sets errno to EINVAL if either offset is out of bounds, not a character boundary, or `to < from`
+	@returns -1 and sets errno on malloc failure, leaving the text unchanged
+*/
+extern int u8edit_delete(u8edit_t ed, size_t from, size_t to);
+
+/** Deletes a number of characters starting at a line/col location, as accepted by `u8edit_unLoc()`.
+	Stops at the end of the text.
+	@see u8edit_delete
+*/
+extern int u8edit_deleteAt(u8edit_t ed, unsigned line, unsigned col, size_t count);
+
+/** Looks up the location of a byte offset in the edited text
+	@see u8txt_loc
+	@returns 0 and overwrites `out_loc` if `off` is within the text
+	@returns A negative number if the text is empty
+	@returns A positive number if `off` is past the end of the text
+*/
+extern int u8edit_loc(u8edit_t ed, size_t off, u8loc_t *out_loc);
+
+/** Looks up a character by its index
+	@param out_loc Unless NULL, overwritten with the complete location of that character
+	@returns The byte offset of the character at `index`
+	@returns `SIZE_MAX` if `index` was out of bounds
+*/
+extern size_t u8edit_chr(u8edit_t ed, size_t index, u8loc_t *out_loc);
+
+/** Looks up a line/col location
+	@see u8txt_unLoc
+	@param out_charIndex Unless NULL, overwritten with the equivalent total character offset of the result on success.
+	@returns The byte offset of that location, which may be the end of the line or the text
+	@returns `SIZE_MAX` if the location was out of bounds
+*/
+extern size_t u8edit_unLoc(u8edit_t ed, unsigned line, unsigned col, size_t *out_charIndex);
+
+/** Looks up a single line of the edited text
+	@param line A 1-based line index
+	@param out_size If not NULL, overwritten with the size of the line, including its newline
+	@returns The byte offset of the start of the line
+	@returns `SIZE_MAX` if the line index is out of bounds
+*/
+extern size_t u8edit_line(u8edit_t ed, unsigned line, u8size_t *out_size);
+
+/** Copies a range of the edited text
+	@param off The byte offset to start copying at
+	@param buf A buffer of at least `n` bytes
+	@returns The number of bytes copied, which is less than `n` only at the end of the text
+*/
+extern size_t u8edit_read(u8edit_t ed, size_t off, char *buf, size_t n);
+
+/** Copies the current text into a new text file, which is independent of the editor
+	@param opts The options passed to `u8txt_load_ex()`, or NULL for the defaults
+	@returns The text file, which frees its copy of the text
+	@returns NULL and sets errno on malloc failure
+*/
+extern u8file_t u8edit_snapshot(u8edit_t ed, const u8txt_opts *opts);
+
+//#endregion
+
+//#region Pattern matching
+
+/** Finds the next leftmost-longest match of a regex in a file.
+	@note `^` matches at `from`, so that successive matches may be found by passing the end of the previous match.
+	@param from The position to start searching from, or NULL to search the entire file
+	@param out_len If not NULL, overwritten with the length of the match in bytes
+	@returns A pointer to the start of the match, see `u8txt_loc()` for its location
+	@returns NULL if there is no match, or `from` is out of bounds
+*/
+extern const char *u8txt_search(u8file_t file, u8regex_t re, const char *from, size_t *out_len);
+
 //#endregion
 #endif
\ No newline at end of file
@@ -0,0 +1,51 @@
+/* scan.h: Iteration helpers shared by the sized string functions */
+#pragma once
+#include "unic.h"
+
+#define HAS_NEXT(byteIx, charIx, size, str) \
+	( (byteIx) < (size).byteCount && (charIx) < (size).charCount && ((size).bytesExact || (size).charsExact || str[byteIx]) )
+
+/** Expands to an iteration over every character in the string
+	@param str The string to iterate over
+	@param size The size of `str`
+	@param __VA_ARGS__ A statement of the loop body.
+		Received the variables `bytes` and `chars` giving the respective indices,
+		`c` giving the current character, and `l` giving that char's size
+*/
+#define SCAN(str, size, ...) \
+{ \
+	const char *const _s = (str); \
+	const u8size_t _z = (size); \
+	for(size_t byteIx = 0, charIx = 0; HAS_NEXT(byteIx, charIx, _z, _s); ++charIx) \
+	{ \
+		uchar_t c; \
+		const size_t l = u8ndec(_s + byteIx, _z.byteCount - byteIx, &c); \
+		{ __VA_ARGS__ } \
+		byteIx += l; \
+	} \
+}
+
+/** Scans over two strings simultaneously
+	Sets `c1` and `c2` to the current characters, and `l1` and `l2` to their lengths.
+	The end of strings is observable as a single char with `l* = 0`.
+	Once one such character is observed, iteration ends afterwards.
+*/
+#define BISCAN(str1, size1, str2, size2, ...) \
+{ \
+	const char *const _s1 = (str1), *const _s2 = (str2); \
+	const u8size_t _z1 = (size1), _z2 = (size2); \
+	for(size_t byteIx1 = 0, charIx1 = 0, byteIx2 = 0, charIx2 = 0;; ++charIx1, ++charIx2) \
+	{ \
+		uchar_t c1, c2; \
+		const size_t l1 = HAS_NEXT(byteIx1, charIx1, _z1, _s1) \
+			? u8ndec(_s1 + byteIx1, _z1.byteCount - byteIx1, &c1) \
+			: (c1 = 0); \
+		const size_t l2 = HAS_NEXT(byteIx2, charIx2, _z2, _s2) \
+			? u8ndec(_s2 + byteIx2, _z2.byteCount - byteIx2, &c2) \
+			: (c2 = 0); \
+		{ __VA_ARGS__ } \
+		byteIx1 += l1; \
+		byteIx2 += l2; \
+		if(l1 == 0 || l2 == 0) break; \
+	} \
+}
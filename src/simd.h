@@ -0,0 +1,875 @@
+/* simd.h: Vectorized byte scanning kernels with portable fallbacks.
+	Most kernels only classify ASCII bytes, everything else is left to the decoding routines. */
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+	#define SIMD_SSE2
+	#if defined(__SSSE3__)
+		#include <tmmintrin.h>
+		#define SIMD_SSSE3
+	#endif
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	#include <arm_neon.h>
+	#define SIMD_NEON
+#endif
+
+#if defined(SIMD_SSE2) || defined(SIMD_NEON)
+	/** Width of a vector register in bytes */
+	#define SIMD_WIDTH 16
+#endif
+
+/** Counts trailing zeroes of a nonzero integer */
+static inline unsigned _ctz(uint64_t x)
+{
+	return __builtin_ctzll(x);
+}
+
+/** Determines the index of the highest set bit of a nonzero integer */
+static inline unsigned _msb(uint64_t x)
+{
+	return 63 - __builtin_clzll(x);
+}
+
+/** Counts set bits */
+static inline unsigned _popcnt(uint64_t x)
+{
+	return __builtin_popcountll(x);
+}
+
+/** Determines if a byte ends a plain ASCII span.
+	@see _ascii_span
+*/
+static inline bool _span_stop(unsigned char b, unsigned char x, unsigned char lo, unsigned char hi)
+{
+	return b == 0 || b >= 0x80 || b == x || (lo <= hi && (unsigned char)(b - lo) <= (unsigned char)(hi - lo));
+}
+
+#ifdef SIMD_NEON
+/** Narrows a byte mask vector (0x00 or 0xFF per lane) to 4 bits per lane */
+static inline uint64_t _neon_mask(uint8x16_t m)
+{
+	return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+}
+#endif
+
+/** Counts the leading bytes of `str` that are plain ASCII characters and not special in some other way.
+	A span ends at the first NUL byte, non-ASCII byte, byte equal to `x`, or byte in the range `lo...hi`.
+	Pass `x = 0` to disable the single byte check, and `lo > hi` to disable the range check.
+
+	@param n Maximum number of bytes to check
+	@param readable Whether all `n` bytes may be read, even past a NUL byte.
+			If unset, the scan proceeds bytewise so that it never reads past a NUL terminator.
+*/
+static inline size_t _ascii_span(const char *str, size_t n, bool readable, unsigned char x, unsigned char lo, unsigned char hi)
+{
+	size_t i = 0;
+
+	if(readable)
+	{
+	#if defined(SIMD_SSE2)
+		const __m128i vx = _mm_set1_epi8((char)x), vlo = _mm_set1_epi8((char)lo);
+		const __m128i vw = _mm_set1_epi8((char)(unsigned char)(hi - lo)), zero = _mm_setzero_si128();
+		const bool range = lo <= hi;
+
+		for(; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+		{
+			const __m128i v = _mm_loadu_si128((const __m128i*)(str + i));
+			// non-ASCII bytes are negative
+			__m128i stop = _mm_or_si128(_mm_cmplt_epi8(v, zero), _mm_cmpeq_epi8(v, zero));
+			stop = _mm_or_si128(stop, _mm_cmpeq_epi8(v, vx));
+
+			if(range)
+			{
+				const __m128i d = _mm_sub_epi8(v, vlo);
+				stop = _mm_or_si128(stop, _mm_cmpeq_epi8(_mm_min_epu8(d, vw), d));
+			}
+
+			const unsigned m = _mm_movemask_epi8(stop);
+
+			if(m)
+				return i + _ctz(m);
+		}
+	#elif defined(SIMD_NEON)
+		const uint8x16_t vx = vdupq_n_u8(x), vlo = vdupq_n_u8(lo), vw = vdupq_n_u8(hi - lo);
+		const uint8x16_t vhigh = vdupq_n_u8(0x80);
+		const bool range = lo <= hi;
+
+		for(; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+		{
+			const uint8x16_t v = vld1q_u8((const uint8_t*)str + i);
+			uint8x16_t stop = vorrq_u8(vcgeq_u8(v, vhigh), vceqzq_u8(v));
+			stop = vorrq_u8(stop, vceqq_u8(v, vx));
+
+			if(range)
+				stop = vorrq_u8(stop, vcleq_u8(vsubq_u8(v, vlo), vw));
+
+			const uint64_t m = _neon_mask(stop);
+
+			if(m)
+				return i + _ctz(m) / 4;
+		}
+	#else
+		if(x == 0 && lo > hi)
+		{ // SWAR path for the pure ASCII check
+			const uint64_t ones = 0x0101010101010101ull, highs = 0x8080808080808080ull;
+
+			for(; i + 8 <= n; i += 8)
+			{
+				uint64_t w;
+				memcpy(&w, str + i, 8);
+
+				// nonzero iff some byte is zero or has its high bit set
+				if(((w - ones) | w) & highs)
+					break;
+			}
+		}
+	#endif
+	}
+
+	while(i < n && !_span_stop(str[i], x, lo, hi))
+		++i;
+
+	return i;
+}
+
+/** Maximum number of members of a byte set that are compared one by one when no byte shuffle is available */
+#define BYTESET_LIST 8
+
+/** A set of ASCII bytes, prepared for vectorized membership tests */
+struct ByteSet
+{
+	/** Membership bitmap of all ASCII bytes */
+	uint64_t bits[2];
+	/** Nibble lookup tables. A byte `b` is a member iff. `lo[b & 15] & hi[b >> 4]` */
+	uint8_t lo[16], hi[16];
+	/** The first members, excluding NUL */
+	unsigned char list[BYTESET_LIST];
+	/** Number of members, excluding NUL */
+	unsigned count;
+};
+
+/** Initializes an empty byte set */
+static inline void _byteset_init(struct ByteSet *set)
+{
+	memset(set, 0, sizeof(*set));
+
+	for(unsigned h = 0; h < 8; ++h)
+		set->hi[h] = 1 << h;
+}
+
+/** Adds an ASCII byte to a byte set */
+static inline void _byteset_add(struct ByteSet *set, unsigned char b)
+{
+	const uint64_t bit = (uint64_t)1 << (b % 64);
+
+	if(b >= 0x80 || (set->bits[b / 64] & bit))
+		return;
+
+	set->bits[b / 64] |= bit;
+	set->lo[b & 15] |= 1 << (b >> 4);
+
+	if(b && set->count++ < BYTESET_LIST)
+		set->list[set->count - 1] = b;
+}
+
+static inline bool _byteset_has(const struct ByteSet *set, unsigned char b)
+{
+	return b < 0x80 && (set->bits[b / 64] >> (b % 64)) & 1;
+}
+
+/** Counts the leading bytes of `str` that are plain ASCII characters and either all in or all outside of a byte set.
+	A span ends at the first NUL byte, non-ASCII byte, or byte whose membership differs from `in`.
+
+	@param n Maximum number of bytes to check
+	@param readable Whether all `n` bytes may be read, even past a NUL byte. @see _ascii_span
+	@param in Whether to count members or non-members
+*/
+static inline size_t _byteset_span(const char *str, size_t n, bool readable, const struct ByteSet *set, bool in)
+{
+	size_t i = 0;
+
+	if(readable)
+	{
+	#if defined(SIMD_SSSE3) || defined(SIMD_SSE2)
+		const __m128i zero = _mm_setzero_si128();
+		const unsigned flip = in ? 0 : 0xFFFF;
+	#endif
+
+	#if defined(SIMD_SSSE3)
+		const __m128i lo = _mm_loadu_si128((const __m128i*)set->lo), hi = _mm_loadu_si128((const __m128i*)set->hi);
+		const __m128i nibble = _mm_set1_epi8(0x0F);
+
+		for(; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+		{
+			const __m128i v = _mm_loadu_si128((const __m128i*)(str + i));
+			const __m128i l = _mm_shuffle_epi8(lo, _mm_and_si128(v, nibble));
+			const __m128i h = _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+			const __m128i out = _mm_cmpeq_epi8(_mm_and_si128(l, h), zero);
+			// non-members, NUL bytes and non-ASCII bytes all look up 0
+			const unsigned m = (_mm_movemask_epi8(out) ^ flip) | _mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)) | _mm_movemask_epi8(v);
+
+			if(m)
+				return i + _ctz(m);
+		}
+	#elif defined(SIMD_SSE2)
+		if(set->count <= BYTESET_LIST)
+		{
+			for(; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+			{
+				const __m128i v = _mm_loadu_si128((const __m128i*)(str + i));
+				__m128i member = zero;
+
+				for(unsigned k = 0; k < set->count; ++k)
+					member = _mm_or_si128(member, _mm_cmpeq_epi8(v, _mm_set1_epi8((char)set->list[k])));
+
+				// marks members rather than non-members, so the flip is inverted
+				const unsigned m = (_mm_movemask_epi8(member) ^ flip ^ 0xFFFF) | _mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)) | _mm_movemask_epi8(v);
+
+				if(m)
+					return i + _ctz(m);
+			}
+		}
+	#elif defined(SIMD_NEON)
+		const uint8x16_t lo = vld1q_u8(set->lo), hi = vld1q_u8(set->hi);
+		const uint8x16_t nibble = vdupq_n_u8(0x0F), vhigh = vdupq_n_u8(0x80);
+
+		for(; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+		{
+			const uint8x16_t v = vld1q_u8((const uint8_t*)str + i);
+			const uint8x16_t member = vtstq_u8(vqtbl1q_u8(lo, vandq_u8(v, nibble)), vqtbl1q_u8(hi, vshrq_n_u8(v, 4)));
+			uint8x16_t stop = in ? vmvnq_u8(member) : member;
+			stop = vorrq_u8(stop, vorrq_u8(vcgeq_u8(v, vhigh), vceqzq_u8(v)));
+
+			const uint64_t m = _neon_mask(stop);
+
+			if(m)
+				return i + _ctz(m) / 4;
+		}
+	#endif
+	}
+
+	while(i < n && str[i] && (unsigned char)str[i] < 0x80 && _byteset_has(set, str[i]) == in)
+		++i;
+
+	return i;
+}
+
+/** Determines if a byte is an ASCII letter, digit or underscore */
+static inline bool _is_word(unsigned char b)
+{
+	return (unsigned char)((b | 0x20) - 'a') < 26 || (unsigned char)(b - '0') < 10 || b == '_';
+}
+
+/** Counts the leading bytes of `str` that are ASCII letters, digits or underscores.
+	@param n Maximum number of bytes to check
+	@param readable Whether all `n` bytes may be read. @see _ascii_span
+*/
+static inline size_t _word_span(const char *str, size_t n, bool readable)
+{
+	size_t i = 0;
+
+	if(readable)
+	{
+	#if defined(SIMD_SSE2)
+		const __m128i lower = _mm_set1_epi8(0x20), a = _mm_set1_epi8('a'), zero = _mm_set1_epi8('0');
+		const __m128i letters = _mm_set1_epi8(25), digits = _mm_set1_epi8(9), under = _mm_set1_epi8('_');
+
+		for(; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+		{
+			const __m128i v = _mm_loadu_si128((const __m128i*)(str + i));
+			const __m128i l = _mm_sub_epi8(_mm_or_si128(v, lower), a), d = _mm_sub_epi8(v, zero);
+			__m128i word = _mm_cmpeq_epi8(_mm_min_epu8(l, letters), l);
+			word = _mm_or_si128(word, _mm_cmpeq_epi8(_mm_min_epu8(d, digits), d));
+			word = _mm_or_si128(word, _mm_cmpeq_epi8(v, under));
+
+			const unsigned m = _mm_movemask_epi8(word) ^ 0xFFFF;
+
+			if(m)
+				return i + _ctz(m);
+		}
+	#elif defined(SIMD_NEON)
+		const uint8x16_t lower = vdupq_n_u8(0x20), a = vdupq_n_u8('a'), zero = vdupq_n_u8('0');
+		const uint8x16_t letters = vdupq_n_u8(25), digits = vdupq_n_u8(9), under = vdupq_n_u8('_');
+
+		for(; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+		{
+			const uint8x16_t v = vld1q_u8((const uint8_t*)str + i);
+			uint8x16_t word = vcleq_u8(vsubq_u8(vorrq_u8(v, lower), a), letters);
+			word = vorrq_u8(word, vcleq_u8(vsubq_u8(v, zero), digits));
+			word = vorrq_u8(word, vceqq_u8(v, under));
+
+			const uint64_t m = _neon_mask(vmvnq_u8(word));
+
+			if(m)
+				return i + _ctz(m) / 4;
+		}
+	#endif
+	}
+
+	while(i < n && _is_word(str[i]))
+		++i;
+
+	return i;
+}
+
+/** Counts the leading bytes of `str` that are ASCII digits.
+	@param n Maximum number of bytes to check
+	@param readable Whether all `n` bytes may be read. @see _ascii_span
+*/
+static inline size_t _digit_span(const char *str, size_t n, bool readable)
+{
+	size_t i = 0;
+
+	if(readable)
+	{
+	#if defined(SIMD_SSE2)
+		const __m128i zero = _mm_set1_epi8('0'), nine = _mm_set1_epi8(9);
+
+		for(; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+		{
+			const __m128i d = _mm_sub_epi8(_mm_loadu_si128((const __m128i*)(str + i)), zero);
+			const unsigned m = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(d, nine), d)) ^ 0xFFFF;
+
+			if(m)
+				return i + _ctz(m);
+		}
+	#elif defined(SIMD_NEON)
+		const uint8x16_t zero = vdupq_n_u8('0'), nine = vdupq_n_u8(9);
+
+		for(; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+		{
+			const uint8x16_t d = vsubq_u8(vld1q_u8((const uint8_t*)str + i), zero);
+			const uint64_t m = _neon_mask(vcgtq_u8(d, nine));
+
+			if(m)
+				return i + _ctz(m) / 4;
+		}
+	#endif
+	}
+
+	while(i < n && (unsigned char)(str[i] - '0') < 10)
+		++i;
+
+	return i;
+}
+
+/** Counts the leading bytes of `str` that may appear in a JSON string as-is.
+	A span ends at the first control character (including NUL), non-ASCII byte, double quote or backslash.
+	@param n Maximum number of bytes to check
+	@param readable Whether all `n` bytes may be read. @see _ascii_span
+*/
+static inline size_t _json_span(const char *str, size_t n, bool readable)
+{
+	size_t i = 0;
+
+	if(readable)
+	{
+	#if defined(SIMD_SSE2)
+		const __m128i space = _mm_set1_epi8(0x20), quote = _mm_set1_epi8('"'), backslash = _mm_set1_epi8('\\');
+
+		for(; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+		{
+			const __m128i v = _mm_loadu_si128((const __m128i*)(str + i));
+			// non-ASCII bytes are negative, so compare below the space as well
+			__m128i stop = _mm_cmplt_epi8(v, space);
+			stop = _mm_or_si128(stop, _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)));
+
+			const unsigned m = _mm_movemask_epi8(stop);
+
+			if(m)
+				return i + _ctz(m);
+		}
+	#elif defined(SIMD_NEON)
+		const int8x16_t space = vdupq_n_s8(0x20);
+		const uint8x16_t quote = vdupq_n_u8('"'), backslash = vdupq_n_u8('\\');
+
+		for(; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+		{
+			const uint8x16_t v = vld1q_u8((const uint8_t*)str + i);
+			uint8x16_t stop = vcltq_s8(vreinterpretq_s8_u8(v), space);
+			stop = vorrq_u8(stop, vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash)));
+
+			const uint64_t m = _neon_mask(stop);
+
+			if(m)
+				return i + _ctz(m) / 4;
+		}
+	#endif
+	}
+
+	while(i < n && (unsigned char)(str[i] - 0x20) < 0x60 && str[i] != '"' && str[i] != '\\')
+		++i;
+
+	return i;
+}
+
+/** Converts 8 ASCII digits to their value, most significant digit first */
+static inline uint64_t _parse8(const char *str)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	// combines adjacent digits, then pairs, then quadruples within a single word
+	uint64_t v;
+	memcpy(&v, str, 8);
+	v -= 0x3030303030303030ull;
+	// the first digit is the least significant byte
+	v = (v * 10 + (v >> 8)) & 0x00FF00FF00FF00FFull;
+	v = (v * 100 + (v >> 16)) & 0x0000FFFF0000FFFFull;
+	return (v * 10000 + (v >> 32)) & 0xFFFFFFFFull;
+#else
+	uint64_t v = 0;
+
+	for(unsigned i = 0; i < 8; ++i)
+		v = 10 * v + (str[i] - '0');
+
+	return v;
+#endif
+}
+
+/** Counts the leading UTF-16 or UTF-32 code units of `src` that encode ASCII characters, and narrows them to bytes.
+	@param n Maximum number of code units to convert. All of them must be readable.
+	@param width Size of a code unit, either 2 or 4
+	@param be Whether code units are big-endian
+	@param nul Whether a NUL code unit ends the span
+	@param dst Receives the ASCII bytes, may be NULL. Must hold `n` bytes.
+*/
+static inline size_t _narrow_ascii(const unsigned char *src, size_t n, unsigned width, bool be, bool nul, char *dst)
+{
+	size_t i = 0;
+
+#if defined(SIMD_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+
+	if(width == 2)
+	{
+		// big-endian units have their high byte first
+		const __m128i high = _mm_set1_epi16((short)(be ? 0x80FF : 0xFF80));
+
+		for(; i + SIMD_WIDTH / 2 <= n; i += SIMD_WIDTH / 2)
+		{
+			const __m128i v = _mm_loadu_si128((const __m128i*)(src + 2 * i));
+			__m128i ok = _mm_cmpeq_epi16(_mm_and_si128(v, high), zero);
+
+			if(nul)
+				ok = _mm_andnot_si128(_mm_cmpeq_epi16(v, zero), ok);
+			if(dst)
+				_mm_storel_epi64((__m128i*)(dst + i), _mm_packus_epi16(be ? _mm_srli_epi16(v, 8) : v, zero));
+
+			const unsigned m = _mm_movemask_epi8(ok) ^ 0xFFFF;
+
+			if(m)
+				return i + _ctz(m) / 2;
+		}
+	}
+	else
+	{
+		const __m128i high = _mm_set1_epi32((int)(be ? 0x80FFFFFFu : 0xFFFFFF80u));
+
+		for(; i + SIMD_WIDTH / 4 <= n; i += SIMD_WIDTH / 4)
+		{
+			const __m128i v = _mm_loadu_si128((const __m128i*)(src + 4 * i));
+			__m128i ok = _mm_cmpeq_epi32(_mm_and_si128(v, high), zero);
+
+			if(nul)
+				ok = _mm_andnot_si128(_mm_cmpeq_epi32(v, zero), ok);
+			if(dst)
+			{
+				const __m128i w = _mm_packs_epi32(be ? _mm_srli_epi32(v, 24) : v, zero);
+				const int32_t b = _mm_cvtsi128_si32(_mm_packus_epi16(w, zero));
+				memcpy(dst + i, &b, 4);
+			}
+
+			const unsigned m = _mm_movemask_epi8(ok) ^ 0xFFFF;
+
+			if(m)
+				return i + _ctz(m) / 4;
+		}
+	}
+#elif defined(SIMD_NEON)
+	if(width == 2)
+	{
+		const uint16x8_t high = vdupq_n_u16(0xFF80), zero = vdupq_n_u16(0);
+
+		for(; i + SIMD_WIDTH / 2 <= n; i += SIMD_WIDTH / 2)
+		{
+			const uint8x16_t b = vld1q_u8(src + 2 * i);
+			const uint16x8_t v = vreinterpretq_u16_u8(be ? vrev16q_u8(b) : b);
+			uint16x8_t bad = vtstq_u16(v, high);
+
+			if(nul)
+				bad = vorrq_u16(bad, vceqq_u16(v, zero));
+			if(dst)
+				vst1_u8((uint8_t*)dst + i, vmovn_u16(v));
+
+			const uint64_t m = _neon_mask(vreinterpretq_u8_u16(bad));
+
+			if(m)
+				return i + _ctz(m) / 8;
+		}
+	}
+	else
+	{
+		const uint32x4_t high = vdupq_n_u32(0xFFFFFF80), zero = vdupq_n_u32(0);
+
+		for(; i + SIMD_WIDTH / 4 <= n; i += SIMD_WIDTH / 4)
+		{
+			const uint8x16_t b = vld1q_u8(src + 4 * i);
+			const uint32x4_t v = vreinterpretq_u32_u8(be ? vrev32q_u8(b) : b);
+			uint32x4_t bad = vtstq_u32(v, high);
+
+			if(nul)
+				bad = vorrq_u32(bad, vceqq_u32(v, zero));
+			if(dst)
+			{
+				const uint16x4_t w = vmovn_u32(v);
+				const uint32_t a = vget_lane_u32(vreinterpret_u32_u8(vmovn_u16(vcombine_u16(w, w))), 0);
+				memcpy(dst + i, &a, 4);
+			}
+
+			const uint64_t m = _neon_mask(vreinterpretq_u8_u32(bad));
+
+			if(m)
+				return i + _ctz(m) / 16;
+		}
+	}
+#endif
+
+	for(; i < n; ++i)
+	{
+		const unsigned char *u = src + width * i;
+		// the ASCII byte is the least significant one
+		const unsigned char a = be ? u[width - 1] : u[0];
+		bool ok = a < 0x80 && (a || !nul);
+
+		for(unsigned j = 1; j < width; ++j)
+			ok = ok && !u[be ? j - 1 : j];
+
+		if(! ok)
+			break;
+		if(dst)
+			dst[i] = a;
+	}
+
+	return i;
+}
+
+/** Widens ASCII bytes to UTF-16 or UTF-32 code units.
+	@param n Number of bytes, which must all be ASCII
+	@param width Size of a code unit, either 2 or 4
+	@param be Whether to write big-endian code units
+	@param dst Receives `n` code units
+*/
+static inline void _widen_ascii(const char *src, size_t n, unsigned width, bool be, unsigned char *dst)
+{
+	size_t i = 0;
+
+#if defined(SIMD_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+
+	for(; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+	{
+		const __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+		const __m128i lo = be ? _mm_unpacklo_epi8(zero, v) : _mm_unpacklo_epi8(v, zero);
+		const __m128i hi = be ? _mm_unpackhi_epi8(zero, v) : _mm_unpackhi_epi8(v, zero);
+		__m128i *out = (__m128i*)(dst + width * i);
+
+		if(width == 2)
+		{
+			_mm_storeu_si128(out, lo);
+			_mm_storeu_si128(out + 1, hi);
+		}
+		else if(be)
+		{
+			_mm_storeu_si128(out, _mm_unpacklo_epi16(zero, lo));
+			_mm_storeu_si128(out + 1, _mm_unpackhi_epi16(zero, lo));
+			_mm_storeu_si128(out + 2, _mm_unpacklo_epi16(zero, hi));
+			_mm_storeu_si128(out + 3, _mm_unpackhi_epi16(zero, hi));
+		}
+		else
+		{
+			_mm_storeu_si128(out, _mm_unpacklo_epi16(lo, zero));
+			_mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, zero));
+			_mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, zero));
+			_mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, zero));
+		}
+	}
+#elif defined(SIMD_NEON)
+	const uint8x16_t zero = vdupq_n_u8(0);
+
+	for(; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+	{
+		const uint8x16_t v = vld1q_u8((const uint8_t*)src + i);
+		const uint8x16_t lo = be ? vzip1q_u8(zero, v) : vzip1q_u8(v, zero);
+		const uint8x16_t hi = be ? vzip2q_u8(zero, v) : vzip2q_u8(v, zero);
+		uint8_t *out = dst + width * i;
+
+		if(width == 2)
+		{
+			vst1q_u8(out, lo);
+			vst1q_u8(out + 16, hi);
+		}
+		else
+		{
+			const uint16x8_t z = vdupq_n_u16(0), l = vreinterpretq_u16_u8(lo), h = vreinterpretq_u16_u8(hi);
+			vst1q_u8(out, vreinterpretq_u8_u16(be ? vzip1q_u16(z, l) : vzip1q_u16(l, z)));
+			vst1q_u8(out + 16, vreinterpretq_u8_u16(be ? vzip2q_u16(z, l) : vzip2q_u16(l, z)));
+			vst1q_u8(out + 32, vreinterpretq_u8_u16(be ? vzip1q_u16(z, h) : vzip1q_u16(h, z)));
+			vst1q_u8(out + 48, vreinterpretq_u8_u16(be ? vzip2q_u16(z, h) : vzip2q_u16(h, z)));
+		}
+	}
+#endif
+
+	for(; i < n; ++i)
+	{
+		unsigned char *u = dst + width * i;
+		memset(u, 0, width);
+		u[be ? width - 1 : 0] = src[i];
+	}
+}
+
+/** Number of continuation bytes that follow a lead byte in well-formed utf-8, 0 for anything else */
+static inline unsigned _u8_trail(unsigned char b)
+{
+	return b >= 0xF0 ? 3 : b >= 0xE0 ? 2 : b >= 0xC0;
+}
+
+/** Counts characters and newlines in the longest prefix of `str` that is structurally well-formed utf-8,
+	i.e. where every lead byte is followed by exactly as many continuation bytes as it announces.
+	Such a prefix decodes to one character per non-continuation byte, regardless of overlong encodings.
+	@param str A string that starts at a character boundary
+	@param n Number of bytes to consider, all of which must be readable
+	@param chars Overwritten with the number of characters in the prefix
+	@param lines Overwritten with the number of newlines in the prefix, including overlong encodings
+	@param tail Overwritten with the number of characters after the last newline, or `chars` if there is none
+	@returns The length of the prefix in bytes. Less than `n` only if the next character is malformed or cut off by `n`.
+*/
+static inline size_t _u8_count(const char *str, size_t n, size_t *chars, size_t *lines, size_t *tail)
+{
+	size_t i = 0, ok = 0, nc = 0, nl = 0, nt = 0;
+
+	for(;;)
+	{
+	// vectors are only entered at character boundaries, so no earlier lead is pending
+	#if defined(SIMD_SSE2)
+		const __m128i zero = _mm_setzero_si128(), newline = _mm_set1_epi8('\n');
+		__m128i pv = zero, p2 = zero, p3 = zero, p4 = zero;
+
+		for(; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+		{
+			const __m128i v = _mm_loadu_si128((const __m128i*)(str + i));
+			const unsigned nls = _mm_movemask_epi8(_mm_cmpeq_epi8(v, newline));
+
+			// plain ASCII after plain ASCII needs no classification
+			if(! _mm_movemask_epi8(_mm_or_si128(v, p2)))
+			{
+				nc += SIMD_WIDTH;
+
+				if(nls)
+				{
+					nl += _popcnt(nls);
+					nt = SIMD_WIDTH - 1 - _msb(nls);
+				}
+				else
+					nt += SIMD_WIDTH;
+
+				pv = v;
+				continue;
+			}
+
+			const __m128i high = _mm_cmplt_epi8(v, zero);
+			const __m128i cont = _mm_cmplt_epi8(v, _mm_set1_epi8(-0x40));
+			// leads of at least 2, 3 and 4 bytes, and bytes that can't start a sequence
+			const __m128i l2 = _mm_andnot_si128(cont, high);
+			const __m128i l3 = _mm_and_si128(high, _mm_cmpgt_epi8(v, _mm_set1_epi8(-0x21)));
+			const __m128i l4 = _mm_and_si128(high, _mm_cmpgt_epi8(v, _mm_set1_epi8(-0x11)));
+			const __m128i l5 = _mm_and_si128(high, _mm_cmpgt_epi8(v, _mm_set1_epi8(-0x09)));
+
+			// positions that must hold a continuation byte of an earlier lead
+			__m128i need = _mm_or_si128(_mm_slli_si128(l2, 1), _mm_srli_si128(p2, 15));
+			need = _mm_or_si128(need, _mm_or_si128(_mm_slli_si128(l3, 2), _mm_srli_si128(p3, 14)));
+			need = _mm_or_si128(need, _mm_or_si128(_mm_slli_si128(l4, 3), _mm_srli_si128(p4, 13)));
+
+			__m128i bad = _mm_or_si128(_mm_xor_si128(need, cont), l5);
+
+			// the last byte of an overlong newline, i.e. 8A after C0, E0 80 or F0 80 80
+			const __m128i b1 = _mm_or_si128(_mm_slli_si128(v, 1), _mm_srli_si128(pv, 15));
+			const __m128i b2 = _mm_or_si128(_mm_slli_si128(v, 2), _mm_srli_si128(pv, 14));
+			const __m128i b3 = _mm_or_si128(_mm_slli_si128(v, 3), _mm_srli_si128(pv, 13));
+			const __m128i c80 = _mm_set1_epi8(-0x80);
+			__m128i over = _mm_and_si128(_mm_cmpeq_epi8(b2, _mm_set1_epi8(-0x20)), _mm_cmpeq_epi8(b1, c80));
+			over = _mm_or_si128(over, _mm_and_si128(_mm_cmpeq_epi8(b3, _mm_set1_epi8(-0x10)), _mm_and_si128(_mm_cmpeq_epi8(b2, c80), _mm_cmpeq_epi8(b1, c80))));
+			over = _mm_or_si128(over, _mm_cmpeq_epi8(b1, _mm_set1_epi8(-0x40)));
+			bad = _mm_or_si128(bad, _mm_and_si128(over, _mm_cmpeq_epi8(v, _mm_set1_epi8(-0x76))));
+
+			if(_mm_movemask_epi8(bad))
+				break;
+
+			const unsigned starts = _mm_movemask_epi8(cont) ^ 0xFFFF;
+
+			nc += _popcnt(starts);
+
+			if(nls)
+			{
+				nl += _popcnt(nls);
+				nt = _popcnt(starts >> _msb(nls) >> 1);
+			}
+			else
+				nt += _popcnt(starts);
+
+			pv = v;
+			p2 = l2;
+			p3 = l3;
+			p4 = l4;
+		}
+	#elif defined(SIMD_NEON)
+		const uint8x16_t zero = vdupq_n_u8(0), newline = vdupq_n_u8('\n');
+		uint8x16_t pv = zero, p2 = zero, p3 = zero, p4 = zero;
+
+		for(; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+		{
+			const uint8x16_t v = vld1q_u8((const uint8_t*)str + i);
+			// 4 bits per lane
+			const uint64_t nls = _neon_mask(vceqq_u8(v, newline));
+
+			// plain ASCII after plain ASCII needs no classification
+			if(vmaxvq_u8(vorrq_u8(v, p2)) < 0x80)
+			{
+				nc += SIMD_WIDTH;
+
+				if(nls)
+				{
+					nl += _popcnt(nls) / 4;
+					nt = SIMD_WIDTH - 1 - _msb(nls) / 4;
+				}
+				else
+					nt += SIMD_WIDTH;
+
+				pv = v;
+				continue;
+			}
+
+			const uint8x16_t cont = vandq_u8(vcgeq_u8(v, vdupq_n_u8(0x80)), vcltq_u8(v, vdupq_n_u8(0xC0)));
+			// leads of at least 2, 3 and 4 bytes, and bytes that can't start a sequence
+			const uint8x16_t l2 = vcgeq_u8(v, vdupq_n_u8(0xC0));
+			const uint8x16_t l3 = vcgeq_u8(v, vdupq_n_u8(0xE0));
+			const uint8x16_t l4 = vcgeq_u8(v, vdupq_n_u8(0xF0));
+			const uint8x16_t l5 = vcgeq_u8(v, vdupq_n_u8(0xF8));
+
+			// positions that must hold a continuation byte of an earlier lead
+			uint8x16_t need = vorrq_u8(vextq_u8(p2, l2, 15), vextq_u8(p3, l3, 14));
+			need = vorrq_u8(need, vextq_u8(p4, l4, 13));
+
+			uint8x16_t bad = vorrq_u8(veorq_u8(need, cont), l5);
+
+			// the last byte of an overlong newline, i.e. 8A after C0, E0 80 or F0 80 80
+			const uint8x16_t b1 = vextq_u8(pv, v, 15), b2 = vextq_u8(pv, v, 14), b3 = vextq_u8(pv, v, 13);
+			const uint8x16_t c80 = vdupq_n_u8(0x80);
+			uint8x16_t over = vandq_u8(vceqq_u8(b2, vdupq_n_u8(0xE0)), vceqq_u8(b1, c80));
+			over = vorrq_u8(over, vandq_u8(vceqq_u8(b3, vdupq_n_u8(0xF0)), vandq_u8(vceqq_u8(b2, c80), vceqq_u8(b1, c80))));
+			over = vorrq_u8(over, vceqq_u8(b1, vdupq_n_u8(0xC0)));
+			bad = vorrq_u8(bad, vandq_u8(over, vceqq_u8(v, vdupq_n_u8(0x8A))));
+
+			if(vmaxvq_u8(bad))
+				break;
+
+			const uint64_t starts = ~_neon_mask(cont);
+
+			nc += _popcnt(starts) / 4;
+
+			if(nls)
+			{
+				nl += _popcnt(nls) / 4;
+				nt = _msb(nls) == 63 ? 0 : _popcnt(starts >> _msb(nls) >> 1) / 4;
+			}
+			else
+				nt += _popcnt(starts) / 4;
+
+			pv = v;
+			p2 = l2;
+			p3 = l3;
+			p4 = l4;
+		}
+	#endif
+
+		// a character that started in a vector is only counted once it's complete
+		ok = i;
+		unsigned pending = 0;
+		uint32_t c = 0;
+
+		for(unsigned k = 1; k <= 3 && k <= i; ++k)
+		{
+			const unsigned t = _u8_trail(str[i - k]);
+
+			if(t >= k)
+			{
+				pending = t + 1 - k;
+				ok = i - k;
+				c = str[ok] & (0x3F >> t);
+
+				for(size_t j = ok + 1; j < i; ++j)
+					c = c << 6 | (str[j] & 0x3F);
+
+				--nc;
+				--nt;
+				break;
+			}
+		}
+
+	#ifdef SIMD_WIDTH
+		// the vector that stopped is handled bytewise, then vectors take over again
+		const size_t resume = i + SIMD_WIDTH;
+	#else
+		const size_t resume = n;
+	#endif
+
+		for(; i < n && (pending || i < resume); ++i)
+		{
+			const unsigned char b = str[i];
+			const bool cont = (b & 0xC0) == 0x80;
+
+			if(pending)
+			{
+				if(! cont)
+					goto done;
+
+				c = c << 6 | (b & 0x3F);
+
+				if(--pending)
+					continue;
+			}
+			else if(cont || b >= 0xF8)
+				goto done;
+			else if((pending = _u8_trail(b)))
+			{
+				c = b & (0x3F >> pending);
+				continue;
+			}
+			else
+				c = b;
+
+			ok = i + 1;
+			++nc;
+
+			if(c == '\n')
+			{
+				++nl;
+				nt = 0;
+			}
+			else
+				++nt;
+		}
+
+		if(i >= n)
+			break;
+	}
+
+	done:
+	*chars = nc;
+	*lines = nl;
+	*tail = nt;
+	return ok;
+}
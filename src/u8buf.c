@@ -0,0 +1,218 @@
+// u8buf.c: Implements a growable output buffer for single-pass string transformations
+#include "unic.h"
+#include "scan.h"
+#include "simd.h"
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Smallest heap capacity allocated by a buffer */
+#define BUF_MIN_CAP 64
+
+u8buf_t u8buf_init(char *arena, size_t size, bool nulTerminate)
+{
+	return (u8buf_t) {
+		.bytes = arena,
+		.byteCount = 0,
+		.charCount = 0,
+		.cap = arena ? size : 0,
+		.arena = arena,
+		.arenaSize = arena ? size : 0,
+		.nulTerminate = nulTerminate
+	};
+}
+
+void u8buf_free(u8buf_t *buf)
+{
+	if(buf->bytes != buf->arena)
+		free(buf->bytes);
+
+	buf->bytes = buf->arena;
+	buf->cap = buf->arenaSize;
+	buf->byteCount = 0;
+	buf->charCount = 0;
+}
+
+int u8buf_reserve(u8buf_t *buf, size_t n)
+{
+	if(buf->cap - buf->byteCount >= n)
+		return 0;
+
+	if(n > SIZE_MAX - buf->byteCount)
+	{
+		errno = EOVERFLOW;
+		return -1;
+	}
+
+	const size_t need = buf->byteCount + n;
+	size_t cap = buf->cap < BUF_MIN_CAP ? BUF_MIN_CAP : buf->cap;
+
+	// amortized doubling
+	while(cap < need)
+		cap = (cap > SIZE_MAX/2) ? need : 2*cap;
+
+	char *nbuf;
+
+	if(buf->bytes == buf->arena)
+	{ // leaving the arena (or the initial empty state)
+		nbuf = malloc(cap);
+
+		if(! nbuf)
+			return -1;
+		if(buf->byteCount)
+			memcpy(nbuf, buf->bytes, buf->byteCount);
+	}
+	else
+	{
+		nbuf = realloc(buf->bytes, cap);
+
+		if(! nbuf)
+			return -1;
+	}
+
+	buf->bytes = nbuf;
+	buf->cap = cap;
+	return 0;
+}
+
+/** Encodes a character at the end of a buffer that has at least `UTF8_MAX` free bytes */
+static inline void _put(u8buf_t *buf, uchar_t c)
+{
+	if(!c && buf->nulTerminate)
+	{
+		buf->bytes[buf->byteCount++] = UNUL[0];
+		buf->bytes[buf->byteCount++] = UNUL[1];
+	}
+	else
+		buf->byteCount += u8enc(c, buf->bytes + buf->byteCount);
+
+	++buf->charCount;
+}
+
+int u8buf_appendc(u8buf_t *buf, uchar_t c)
+{
+	if(u8buf_reserve(buf, UTF8_MAX))
+		return -1;
+
+	_put(buf, c);
+	return 0;
+}
+
+int u8buf_append(u8buf_t *buf, const char *str, u8size_t size)
+{
+	return u8z_strcpy_into(str, size, buf).bytesExact ? 0 : -1;
+}
+
+char *u8buf_finish(u8buf_t *buf, u8size_t *out_size)
+{
+	// always reserve one byte so that the result is never NULL
+	if(u8buf_reserve(buf, 1))
+		return NULL;
+
+	if(buf->nulTerminate)
+		buf->bytes[buf->byteCount] = 0;
+
+	if(out_size)
+		*out_size = (u8size_t){ true, buf->byteCount + !!buf->nulTerminate, true, buf->charCount };
+
+	char *res = buf->bytes;
+
+	if(res != buf->arena && buf->cap > buf->byteCount + 1)
+	{ // give back excess capacity
+		char *shrunk = realloc(res, buf->byteCount + 1);
+
+		if(shrunk)
+			res = shrunk;
+	}
+
+	// detach the result from the buffer
+	buf->bytes = NULL;
+	buf->arena = NULL;
+	buf->arenaSize = 0;
+	buf->cap = 0;
+	buf->byteCount = 0;
+	buf->charCount = 0;
+
+	return res;
+}
+
+u8size_t u8z_strmap_into(const char *str, u8size_t size, u8buf_t *buf, uchar_t (*map_f)(uchar_t))
+{
+	const size_t b0 = buf->byteCount, c0 = buf->charCount;
+	bool failed = false;
+
+	SCAN(str, size, {
+		if(buf->cap - buf->byteCount < UTF8_MAX && u8buf_reserve(buf, UTF8_MAX))
+		{
+			failed = true;
+			break;
+		}
+
+		_put(buf, map_f(c));
+	})
+
+	return (u8size_t){ !failed, buf->byteCount - b0, !failed, buf->charCount - c0 };
+}
+
+u8size_t u8z_strcpy_into(const char *str, u8size_t size, u8buf_t *buf)
+{
+	const size_t b0 = buf->byteCount, c0 = buf->charCount;
+	size_t byteIx = 0, charIx = 0;
+
+	while(HAS_NEXT(byteIx, charIx, size, str))
+	{
+		// copy runs of plain ASCII verbatim
+		size_t lim = size.byteCount - byteIx;
+
+		if(lim > size.charCount - charIx)
+			lim = size.charCount - charIx;
+
+		const size_t run = _ascii_span(str + byteIx, lim, size.bytesExact, 0, 1, 0);
+
+		if(run)
+		{
+			if(u8buf_reserve(buf, run))
+				goto fail;
+
+			memcpy(buf->bytes + buf->byteCount, str + byteIx, run);
+			buf->byteCount += run;
+			buf->charCount += run;
+			byteIx += run;
+			charIx += run;
+			continue;
+		}
+
+		uchar_t c;
+		const size_t l = u8ndec(str + byteIx, size.byteCount - byteIx, &c);
+
+		if(u8buf_appendc(buf, c))
+			goto fail;
+
+		byteIx += l;
+		++charIx;
+	}
+
+	return (u8size_t){ true, buf->byteCount - b0, true, buf->charCount - c0 };
+
+	fail:
+	return (u8size_t){ false, buf->byteCount - b0, false, buf->charCount - c0 };
+}
+
+char *u8z_strmapdup(const char *str, u8size_t size, uchar_t (*map_f)(uchar_t), u8size_t *out_size)
+{
+	u8buf_t buf = u8buf_init(NULL, 0, true);
+
+	if(! u8z_strmap_into(str, size, &buf, map_f).bytesExact)
+	{
+		u8buf_free(&buf);
+		return NULL;
+	}
+
+	char *res = u8buf_finish(&buf, out_size);
+
+	if(! res)
+		u8buf_free(&buf);
+
+	return res;
+}
@@ -0,0 +1,227 @@
+// u8charset.c: Implements codepoint sets and the searches built on them
+#include "unic.h"
+#include "scan.h"
+#include "simd.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** An inclusive range of codepoints */
+struct Range
+{
+	uchar_t lo, hi;
+};
+
+struct Charset
+{
+	/** Every ASCII member, including those of the categories */
+	struct ByteSet ascii;
+	/** Sorted, disjoint and non-adjacent ranges of non-ASCII members */
+	struct Range *ranges;
+	size_t nranges, cap;
+	/** Bitmap of the general categories whose characters are members, indexed by `enum unic_gc` */
+	uint64_t classes;
+};
+
+/** Inserts a range of non-ASCII codepoints, merging it with any ranges it overlaps or touches
+	@returns 0 on success
+	@returns -1 and sets errno on malloc failure
+*/
+static int _insert(u8charset_t set, uchar_t lo, uchar_t hi)
+{
+	size_t i = 0, j = set->nranges;
+
+	// first range that ends at or after `lo - 1`
+	for(size_t l = 0, r = set->nranges; l < r; )
+	{
+		const size_t m = (l + r) / 2;
+
+		if(set->ranges[m].hi + 1 < lo)
+			i = l = m + 1;
+		else
+			r = m;
+	}
+
+	// first range that starts after `hi + 1`
+	for(size_t l = i, r = set->nranges; l < r; )
+	{
+		const size_t m = (l + r) / 2;
+
+		if(set->ranges[m].lo <= hi + 1)
+			l = m + 1;
+		else
+			j = r = m;
+	}
+
+	if(i < j)
+	{ // merge ranges i...j-1 into one
+		if(set->ranges[i].lo < lo)
+			lo = set->ranges[i].lo;
+		if(set->ranges[j - 1].hi > hi)
+			hi = set->ranges[j - 1].hi;
+
+		memmove(set->ranges + i + 1, set->ranges + j, (set->nranges - j) * sizeof(struct Range));
+		set->nranges -= j - i - 1;
+	}
+	else
+	{
+		if(set->nranges == set->cap)
+		{
+			const size_t cap = set->cap ? 2 * set->cap : 8;
+			struct Range *r = realloc(set->ranges, cap * sizeof(struct Range));
+
+			if(! r)
+				return -1;
+
+			set->ranges = r;
+			set->cap = cap;
+		}
+
+		memmove(set->ranges + i + 1, set->ranges + i, (set->nranges - i) * sizeof(struct Range));
+		++set->nranges;
+	}
+
+	set->ranges[i] = (struct Range){ lo, hi };
+	return 0;
+}
+
+u8charset_t u8charset_new(const char *chars, u8size_t size)
+{
+	u8charset_t set = malloc(sizeof(struct Charset));
+
+	if(! set)
+		return NULL;
+
+	_byteset_init(&set->ascii);
+	set->ranges = NULL;
+	set->nranges = set->cap = 0;
+	set->classes = 0;
+
+	SCAN(chars, size, {
+		if(u8charset_add(set, c))
+		{
+			u8charset_free(set);
+			return NULL;
+		}
+	})
+
+	return set;
+}
+
+void u8charset_free(u8charset_t set)
+{
+	if(! set)
+		return;
+
+	free(set->ranges);
+	free(set);
+}
+
+int u8charset_add(u8charset_t set, uchar_t c)
+{
+	return u8charset_addRange(set, c, c);
+}
+
+int u8charset_addRange(u8charset_t set, uchar_t lo, uchar_t hi)
+{
+	if(lo > hi)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	for(; lo < 0x80 && lo <= hi; ++lo)
+		_byteset_add(&set->ascii, lo);
+
+	return lo <= hi ? _insert(set, lo, hi) : 0;
+}
+
+void u8charset_addClass(u8charset_t set, enum unic_gc class)
+{
+	// UNIC_GC_BITS is small enough for every category to fit a single word
+	for(unsigned gc = 0; gc < 64; ++gc)
+	{
+		if(uclass_is(class, gc))
+			set->classes |= (uint64_t)1 << gc;
+	}
+
+	for(unsigned c = 0; c < 0x80; ++c)
+	{
+		if(uchar_is(c, class))
+			_byteset_add(&set->ascii, c);
+	}
+}
+
+bool u8charset_has(u8charset_t set, uchar_t c)
+{
+	if(c < 0x80)
+		return _byteset_has(&set->ascii, c);
+
+	for(size_t l = 0, r = set->nranges; l < r; )
+	{
+		const size_t m = (l + r) / 2;
+
+		if(set->ranges[m].hi < c)
+			l = m + 1;
+		else if(set->ranges[m].lo > c)
+			r = m;
+		else
+			return true;
+	}
+
+	return set->classes && (set->classes >> uchar_class(c)) & 1;
+}
+
+/** Finds the longest prefix whose characters are all in (or all outside of) a set
+	@param in Whether to span members or non-members
+	@returns The exact size of the prefix
+*/
+static u8size_t _span(const char *str, u8size_t size, u8charset_t set, bool in)
+{
+	size_t byteIx = 0, charIx = 0;
+
+	while(HAS_NEXT(byteIx, charIx, size, str))
+	{
+		// skip runs of plain ASCII characters via the bitmap
+		size_t lim = size.byteCount - byteIx;
+
+		if(lim > size.charCount - charIx)
+			lim = size.charCount - charIx;
+
+		const size_t run = _byteset_span(str + byteIx, lim, size.bytesExact, &set->ascii, in);
+
+		byteIx += run;
+		charIx += run;
+
+		if(run)
+			continue;
+
+		uchar_t c;
+		const size_t l = u8ndec(str + byteIx, size.byteCount - byteIx, &c);
+
+		if(u8charset_has(set, c) != in)
+			break;
+
+		byteIx += l;
+		++charIx;
+	}
+
+	return (u8size_t){ true, byteIx, true, charIx };
+}
+
+u8size_t u8z_strspn(const char *str, u8size_t size, u8charset_t set)
+{
+	return _span(str, size, set, true);
+}
+
+u8size_t u8z_strcspn(const char *str, u8size_t size, u8charset_t set)
+{
+	return _span(str, size, set, false);
+}
+
+const char *u8z_strpbrk(const char *str, u8size_t size, u8charset_t set)
+{
+	const u8size_t n = _span(str, size, set, false);
+
+	return HAS_NEXT(n.byteCount, n.charCount, size, str) ? str + n.byteCount : NULL;
+}
@@ -0,0 +1,119 @@
+/* u8class.h: Character class items and case-folding shared by the pattern matchers */
+#pragma once
+#include "unic.h"
+#include <string.h>
+
+/** Kinds of character class items */
+enum
+{
+	I_RANGE,
+	I_CLASS,
+	I_SPACE,
+	I_WORD
+};
+
+/** An item of a character class */
+struct Item
+{
+	uint8_t kind;
+	/** Whether the item matches every character it wouldn't match otherwise */
+	bool negate;
+	uchar_t lo, hi;
+	enum unic_gc class;
+};
+
+/** Named classes that aren't general categories */
+static const struct
+{
+	const char *name;
+	uint8_t kind;
+	enum unic_gc class;
+} _posix[] = {
+	{ "alpha", I_CLASS, UCLASS_LETTER },
+	{ "alnum", I_CLASS, UCLASS_LETTER },
+	{ "alnum", I_CLASS, UCLASS_DECIMAL_NUMBER },
+	{ "digit", I_CLASS, UCLASS_DECIMAL_NUMBER },
+	{ "lower", I_CLASS, UCLASS_LOWERCASE_LETTER },
+	{ "upper", I_CLASS, UCLASS_UPPERCASE_LETTER },
+	{ "punct", I_CLASS, UCLASS_PUNCTUATION },
+	{ "space", I_SPACE, 0 },
+	{ "word", I_WORD, 0 },
+};
+
+/** Maximum number of items a class name expands to */
+#define NAMED_MAX 2
+
+/** Determines the items of a class name, which is either a POSIX name or a general category
+	@param out Overwritten with the items
+	@returns The number of items written to `out`, 0 if the name is unknown
+*/
+static inline unsigned _class_named(const char *name, size_t len, struct Item out[NAMED_MAX])
+{
+	unsigned n = 0;
+
+	for(size_t i = 0; i < sizeof(_posix) / sizeof(*_posix); ++i)
+	{
+		if(strlen(_posix[i].name) == len && memcmp(_posix[i].name, name, len) == 0)
+			out[n++] = (struct Item){ .kind = _posix[i].kind, .class = _posix[i].class };
+	}
+
+	enum unic_gc class;
+
+	if(! n && uclass_byname(name, len, &class))
+		out[n++] = (struct Item){ .kind = I_CLASS, .class = class };
+
+	return n;
+}
+
+/** Determines the alternatives a character is matched by.
+	With case-folding, two characters are alike iff. their alternatives intersect.
+	@returns The number of distinct alternatives written to `out`
+*/
+static inline unsigned _fold_alts(uchar_t c, bool fold, uchar_t out[3])
+{
+	unsigned n = 0;
+	out[n++] = c;
+
+	if(fold)
+	{
+		const uchar_t lo = uchar_lower(c), up = uchar_upper(c);
+
+		if(lo != c)
+			out[n++] = lo;
+		if(up != c && up != lo)
+			out[n++] = up;
+	}
+
+	return n;
+}
+
+/** Matches a character against a class item, including its `negate` flag.
+	Case-folding only applies to ranges, not to named classes.
+	@param alt The alternatives of `c`, as per `_fold_alts()`
+*/
+static inline bool _item_match(const struct Item *it, uchar_t c, const uchar_t *alt, unsigned nalt)
+{
+	bool m = false;
+
+	switch(it->kind)
+	{
+		case I_RANGE:
+			for(unsigned k = 0; k < nalt && !m; ++k)
+				m = alt[k] >= it->lo && alt[k] <= it->hi;
+		break;
+
+		case I_CLASS:
+			m = uchar_is(c, it->class);
+		break;
+
+		case I_SPACE:
+			m = u_isspace(c);
+		break;
+
+		default:
+			m = c == '_' || uchar_is(c, UCLASS_LETTER) || uchar_is(c, UCLASS_MARK) || uchar_is(c, UCLASS_DECIMAL_NUMBER);
+		break;
+	}
+
+	return m != it->negate;
+}
@@ -0,0 +1,145 @@
+// u8collate.c: Implements sort keys as per a simplified Unicode Collation Algorithm (UTS #10)
+#include "unic.h"
+#include "scan.h"
+#include "ucdb.h"
+
+/** Separates the weights of two levels in a sort key. Lower than the first byte of any weight. */
+#define LEVEL_SEPARATOR 0x01
+
+/** Hangul syllable constants, as per section 3.12 of the Unicode standard */
+#define HANGUL_S 0xAC00
+#define HANGUL_L 0x1100
+#define HANGUL_V 0x1161
+#define HANGUL_T 0x11A7
+#define HANGUL_T_COUNT 28
+#define HANGUL_N_COUNT (21 * HANGUL_T_COUNT)
+#define HANGUL_S_COUNT (19 * HANGUL_N_COUNT)
+
+/** A sort key being written */
+struct Key
+{
+	char *out;
+	size_t cap;
+	/** Size of the entire key so far, which may exceed `cap` */
+	size_t size;
+};
+
+static inline void _put(struct Key *k, unsigned char b)
+{
+	if(k->size < k->cap)
+		k->out[k->size] = b;
+
+	++k->size;
+}
+
+/** Computes the implicit collation elements of a character without a DUCET entry, as per section 10.1 of UTS #10 */
+static void _implicit(uchar_t c, uint32_t out[2])
+{
+	uint32_t aaaa = 0, bbbb = 0;
+
+	for(size_t i = 0; i < UCDB_COLL_IMPLICITS; ++i)
+	{
+		if(c >= ucdb_coll_implicit[i].first && c <= ucdb_coll_implicit[i].last)
+		{
+			aaaa = ucdb_coll_implicit[i].base;
+			bbbb = (c - ucdb_coll_implicit[i].first) | 0x8000;
+			break;
+		}
+	}
+
+	if(! aaaa)
+	{
+		if(uchar_script(c) != USCRIPT_HAN)
+			aaaa = 0xFBC0;
+		else if((c >= 0x4E00 && c <= 0x9FFF) || (c >= 0xF900 && c <= 0xFAFF))
+			aaaa = 0xFB40;
+		else
+			aaaa = 0xFB80;
+
+		aaaa += c >> 15;
+		bbbb = (c & 0x7FFF) | 0x8000;
+	}
+
+	out[0] = aaaa << 16 | 0x20 << 5 | 0x02;
+	out[1] = bbbb << 16;
+}
+
+/** Appends the weights of a single level of a character's collation elements to a sort key */
+static void _weights(struct Key *k, uchar_t c, enum u8collate_level level)
+{
+	if(c - HANGUL_S < HANGUL_S_COUNT)
+	{ // Hangul syllables are collated as their jamo
+		const uchar_t s = c - HANGUL_S, t = s % HANGUL_T_COUNT;
+
+		_weights(k, HANGUL_L + s / HANGUL_N_COUNT, level);
+		_weights(k, HANGUL_V + s % HANGUL_N_COUNT / HANGUL_T_COUNT, level);
+
+		if(t)
+			_weights(k, HANGUL_T + t, level);
+
+		return;
+	}
+
+	const uint32_t entry = UCDB_STAGES(coll, c);
+	uint32_t implicit[2];
+	const uint32_t *e = ucdb_coll_elements + (entry >> 5);
+	size_t n = entry & 0x1F;
+
+	if(! n)
+	{
+		_implicit(c, implicit);
+		e = implicit;
+		n = 2;
+	}
+
+	for(size_t i = 0; i < n; ++i)
+	{
+		switch(level)
+		{
+			case U8COLLATE_PRIMARY:
+				if(UCDB_COLL_PRIMARY(e[i]))
+				{
+					_put(k, UCDB_COLL_PRIMARY(e[i]) >> 8);
+					_put(k, UCDB_COLL_PRIMARY(e[i]) & 0xFF);
+				}
+				break;
+
+			case U8COLLATE_SECONDARY:
+				// secondary weights start at 0x20
+				if(UCDB_COLL_SECONDARY(e[i]))
+					_put(k, UCDB_COLL_SECONDARY(e[i]) - 0x20 + LEVEL_SEPARATOR + 1);
+				break;
+
+			default:
+				if(UCDB_COLL_TERTIARY(e[i]))
+					_put(k, UCDB_COLL_TERTIARY(e[i]));
+				break;
+		}
+	}
+}
+
+size_t u8z_sortkey(const char *str, u8size_t size, enum u8collate_level level, char *out, size_t cap)
+{
+	struct Key k = { out, out ? cap : 0, 0 };
+
+	for(enum u8collate_level lv = U8COLLATE_PRIMARY; lv <= level && lv <= U8COLLATE_TERTIARY; ++lv)
+	{
+		if(lv > U8COLLATE_PRIMARY)
+			_put(&k, LEVEL_SEPARATOR);
+
+		for(size_t byteIx = 0, charIx = 0; HAS_NEXT(byteIx, charIx, size, str); ++charIx)
+		{
+			uchar_t c = (unsigned char)str[byteIx];
+
+			// plain ASCII needs no decoding
+			if(c < 0x80)
+				++byteIx;
+			else
+				byteIx += u8ndec(str + byteIx, size.byteCount - byteIx, &c);
+
+			_weights(&k, c, lv);
+		}
+	}
+
+	return k.size;
+}
@@ -0,0 +1,880 @@
+// u8edit.c: Implements editable text as a balanced tree of pieces
+#include "u8text.h"
+#include "unic.h"
+#include "simd.h"
+#include "u8span.h"
+#include <assert.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Maximum size of a piece in bytes, which bounds how much text a lookup decodes */
+#define PIECE_MAX (1 << 14)
+
+/** Minimum size of the blocks that inserted text is copied into */
+#define BLOCK_SIZE (1 << 16)
+
+/** Maximum number of unused nodes kept for later edits */
+#define SPARE_MAX 64
+
+/** Number of nodes `_mend()` may take */
+#define MEND_NODES 4
+
+/** Size and line information of a text, as decoded on its own */
+struct Sum
+{
+	/** Size in bytes and characters */
+	size_t bytes, chars;
+	/** Number of newlines */
+	size_t lines;
+	/** Number of characters after the last newline */
+	size_t col;
+};
+
+/** A node of the treap of pieces, which is ordered by text position.
+	Every piece starts and ends at a character boundary of the entire text, so its summary doesn't depend on its neighbors.
+*/
+struct Piece
+{
+	struct Piece *left, *right;
+	/** Heap priority, no smaller than that of either child */
+	uint32_t prio;
+	/** The text of this piece, either part of the original file or of a `Block` */
+	const char *bytes;
+	/** Summary of the text of this piece, and of its entire subtree */
+	struct Sum own, sum;
+};
+
+/** Storage for inserted text, which is never moved or reused */
+struct Block
+{
+	struct Block *prev;
+	size_t cap;
+	char bytes[];
+};
+
+struct TextEditor
+{
+	struct Piece *root;
+	/** Unused nodes, linked through `left` */
+	struct Piece *spare;
+	size_t nSpare;
+	/** Newest block of inserted text, and number of bytes used in it */
+	struct Block *block;
+	size_t used;
+	/** State of the priority generator */
+	uint32_t seed;
+};
+
+//#region Helper Functions
+
+static inline struct Sum _sum_cat(struct Sum a, struct Sum b)
+{
+	return (struct Sum){ a.bytes + b.bytes, a.chars + b.chars, a.lines + b.lines, b.lines ? b.col : a.col + b.col };
+}
+
+/** Summary of a single character */
+static inline struct Sum _sum_chr(size_t len, uchar_t c)
+{
+	return (struct Sum){ len, 1, c == '\n', c != '\n' };
+}
+
+/** The location right after a text */
+static inline u8loc_t _sum_loc(struct Sum s)
+{
+	// the first line is counted from column 0, every other line from column 1
+	return (u8loc_t){ .line = s.lines + 1, .column = s.lines ? s.col + 1 : s.col, .characterIndex = s.chars, .charOff = 0 };
+}
+
+/** Determines if a text reaches a position, given as a number of newlines and the characters after them */
+static inline bool _sum_reaches(struct Sum s, size_t lines, size_t col)
+{
+	return s.lines > lines || (s.lines == lines && s.col >= col);
+}
+
+/** Summarizes a string, counting well-formed spans without decoding them */
+static struct Sum _sum_of(const char *str, size_t n)
+{
+	// every character takes at least one byte, so this passes the entire string
+	size_t chars, lines, tail;
+	const size_t k = _u8_seek(str, n, n, &chars, &lines, &tail);
+	return (struct Sum){ k, chars, lines, tail };
+}
+
+/** Moves forward through a string until it passed a number of characters
+	@param s The summary of the text before `str`, overwritten with the summary before the result
+	@param index The total number of characters to pass, which must be within `str`
+	@returns The offset into `str`
+*/
+static size_t _seek_chr(const char *str, size_t n, struct Sum *s, size_t index)
+{
+	if(s->chars >= index)
+		return 0;
+
+	size_t chars, lines, tail;
+	const size_t k = _u8_seek(str, n, index - s->chars, &chars, &lines, &tail);
+	*s = _sum_cat(*s, (struct Sum){ k, chars, lines, tail });
+	return k;
+}
+
+//#endregion
+
+//#region Tree Operations
+
+static inline struct Sum _sum(const struct Piece *t)
+{
+	return t ? t->sum : (struct Sum){ 0 };
+}
+
+static inline void _update(struct Piece *t)
+{
+	t->sum = _sum_cat(_sum_cat(_sum(t->left), t->own), _sum(t->right));
+}
+
+/** Ensures that there are at least `n` spare nodes
+	@returns 0 on success
+	@returns -1 and sets errno on malloc failure
+*/
+static int _reserve(struct TextEditor *ed, size_t n)
+{
+	for(; ed->nSpare < n; ++ed->nSpare)
+	{
+		struct Piece *p = malloc(sizeof(struct Piece));
+
+		if(! p)
+			return -1;
+
+		p->left = ed->spare;
+		ed->spare = p;
+	}
+
+	return 0;
+}
+
+/** Takes a reserved spare node for a new piece */
+static struct Piece *_node(struct TextEditor *ed, const char *bytes, struct Sum own)
+{
+	struct Piece *p = ed->spare;
+	assert(p);
+	ed->spare = p->left;
+	--ed->nSpare;
+
+	// xorshift32
+	ed->seed ^= ed->seed << 13;
+	ed->seed ^= ed->seed >> 17;
+	ed->seed ^= ed->seed << 5;
+
+	*p = (struct Piece){ NULL, NULL, ed->seed, bytes, own, own };
+	return p;
+}
+
+/** Recycles the nodes of a subtree, keeping a few as spares */
+static void _release(struct TextEditor *ed, struct Piece *t)
+{
+	if(! t)
+		return;
+
+	_release(ed, t->left);
+	_release(ed, t->right);
+
+	if(ed->nSpare < SPARE_MAX)
+	{
+		t->left = ed->spare;
+		ed->spare = t;
+		++ed->nSpare;
+	}
+	else
+		free(t);
+}
+
+/** Ensures that the newest block has room for `n` more bytes
+	@returns 0 on success
+	@returns -1 and sets errno on malloc failure
+*/
+static int _room(struct TextEditor *ed, size_t n)
+{
+	if(ed->block && ed->block->cap - ed->used >= n)
+		return 0;
+
+	const size_t cap = n > BLOCK_SIZE ? n : BLOCK_SIZE;
+	struct Block *b = malloc(sizeof(struct Block) + cap);
+
+	if(! b)
+		return -1;
+
+	b->prev = ed->block;
+	b->cap = cap;
+	ed->block = b;
+	ed->used = 0;
+	return 0;
+}
+
+/** Copies a string to the newest block, which must have room for it */
+static const char *_store(struct TextEditor *ed, const char *str, size_t n)
+{
+	char *copy = ed->block->bytes + ed->used;
+	assert(ed->block->cap - ed->used >= n);
+
+	memcpy(copy, str, n);
+	ed->used += n;
+	return copy;
+}
+
+/** Splits a tree into the text before and after a byte offset, which must be a character boundary.
+	Takes a spare node if the offset is within a piece.
+*/
+static void _split(struct TextEditor *ed, struct Piece *t, size_t off, struct Piece **l, struct Piece **r)
+{
+	if(! t)
+	{
+		*l = *r = NULL;
+		return;
+	}
+
+	const size_t lb = _sum(t->left).bytes;
+
+	if(off <= lb)
+	{
+		_split(ed, t->left, off, l, &t->left);
+		*r = t;
+	}
+	else if(off >= lb + t->own.bytes)
+	{
+		_split(ed, t->right, off - lb - t->own.bytes, &t->right, r);
+		*l = t;
+	}
+	else
+	{ // the piece is cut in two, and its second half takes over the right subtree
+		const size_t k = off - lb;
+		struct Piece *tail = _node(ed, t->bytes + k, _sum_of(t->bytes + k, t->own.bytes - k));
+		tail->prio = t->prio;
+		tail->right = t->right;
+		_update(tail);
+
+		t->own = _sum_of(t->bytes, k);
+		t->right = NULL;
+		*l = t;
+		*r = tail;
+	}
+
+	_update(t);
+}
+
+/** Concatenates two trees */
+static struct Piece *_merge(struct Piece *l, struct Piece *r)
+{
+	if(! l)
+		return r;
+	if(! r)
+		return l;
+
+	if(l->prio >= r->prio)
+	{
+		l->right = _merge(l->right, r);
+		_update(l);
+		return l;
+	}
+	else
+	{
+		r->left = _merge(l, r->left);
+		_update(r);
+		return r;
+	}
+}
+
+/** Builds a balanced tree from pieces in text order */
+static struct Piece *_build(struct Piece **pieces, size_t n)
+{
+	if(! n)
+		return NULL;
+
+	const size_t m = n / 2;
+	struct Piece *t = pieces[m];
+	t->left = _build(pieces, m);
+	t->right = _build(pieces + m + 1, n - m - 1);
+
+	// restores the heap order by moving priorities down, which doesn't change the shape of the tree
+	for(struct Piece *p = t;;)
+	{
+		struct Piece *c = p->left && (! p->right || p->left->prio >= p->right->prio) ? p->left : p->right;
+
+		if(! c || c->prio <= p->prio)
+			break;
+
+		const uint32_t prio = c->prio;
+		c->prio = p->prio;
+		p->prio = prio;
+		p = c;
+	}
+
+	_update(t);
+	return t;
+}
+
+/** Appends bytes that directly follow the text of the last piece of a tree to that piece */
+static void _grow(struct Piece *t, size_t n)
+{
+	if(t->right)
+		_grow(t->right, n);
+	else
+		t->own = _sum_of(t->bytes, t->own.bytes + n);
+
+	_update(t);
+}
+
+/** Finds the piece containing a byte offset, or the last piece if the offset is the end of the text
+	@param off An offset into the text, overwritten with the offset into the piece
+	@param before Overwritten with the summary of the text before the piece
+	@returns The piece, or NULL if `off` is out of bounds or the text is empty
+*/
+static const struct Piece *_find_byte(const struct Piece *t, size_t *off, struct Sum *before)
+{
+	*before = (struct Sum){ 0 };
+
+	while(t)
+	{
+		const size_t lb = _sum(t->left).bytes;
+
+		if(*off < lb)
+		{
+			t = t->left;
+			continue;
+		}
+
+		*off -= lb;
+		*before = _sum_cat(*before, _sum(t->left));
+
+		// an offset past this piece can only be the end of the text if it has no right subtree
+		if(*off < t->own.bytes || (*off == t->own.bytes && ! t->right))
+			return t;
+
+		*off -= t->own.bytes;
+		*before = _sum_cat(*before, t->own);
+		t = t->right;
+	}
+
+	return NULL;
+}
+
+/** Copies a range of the text of a tree */
+static void _copy(const struct Piece *t, size_t off, size_t n, char *dst)
+{
+	if(! t || ! n)
+		return;
+
+	const size_t lb = _sum(t->left).bytes;
+
+	if(off < lb)
+	{
+		const size_t k = n < lb - off ? n : lb - off;
+		_copy(t->left, off, k, dst);
+		dst += k;
+		off += k;
+		n -= k;
+	}
+
+	if(n && off < lb + t->own.bytes)
+	{
+		const size_t k = n < lb + t->own.bytes - off ? n : lb + t->own.bytes - off;
+		memcpy(dst, t->bytes + off - lb, k);
+		dst += k;
+		off += k;
+		n -= k;
+	}
+
+	_copy(t->right, off - lb - t->own.bytes, n, dst);
+}
+
+/** Determines if a byte offset is a character boundary of the text */
+static bool _is_boundary(const struct TextEditor *ed, size_t off)
+{
+	struct Sum before;
+	size_t k = off;
+	const struct Piece *p = _find_byte(ed->root, &k, &before);
+
+	if(! p)
+		return off == 0;
+
+	// pieces never split a character
+	return k == 0 || k == p->own.bytes || _u8_start(p->bytes, p->own.bytes, k) == k;
+}
+
+/** Inserts text from a block at a character boundary, without mending the characters around it */
+static void _put(struct TextEditor *ed, size_t off, const char *str, size_t n)
+{
+	struct Piece *l, *r;
+	_split(ed, ed->root, off, &l, &r);
+
+	struct Piece *last = l;
+
+	while(last && last->right)
+		last = last->right;
+
+	// text that continues the previous insertion extends its piece, so that typing doesn't create a piece per keystroke
+	if(last && str > ed->block->bytes && last->bytes + last->own.bytes == str && last->own.bytes + n <= PIECE_MAX)
+		_grow(l, n);
+	else
+	{
+		for(size_t i = 0; i < n; )
+		{
+			const size_t end = n - i <= PIECE_MAX ? n : _u8_start(str, n, i + PIECE_MAX);
+			l = _merge(l, _node(ed, str + i, _sum_of(str + i, end - i)));
+			i = end;
+		}
+	}
+
+	ed->root = _merge(l, r);
+}
+
+/** Removes a range of the text between character boundaries, without mending the characters around it */
+static void _cut(struct TextEditor *ed, size_t from, size_t to)
+{
+	struct Piece *l, *m, *r;
+	_split(ed, ed->root, to, &m, &r);
+	_split(ed, m, from, &l, &m);
+	_release(ed, m);
+	ed->root = _merge(l, r);
+}
+
+/** Restores that no piece splits a character after the text before and after an offset was joined.
+	A character that now spans several pieces is copied into a piece of its own.
+	Takes up to `MEND_NODES` spare nodes and `UTF8_MAX` bytes of room.
+*/
+static void _mend(struct TextEditor *ed, size_t off)
+{
+	const size_t size = _sum(ed->root).bytes;
+
+	if(off == 0 || off >= size)
+		return;
+
+	char buf[2 * UTF8_MAX];
+	const size_t from = off < UTF8_MAX ? 0 : off - (UTF8_MAX - 1);
+	const size_t to = size - off < UTF8_MAX ? size : off + (UTF8_MAX - 1);
+	_copy(ed->root, from, to - from, buf);
+
+	// since a lead byte always starts a character, only the last one before `off` can span it
+	size_t q = off - from;
+
+	do
+	{
+		if(! q)
+			return;
+	}
+	while((buf[--q] & 0xC0) == 0x80);
+
+	const size_t len = u8ndec(buf + q, to - from - q, NULL);
+
+	if(from + q + len <= off)
+		return;
+
+	struct Sum before;
+	size_t k = from + q;
+	const struct Piece *p = _find_byte(ed->root, &k, &before);
+
+	if(k + len <= p->own.bytes)
+		return;
+
+	const char *copy = _store(ed, buf + q, len);
+	_cut(ed, from + q, from + q + len);
+	_put(ed, from + q, copy, len);
+}
+
+/** Frees every node of a subtree */
+static void _drop(struct Piece *t)
+{
+	if(t)
+	{
+		_drop(t->left);
+		_drop(t->right);
+		free(t);
+	}
+}
+
+//#endregion
+
+u8edit_t u8edit_open(u8file_t file)
+{
+	struct TextEditor *ed = malloc(sizeof(struct TextEditor));
+
+	if(! ed)
+		return NULL;
+
+	*ed = (struct TextEditor){ .seed = 0x9E3779B9 };
+	const size_t size = file ? file->size.byteCount : 0;
+
+	if(! size)
+		return ed;
+
+	// every piece but the last is cut at most UTF8_MAX - 1 bytes short
+	struct Piece **pieces = malloc((size / (PIECE_MAX - UTF8_MAX + 1) + 1) * sizeof(struct Piece*));
+	size_t count = 0;
+
+	if(! pieces)
+		goto fail;
+
+	// the index of the file locates the piece boundaries without decoding it again
+	u8loc_t prev = { .line = 1, .column = 0, .characterIndex = 0, .charOff = 0 };
+
+	for(size_t a = 0, b; a < size; a = b)
+	{
+		struct Sum s;
+		b = a + PIECE_MAX;
+
+		if(b >= size)
+		{
+			b = size;
+			s = _sum_of(file->bytes + a, size - a);
+		}
+		else
+		{
+			u8loc_t loc;
+			u8txt_loc(file, file->bytes + b, &loc);
+			b -= loc.charOff;
+
+			s = (struct Sum){
+				.bytes = b - a,
+				.chars = loc.characterIndex - prev.characterIndex,
+				.lines = loc.line - prev.line,
+				.col = loc.line > prev.line ? loc.column - 1 : loc.column - prev.column
+			};
+
+			prev = loc;
+		}
+
+		if(_reserve(ed, 1))
+			goto fail;
+
+		pieces[count++] = _node(ed, file->bytes + a, s);
+	}
+
+	ed->root = _build(pieces, count);
+	free(pieces);
+	return ed;
+
+	fail:
+	for(size_t i = 0; i < count; ++i)
+		free(pieces[i]);
+
+	free(pieces);
+	u8edit_free(ed);
+	return NULL;
+}
+
+void u8edit_free(u8edit_t ed)
+{
+	_drop(ed->root);
+
+	while(ed->spare)
+	{
+		struct Piece *p = ed->spare;
+		ed->spare = p->left;
+		free(p);
+	}
+
+	while(ed->block)
+	{
+		struct Block *b = ed->block;
+		ed->block = b->prev;
+		free(b);
+	}
+
+	free(ed);
+}
+
+u8size_t u8edit_size(u8edit_t ed)
+{
+	const struct Sum s = _sum(ed->root);
+	return (u8size_t){ .bytesExact = true, .byteCount = s.bytes, .charsExact = true, .charCount = s.chars };
+}
+
+unsigned u8edit_lines(u8edit_t ed)
+{
+	return _sum(ed->root).lines + 1;
+}
+
+//#region Editing
+
+int u8edit_insert(u8edit_t ed, size_t off, const char *str, size_t size)
+{
+	if(! _is_boundary(ed, off))
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	if(! size)
+		return 0;
+
+	// everything an edit allocates is reserved up front, so that a failed edit leaves the text unchanged
+	if(_reserve(ed, 1 + size / (PIECE_MAX - UTF8_MAX + 1) + 1 + 2 * MEND_NODES) || _room(ed, size + 2 * UTF8_MAX))
+		return -1;
+
+	_put(ed, off, _store(ed, str, size), size);
+	_mend(ed, off + size);
+	_mend(ed, off);
+	return 0;
+}
+
+int u8edit_insertAt(u8edit_t ed, unsigned line, unsigned col, const char *str, size_t size)
+{
+	const size_t off = u8edit_unLoc(ed, line, col, NULL);
+
+	if(off == SIZE_MAX)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	return u8edit_insert(ed, off, str, size);
+}
+
+int u8edit_delete(u8edit_t ed, size_t from, size_t to)
+{
+	if(to < from || ! _is_boundary(ed, from) || ! _is_boundary(ed, to))
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	if(from == to)
+		return 0;
+
+	if(_reserve(ed, 2 + MEND_NODES) || _room(ed, UTF8_MAX))
+		return -1;
+
+	_cut(ed, from, to);
+	_mend(ed, from);
+	return 0;
+}
+
+int u8edit_deleteAt(u8edit_t ed, unsigned line, unsigned col, size_t count)
+{
+	size_t index;
+	const size_t from = u8edit_unLoc(ed, line, col, &index);
+
+	if(from == SIZE_MAX)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	// deleting past the end of the text stops at its end
+	const struct Sum all = _sum(ed->root);
+	const size_t to = count >= all.chars - index ? all.bytes : u8edit_chr(ed, index + count, NULL);
+
+	return u8edit_delete(ed, from, to);
+}
+
+//#endregion
+
+//#region Content Lookup
+
+int u8edit_loc(u8edit_t ed, size_t off, u8loc_t *out_loc)
+{
+	const size_t size = _sum(ed->root).bytes;
+
+	if(size == 0)
+		return -1;
+	if(off >= size)
+		return +1;
+
+	if(! out_loc)
+		return 0;
+
+	struct Sum before;
+	const struct Piece *p = _find_byte(ed->root, &off, &before);
+	const size_t start = _u8_start(p->bytes, p->own.bytes, off);
+
+	*out_loc = _sum_loc(_sum_cat(before, _sum_of(p->bytes, start)));
+	out_loc->charOff = off - start;
+	return 0;
+}
+
+size_t u8edit_chr(u8edit_t ed, size_t index, u8loc_t *out_loc)
+{
+	struct Sum before = { 0 };
+
+	for(const struct Piece *t = ed->root; t; )
+	{
+		const struct Sum l = _sum_cat(before, _sum(t->left));
+
+		if(index < l.chars)
+		{
+			t = t->left;
+			continue;
+		}
+
+		const struct Sum r = _sum_cat(l, t->own);
+
+		if(index >= r.chars)
+		{
+			before = r;
+			t = t->right;
+			continue;
+		}
+
+		struct Sum s = l;
+		_seek_chr(t->bytes, t->own.bytes, &s, index);
+
+		if(out_loc)
+			*out_loc = _sum_loc(s);
+
+		return s.bytes;
+	}
+
+	return SIZE_MAX;
+}
+
+size_t u8edit_unLoc(u8edit_t ed, unsigned line, unsigned col, size_t *out_charIndex)
+{
+	// the first line is counted from column 0, every other line from column 1
+	const unsigned col0 = line > 1;
+
+	if(line <= 0 || col < col0)
+		return SIZE_MAX;
+
+	const size_t lines = line - 1, chars = col - col0;
+
+	if(! lines && ! chars)
+	{
+		if(out_charIndex)
+			*out_charIndex = 0;
+
+		return 0;
+	}
+
+	struct Sum before = { 0 };
+
+	for(const struct Piece *t = ed->root; t; )
+	{
+		const struct Sum l = _sum_cat(before, _sum(t->left));
+
+		// the text before the current subtree never reaches the location
+		if(_sum_reaches(l, lines, chars))
+		{
+			assert(t->left);
+			t = t->left;
+			continue;
+		}
+
+		const struct Sum r = _sum_cat(l, t->own);
+
+		if(! _sum_reaches(r, lines, chars))
+		{
+			before = r;
+			t = t->right;
+			continue;
+		}
+
+		struct Sum s = l;
+		size_t i = 0;
+
+		// whole lines are skipped up to their plain newline, unless an overlong one is among them
+		while(s.lines < lines)
+		{
+			const char *nl = memchr(t->bytes + i, '\n', t->own.bytes - i);
+
+			if(! nl)
+				break;
+
+			const size_t end = (size_t)(nl - t->bytes) + 1;
+			const struct Sum span = _sum_of(t->bytes + i, end - i);
+
+			if(s.lines + span.lines > lines)
+				break;
+
+			s = _sum_cat(s, span);
+			i = end;
+		}
+
+		while(s.lines < lines)
+		{
+			uchar_t c;
+			const size_t len = u8ndec(t->bytes + i, t->own.bytes - i, &c);
+			s = _sum_cat(s, _sum_chr(len, c));
+			i += len;
+		}
+
+		// the column is past the end of the line if the piece ends or a newline is passed before it
+		const size_t index = s.chars + (chars - s.col);
+
+		if(index > r.chars)
+			return SIZE_MAX;
+
+		_seek_chr(t->bytes + i, t->own.bytes - i, &s, index);
+
+		if(s.lines != lines)
+			return SIZE_MAX;
+
+		if(out_charIndex)
+			*out_charIndex = s.chars;
+
+		return s.bytes;
+	}
+
+	return SIZE_MAX;
+}
+
+size_t u8edit_line(u8edit_t ed, unsigned line, u8size_t *out_size)
+{
+	size_t startChars, endChars;
+	const size_t start = u8edit_unLoc(ed, line, line > 1, &startChars);
+
+	if(start == SIZE_MAX)
+		return SIZE_MAX;
+
+	if(out_size)
+	{
+		const struct Sum all = _sum(ed->root);
+		size_t end;
+
+		if(line > all.lines)
+		{ // is final line
+			end = all.bytes;
+			endChars = all.chars;
+		}
+		else
+		{
+			end = u8edit_unLoc(ed, line + 1, 1, &endChars);
+			assert(end != SIZE_MAX);
+		}
+
+		*out_size = (u8size_t){ .bytesExact = true, .byteCount = end - start, .charsExact = true, .charCount = endChars - startChars };
+	}
+
+	return start;
+}
+
+size_t u8edit_read(u8edit_t ed, size_t off, char *buf, size_t n)
+{
+	const size_t size = _sum(ed->root).bytes;
+
+	if(off >= size)
+		return 0;
+	if(n > size - off)
+		n = size - off;
+
+	_copy(ed->root, off, n, buf);
+	return n;
+}
+
+u8file_t u8edit_snapshot(u8edit_t ed, const u8txt_opts *opts)
+{
+	const size_t size = _sum(ed->root).bytes;
+	char *bytes = malloc(size ? size : 1);
+
+	if(! bytes)
+		return NULL;
+
+	_copy(ed->root, 0, size, bytes);
+	u8file_t file = u8txt_load_ex(bytes, size, u8txt_cleanup_free, opts);
+
+	if(! file)
+		free(bytes);
+
+	return file;
+}
+
+//#endregion
@@ -0,0 +1,255 @@
+// u8editdist.c: Implements bit-parallel edit distances over codepoints
+#include "unic.h"
+#include "scan.h"
+#include "u8class.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Bits per block of the bit vectors */
+#define WORD 64
+/** Number of 64-bit words kept on the stack before falling back to malloc */
+#define STACK_WORDS 1024
+
+/** Maps characters of the pattern to rows of its match vectors */
+struct Peq
+{
+	/** Number of words per row */
+	size_t blocks;
+	/** Match vectors, row-major. Row 0 is all zeroes. */
+	uint64_t *rows;
+	size_t nrows;
+	/** Row of every ASCII character */
+	uint32_t ascii[0x80];
+	/** Open addressing hash table of non-ASCII characters. A key of 0 marks an empty slot. */
+	uchar_t *keys;
+	uint32_t *vals;
+	/** Size of `keys` minus one */
+	size_t mask;
+};
+
+static inline size_t _hash(uchar_t c, size_t mask)
+{
+	return ((uint32_t)c * 0x9E3779B1u) & mask;
+}
+
+/** Looks up the row of a character
+	@param create Whether to allocate a new row if there is none
+	@returns The row index, which is 0 if the character isn't in the pattern
+*/
+static uint32_t _row(struct Peq *p, uchar_t c, bool create)
+{
+	uint32_t *slot;
+
+	if(c < 0x80)
+		slot = p->ascii + c;
+	else
+	{
+		size_t h = _hash(c, p->mask);
+
+		while(p->keys[h] && p->keys[h] != c)
+			h = (h + 1) & p->mask;
+
+		if(! p->keys[h])
+		{
+			if(! create)
+				return 0;
+
+			p->keys[h] = c;
+			p->vals[h] = 0;
+		}
+
+		slot = p->vals + h;
+	}
+
+	if(!*slot && create)
+		*slot = p->nrows++;
+
+	return *slot;
+}
+
+/** Decodes a string into an array of codepoints */
+static void _decode(const char *str, u8size_t size, uchar_t *out)
+{
+	SCAN(str, size, {
+		out[charIx] = c;
+	})
+}
+
+static inline bool _same(uchar_t a, uchar_t b, bool fold)
+{
+	return a == b || (fold && uchar_alike(a, b));
+}
+
+/** State of a single block of the bit vectors */
+struct Block
+{
+	uint64_t vp, vn, d0, pm;
+};
+
+/** Runs Hyyrö's bit-parallel algorithm, split into blocks as described by Myers.
+	@param p The match vectors of the pattern, which determine the number of blocks
+	@param vec Scratch space for the state of every block
+	@param m The length of the pattern
+	@param txt The text scanned column by column
+	@returns The distance, or any value above `maxDist` if it is exceeded
+*/
+static size_t _hyyro(struct Peq *p, struct Block *vec, size_t m, const uchar_t *txt, size_t n, size_t maxDist, int flags)
+{
+	const bool fold = flags & U8DIST_FOLD, damerau = flags & U8DIST_DAMERAU;
+	const size_t blocks = p->blocks;
+	const uint64_t last = (uint64_t)1 << ((m - 1) % WORD);
+	size_t dist = m;
+
+	for(size_t b = 0; b < blocks; ++b)
+		vec[b] = (struct Block){ ~(uint64_t)0, 0, 0, 0 };
+
+	for(size_t j = 0; j < n; ++j)
+	{
+		uchar_t alt[3];
+		uint32_t rows[3];
+		const unsigned nalt = _fold_alts(txt[j], fold, alt);
+
+		for(unsigned k = 0; k < nalt; ++k)
+			rows[k] = _row(p, alt[k], false);
+
+		// horizontal deltas carried into the next block, the top row always increments
+		uint64_t hpCarry = 1, hnCarry = 0;
+		// previous column's d0 and current column's pm of the previous block
+		uint64_t d0Prev = 0, pmPrev = 0;
+
+		for(size_t b = 0; b < blocks; ++b)
+		{
+			struct Block v = vec[b];
+			uint64_t pm = 0;
+
+			for(unsigned k = 0; k < nalt; ++k)
+				pm |= p->rows[rows[k] * blocks + b];
+
+			uint64_t x = pm | hnCarry;
+			uint64_t d0 = (((x & v.vp) + v.vp) ^ v.vp) | x | v.vn;
+
+			if(damerau)
+			{ // a transposition matches the current and previous characters crosswise
+				const uint64_t tr = (((~v.d0 & pm) << 1) | ((~d0Prev & pmPrev) >> (WORD - 1))) & v.pm;
+				d0 |= tr;
+			}
+
+			uint64_t hp = v.vn | ~(d0 | v.vp);
+			uint64_t hn = d0 & v.vp;
+
+			const uint64_t hpIn = hpCarry, hnIn = hnCarry;
+
+			if(b + 1 < blocks)
+			{
+				hpCarry = hp >> (WORD - 1);
+				hnCarry = hn >> (WORD - 1);
+			}
+			else
+			{
+				dist += (hp & last) != 0;
+				dist -= (hn & last) != 0;
+			}
+
+			hp = (hp << 1) | hpIn;
+			hn = (hn << 1) | hnIn;
+
+			d0Prev = v.d0;
+			pmPrev = pm;
+			vec[b] = (struct Block){ hn | ~(d0 | hp), hp & d0, d0, pm };
+		}
+
+		// every remaining column can lower the distance by at most 1
+		if(dist > maxDist && dist - maxDist > n - j - 1)
+			return dist - (n - j - 1);
+	}
+
+	return dist;
+}
+
+size_t u8z_editdist(const char *a, u8size_t n, const char *b, u8size_t m, size_t maxDist, int flags)
+{
+	const bool fold = flags & U8DIST_FOLD;
+	const size_t cap = maxDist < SIZE_MAX ? maxDist + 1 : SIZE_MAX;
+	size_t na = u8z_strlen(a, n), nb = u8z_strlen(b, m);
+
+	if((na > nb ? na - nb : nb - na) > maxDist)
+		return cap;
+
+	// the shorter string becomes the pattern
+	if(na > nb)
+	{
+		const char *t = a; a = b; b = t;
+		const u8size_t z = n; n = m; m = z;
+		const size_t l = na; na = nb; nb = l;
+	}
+
+	// upper bounds for every allocation, the hash table has at least twice as many slots as keys
+	const size_t blocks = (na + WORD - 1) / WORD;
+	const size_t nrows = 1 + 3*na;
+	size_t slots = 16;
+
+	while(slots < 2*3*na)
+		slots *= 2;
+
+	const size_t words = (na + nb) * sizeof(uchar_t) / sizeof(uint64_t) + 1
+		+ nrows * blocks
+		+ blocks * sizeof(struct Block) / sizeof(uint64_t)
+		+ slots * (sizeof(uchar_t) + sizeof(uint32_t)) / sizeof(uint64_t) + 1;
+
+	uint64_t stack[STACK_WORDS];
+	uint64_t *mem = words <= STACK_WORDS ? stack : malloc(words * sizeof(uint64_t));
+
+	if(! mem)
+		return SIZE_MAX;
+
+	struct Peq p = {
+		.blocks = blocks,
+		.rows = mem,
+		.nrows = 1,
+		.mask = slots - 1
+	};
+	struct Block *vec = (struct Block*)(p.rows + nrows * blocks);
+	uchar_t *pat = (uchar_t*)(vec + blocks);
+	uchar_t *txt = pat + na;
+	p.keys = txt + nb;
+	p.vals = (uint32_t*)(p.keys + slots);
+
+	_decode(a, n, pat);
+	_decode(b, m, txt);
+
+	// a common prefix or suffix never changes the distance
+	while(na && _same(pat[0], txt[0], fold))
+	{
+		++pat, ++txt;
+		--na, --nb;
+	}
+	while(na && _same(pat[na - 1], txt[nb - 1], fold))
+		--na, --nb;
+
+	size_t dist = nb;
+
+	if(na)
+	{
+		p.blocks = (na + WORD - 1) / WORD;
+		memset(p.ascii, 0, sizeof(p.ascii));
+		memset(p.keys, 0, slots * sizeof(uchar_t));
+		memset(p.rows, 0, nrows * p.blocks * sizeof(uint64_t));
+
+		for(size_t i = 0; i < na; ++i)
+		{
+			uchar_t alt[3];
+			const unsigned nalt = _fold_alts(pat[i], fold, alt);
+
+			for(unsigned k = 0; k < nalt; ++k)
+				p.rows[_row(&p, alt[k], true) * p.blocks + i / WORD] |= (uint64_t)1 << (i % WORD);
+		}
+
+		dist = _hyyro(&p, vec, na, txt, nb, maxDist, flags);
+	}
+
+	if(mem != stack)
+		free(mem);
+
+	return dist < cap ? dist : cap;
+}
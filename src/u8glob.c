@@ -0,0 +1,505 @@
+// u8glob.c: Implements compiled glob patterns, matched with a bit-parallel automaton
+#include "unic.h"
+#include "scan.h"
+#include "u8class.h"
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Bits per word of a state set */
+#define WORD 64
+/** Maximum words per state set that are matched without malloc */
+#define STACK_WORDS 4
+
+/** Kinds of pattern elements */
+enum
+{
+	/** A single (possibly case-folded) character */
+	E_LIT,
+	/** `?` */
+	E_ANY,
+	/** A bracket expression */
+	E_CLASS,
+	/** `*` */
+	E_STAR,
+	/** `**`, which matches `/` in pathname mode */
+	E_GLOBSTAR
+};
+
+/** A parsed pattern element */
+struct Elem
+{
+	int kind;
+	uchar_t c;
+	bool negate;
+	/** Range of items within the item array */
+	size_t item, nitems;
+};
+
+/** A bracket expression of the compiled pattern */
+struct Class
+{
+	/** Index of the element, i.e. the state bit that the class leads into */
+	size_t elem;
+	bool negate;
+	size_t nitems;
+	struct Item *items;
+};
+
+/** A literal character of the compiled pattern */
+struct Key
+{
+	uchar_t c;
+	/** Index of its mask in `Glob.keyMasks` */
+	size_t mask;
+};
+
+struct Glob
+{
+	int flags;
+	/** Number of words per state set */
+	size_t words;
+	/** Index of the accepting state */
+	size_t accept;
+
+	/** Transition masks for every ASCII character, precomputed for every element */
+	uint64_t *ascii;
+	/** Transition mask of `?` elements */
+	uint64_t *any;
+	/** States that loop on any character but `/` */
+	uint64_t *loop;
+	/** States that loop on `/` */
+	uint64_t *loopSlash;
+	/** Transition masks of non-ASCII literals, indexed by `keys` */
+	uint64_t *keyMasks;
+
+	/** Literals and their case-folded alternatives, sorted by character. Only used for non-ASCII characters. */
+	struct Key *keys;
+	size_t nkeys;
+
+	struct Class *classes;
+	size_t nclasses;
+	struct Item *items;
+};
+
+/** Appends the items of a named class
+	@returns Whether the name is known
+*/
+static bool _named(const char *name, size_t len, struct Item *items, size_t *nitems)
+{
+	const unsigned n = _class_named(name, len, items + *nitems);
+	*nitems += n;
+	return n > 0;
+}
+
+/** Parses a bracket expression
+	@param str Points to the first character after the `[`
+	@param out_len Overwritten with the length of the expression, including the closing `]`
+	@returns 0 on success, -1 on syntax error
+*/
+static int _bracket(const char *str, struct Elem *e, struct Item *items, size_t *nitems, size_t *out_len)
+{
+	size_t i = 0;
+	e->kind = E_CLASS;
+	e->negate = str[i] == '!' || str[i] == '^';
+	e->item = *nitems;
+
+	if(e->negate)
+		++i;
+
+	for(bool first = true;; first = false)
+	{
+		if(! str[i])
+			return -1;
+		if(str[i] == ']' && !first)
+			break;
+
+		if(str[i] == '[' && str[i + 1] == ':')
+		{
+			const char *end = strstr(str + i + 2, ":]");
+
+			if(!end || !_named(str + i + 2, end - (str + i + 2), items, nitems))
+				return -1;
+
+			i = end + 2 - str;
+			continue;
+		}
+
+		uchar_t lo, hi;
+
+		if(str[i] == '\\' && str[i + 1])
+			++i;
+
+		i += u8dec(str + i, &lo);
+		hi = lo;
+
+		if(str[i] == '-' && str[i + 1] && str[i + 1] != ']')
+		{
+			++i;
+
+			if(str[i] == '\\' && str[i + 1])
+				++i;
+
+			i += u8dec(str + i, &hi);
+
+			if(hi < lo)
+				return -1;
+		}
+
+		items[(*nitems)++] = (struct Item){ .kind = I_RANGE, .lo = lo, .hi = hi };
+	}
+
+	e->nitems = *nitems - e->item;
+	*out_len = i + 1;
+	return 0;
+}
+
+/** Splits a pattern into elements
+	@param out_n Overwritten with the number of elements
+	@returns 0 on success, -1 on syntax error
+*/
+static int _parse(const char *pattern, int flags, struct Elem *elems, size_t *out_n, struct Item *items, size_t *nitems)
+{
+	size_t n = 0;
+
+	for(size_t i = 0; pattern[i];)
+	{
+		struct Elem e = { .kind = E_LIT };
+		size_t len;
+
+		switch(pattern[i])
+		{
+			case '*':
+				e.kind = (flags & U8GLOB_PATHNAME) && pattern[i + 1] == '*' ? E_GLOBSTAR : E_STAR;
+				i += e.kind == E_GLOBSTAR ? 2 : 1;
+
+				// consecutive stars are redundant
+				if(n && elems[n - 1].kind >= E_STAR)
+				{
+					if(e.kind == E_GLOBSTAR)
+						elems[n - 1].kind = E_GLOBSTAR;
+
+					continue;
+				}
+			break;
+
+			case '?':
+				e.kind = E_ANY;
+				++i;
+			break;
+
+			case '[':
+				if(_bracket(pattern + i + 1, &e, items, nitems, &len))
+					return -1;
+
+				i += 1 + len;
+			break;
+
+			case '\\':
+				if(! pattern[++i])
+					return -1;
+			// fallthrough
+			default:
+				i += u8dec(pattern + i, &e.c);
+			break;
+		}
+
+		elems[n++] = e;
+	}
+
+	*out_n = n;
+	return 0;
+}
+
+/** Matches a character against a bracket expression */
+static bool _class_match(const struct Item *items, size_t n, bool negate, uchar_t c, bool fold)
+{
+	uchar_t alt[3];
+	const unsigned nalt = _fold_alts(c, fold, alt);
+
+	for(size_t i = 0; i < n; ++i)
+	{
+		if(_item_match(items + i, c, alt, nalt))
+			return !negate;
+	}
+
+	return negate;
+}
+
+static int _key_cmp(const void *a, const void *b)
+{
+	const uchar_t x = ((const struct Key*)a)->c, y = ((const struct Key*)b)->c;
+	return (x > y) - (x < y);
+}
+
+static const struct Key *_key_find(const struct Glob *g, uchar_t c)
+{
+	const struct Key k = { .c = c };
+	return g->nkeys ? bsearch(&k, g->keys, g->nkeys, sizeof(struct Key), _key_cmp) : NULL;
+}
+
+static inline void _set(uint64_t *set, size_t bit)
+{
+	set[bit / WORD] |= (uint64_t)1 << (bit % WORD);
+}
+
+void u8glob_free(u8glob_t glob)
+{
+	if(! glob)
+		return;
+
+	free(glob->ascii);
+	free(glob->keyMasks);
+	free(glob->keys);
+	free(glob->classes);
+	free(glob->items);
+	free(glob);
+}
+
+u8glob_t u8glob_compile(const char *pattern, int flags)
+{
+	const bool fold = flags & U8GLOB_FOLD;
+	const size_t len = strlen(pattern);
+	struct Elem *elems = malloc((len + 1) * sizeof(struct Elem));
+	struct Glob *g = calloc(1, sizeof(struct Glob));
+	size_t nelems, nitems = 0;
+
+	if(!elems || !g)
+		goto fail;
+
+	// every item takes up at least a byte of the pattern, except for `alnum`
+	g->items = malloc((2*len + 1) * sizeof(struct Item));
+
+	if(! g->items)
+		goto fail;
+	if(_parse(pattern, flags, elems, &nelems, g->items, &nitems))
+	{
+		errno = EINVAL;
+		goto fail;
+	}
+
+	size_t states = 1, nclasses = 0, nkeys = 0;
+
+	for(size_t i = 0; i < nelems; ++i)
+	{
+		if(elems[i].kind < E_STAR)
+			++states;
+		if(elems[i].kind == E_CLASS)
+			++nclasses;
+		if(elems[i].kind == E_LIT)
+			nkeys += 3;
+	}
+
+	g->flags = flags;
+	g->words = (states + WORD - 1) / WORD;
+	g->accept = states - 1;
+
+	const size_t w = g->words;
+	g->ascii = calloc((0x80 + 3) * w, sizeof(uint64_t));
+	g->keyMasks = calloc(nkeys * w + 1, sizeof(uint64_t));
+	g->keys = malloc((nkeys + 1) * sizeof(struct Key));
+	g->classes = malloc((nclasses + 1) * sizeof(struct Class));
+
+	if(!g->ascii || !g->keyMasks || !g->keys || !g->classes)
+		goto fail;
+
+	g->any = g->ascii + 0x80 * w;
+	g->loop = g->any + w;
+	g->loopSlash = g->loop + w;
+
+	// literals along with the state they lead into, collected with duplicates first
+	struct Key *keys = g->keys;
+	size_t state = 0;
+
+	for(size_t i = 0; i < nelems; ++i)
+	{
+		const struct Elem *e = elems + i;
+
+		switch(e->kind)
+		{
+			case E_STAR:
+				_set(g->loop, state);
+
+				if(!(flags & U8GLOB_PATHNAME))
+					_set(g->loopSlash, state);
+			continue;
+
+			case E_GLOBSTAR:
+				_set(g->loop, state);
+				_set(g->loopSlash, state);
+			continue;
+
+			case E_ANY:
+				_set(g->any, state + 1);
+			break;
+
+			case E_CLASS:
+				g->classes[g->nclasses++] = (struct Class){
+					.elem = state + 1,
+					.negate = e->negate,
+					.nitems = e->nitems,
+					.items = g->items + e->item
+				};
+			break;
+
+			case E_LIT:
+			{
+				uchar_t alt[3];
+				const unsigned nalt = _fold_alts(e->c, fold, alt);
+
+				// ASCII alternatives are kept for non-ASCII characters they are alike to
+				for(unsigned k = 0; k < nalt; ++k)
+					keys[g->nkeys++] = (struct Key){ alt[k], state + 1 };
+			}
+			break;
+		}
+
+		++state;
+	}
+
+	// merge duplicate keys so that each has a single mask
+	qsort(keys, g->nkeys, sizeof(struct Key), _key_cmp);
+	size_t nuniq = 0;
+
+	for(size_t i = 0; i < g->nkeys; ++i)
+	{
+		const struct Key k = keys[i];
+
+		if(!nuniq || keys[nuniq - 1].c != k.c)
+		{
+			keys[nuniq] = (struct Key){ k.c, nuniq };
+			++nuniq;
+		}
+
+		_set(g->keyMasks + keys[nuniq - 1].mask * w, k.mask);
+	}
+
+	g->nkeys = nuniq;
+
+	// precompute the full transition mask of every ASCII character
+	for(uchar_t c = 0; c < 0x80; ++c)
+	{
+		uint64_t *m = g->ascii + c * w;
+		const bool slash = c == '/' && (flags & U8GLOB_PATHNAME);
+		state = 0;
+
+		for(size_t i = 0; i < nelems; ++i)
+		{
+			const struct Elem *e = elems + i;
+			bool match;
+
+			switch(e->kind)
+			{
+				case E_STAR:
+				case E_GLOBSTAR:
+				continue;
+
+				case E_LIT:
+					match = e->c == c || (fold && uchar_alike(e->c, c));
+				break;
+
+				case E_ANY:
+					match = !slash;
+				break;
+
+				default:
+					match = !slash && _class_match(g->items + e->item, e->nitems, e->negate, c, fold);
+				break;
+			}
+
+			if(match)
+				_set(m, state + 1);
+
+			++state;
+		}
+	}
+
+	free(elems);
+	return g;
+
+	fail:
+	free(elems);
+	u8glob_free(g);
+	return NULL;
+}
+
+int u8glob_match(u8glob_t glob, const char *str, u8size_t size)
+{
+	const size_t w = glob->words;
+	const bool fold = glob->flags & U8GLOB_FOLD;
+
+	// current states, next states and the mask of a non-ASCII character
+	uint64_t stack[3 * STACK_WORDS];
+	uint64_t *const mem = w <= STACK_WORDS ? stack : malloc(3 * w * sizeof(uint64_t));
+
+	if(! mem)
+		return -1;
+
+	uint64_t *cur = mem, *next = mem + w, *const dyn = mem + 2*w;
+	bool alive = true;
+
+	memset(cur, 0, w * sizeof(uint64_t));
+	cur[0] = 1;
+
+	SCAN(str, size, {
+		const uint64_t *loop = c == '/' ? glob->loopSlash : glob->loop;
+		const uint64_t *mask = dyn;
+
+		if(c < 0x80)
+			mask = glob->ascii + c * w;
+		else
+		{ // non-ASCII characters can only match `?`, classes and literals
+			memcpy(dyn, glob->any, w * sizeof(uint64_t));
+
+			uchar_t alt[3];
+			const unsigned nalt = _fold_alts(c, fold, alt);
+
+			for(unsigned k = 0; k < nalt; ++k)
+			{
+				const struct Key *key = _key_find(glob, alt[k]);
+
+				if(key)
+				{
+					for(size_t i = 0; i < w; ++i)
+						dyn[i] |= glob->keyMasks[key->mask * w + i];
+				}
+			}
+
+			for(size_t i = 0; i < glob->nclasses; ++i)
+			{
+				const struct Class *cl = glob->classes + i;
+
+				if(_class_match(cl->items, cl->nitems, cl->negate, c, fold))
+					_set(dyn, cl->elem);
+			}
+		}
+
+		uint64_t carry = 0, any = 0;
+
+		for(size_t i = 0; i < w; ++i)
+		{
+			next[i] = (((cur[i] << 1) | carry) & mask[i]) | (cur[i] & loop[i]);
+			carry = cur[i] >> (WORD - 1);
+			any |= next[i];
+		}
+
+		uint64_t *const t = cur;
+		cur = next;
+		next = t;
+
+		// no state is reachable anymore
+		if(! any)
+		{
+			alive = false;
+			break;
+		}
+	})
+
+	const int res = alive && ((cur[glob->accept / WORD] >> (glob->accept % WORD)) & 1);
+
+	if(mem != stack)
+		free(mem);
+
+	return res;
+}
@@ -0,0 +1,92 @@
+// u8grapheme.c: Implements extended grapheme cluster segmentation as per UAX #29
+#include "unic.h"
+#include "scan.h"
+#include "simd.h"
+#include "ucdb.h"
+#include <string.h>
+
+/** The grapheme break class of an ASCII character */
+static inline uint8_t _ascii_class(unsigned char b)
+{
+	return b == '\r' ? GCB_CR : b == '\n' ? GCB_LF : (b < 0x20 || b == 0x7F) ? GCB_CONTROL : GCB_OTHER;
+}
+
+/** Counts the CR LF pairs within a run of bytes */
+static size_t _crlf(const char *str, size_t n)
+{
+	size_t count = 0;
+
+	for(const char *cr; n > 1 && (cr = memchr(str, '\r', n - 1)); )
+	{
+		count += cr[1] == '\n';
+		n -= cr + 1 - str;
+		str = cr + 1;
+	}
+
+	return count;
+}
+
+u8size_t u8z_next_grapheme(const char *str, u8size_t size)
+{
+	size_t byteIx = 0, charIx = 0;
+	uint8_t state = GCB_START;
+
+	// plain ASCII is its own cluster unless it's a CR LF pair or followed by a combining character
+	if(HAS_NEXT(0, 0, size, str) && (unsigned char)str[0] < 0x80 && str[0] != '\r'
+		&& HAS_NEXT(1, 1, size, str) && (unsigned char)str[1] < 0x80)
+		return (u8size_t){ true, 1, true, 1 };
+
+	while(HAS_NEXT(byteIx, charIx, size, str))
+	{
+		uchar_t c;
+		const size_t l = u8ndec(str + byteIx, size.byteCount - byteIx, &c);
+		const uint8_t t = ucdb_gcb_dfa[state][UCDB_STAGES(gcb, c)];
+
+		if((t & UCDB_BREAK) && charIx)
+			break;
+
+		state = t & ~UCDB_BREAK;
+		byteIx += l;
+		++charIx;
+	}
+
+	return (u8size_t){ true, byteIx, true, charIx };
+}
+
+size_t u8z_grapheme_count(const char *str, u8size_t size)
+{
+	size_t byteIx = 0, charIx = 0, count = 0;
+	uint8_t state = GCB_START;
+
+	while(HAS_NEXT(byteIx, charIx, size, str))
+	{
+		size_t lim = size.byteCount - byteIx;
+
+		if(lim > size.charCount - charIx)
+			lim = size.charCount - charIx;
+
+		const size_t run = _ascii_span(str + byteIx, lim, size.bytesExact, 0, 1, 0);
+
+		if(run > 1)
+		{ // only the first byte of an ASCII run may join the previous cluster
+			const char *s = str + byteIx;
+			count += (ucdb_gcb_dfa[state][_ascii_class(s[0])] & UCDB_BREAK) != 0;
+			count += run - 1 - _crlf(s, run);
+			state = _ascii_class(s[run - 1]);
+			byteIx += run;
+			charIx += run;
+			continue;
+		}
+
+		uchar_t c;
+		const size_t l = u8ndec(str + byteIx, size.byteCount - byteIx, &c);
+		const uint8_t t = ucdb_gcb_dfa[state][UCDB_STAGES(gcb, c)];
+
+		count += (t & UCDB_BREAK) != 0;
+		state = t & ~UCDB_BREAK;
+		byteIx += l;
+		++charIx;
+	}
+
+	return count;
+}
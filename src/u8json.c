@@ -0,0 +1,347 @@
+// u8json.c: Implements escaping and unescaping of JSON string literals
+#include "unic.h"
+#include "scan.h"
+#include "simd.h"
+#include <string.h>
+
+/** Substitute for characters that can't appear in well-formed output */
+#define REPLACEMENT 0xFFFD
+
+/** Output of an escape or unescape operation, sized like `u8z_strmap()` */
+struct Out
+{
+	char *dst;
+	size_t cap, bytes, chars;
+	/** Room for a NUL terminator at the end, either 0 or 1 */
+	size_t term;
+};
+
+/** Determines the number of bytes that may be written before the terminator */
+static inline size_t _room(const struct Out *o)
+{
+	return o->cap > o->bytes + o->term ? o->cap - o->bytes - o->term : 0;
+}
+
+/** Appends bytes that encode `chars` characters
+	@returns false if they don't fit, in which case nothing is written
+*/
+static inline bool _put(struct Out *o, const char *bytes, size_t n, size_t chars)
+{
+	if(n > _room(o))
+		return false;
+
+	if(o->dst)
+		memcpy(o->dst + o->bytes, bytes, n);
+
+	o->bytes += n;
+	o->chars += chars;
+	return true;
+}
+
+/** Appends the NUL terminator, if requested, and determines the result size */
+static u8size_t _finish(struct Out *o, bool truncated)
+{
+	if(o->term)
+	{
+		if(o->cap == 0)
+			truncated = true;
+		else
+		{
+			if(o->dst)
+				o->dst[o->bytes] = 0;
+			++o->bytes;
+		}
+	}
+
+	return (u8size_t){ .bytesExact = !truncated, .byteCount = o->bytes, .charsExact = !truncated, .charCount = o->chars };
+}
+
+/** Determines if the next `k` bytes exist and are ASCII, i.e. encode `k` characters */
+static inline bool _ascii_ahead(const char *str, u8size_t size, size_t byteIx, size_t charIx, size_t k)
+{
+	for(size_t i = 0; i < k; ++i)
+	{
+		if(! HAS_NEXT(byteIx + i, charIx + i, size, str) || (unsigned char)str[byteIx + i] >= 0x80)
+			return false;
+	}
+
+	return true;
+}
+
+/** Counts the leading bytes of `str` that encode well-formed non-ASCII characters,
+	i.e. ones that re-encode to the same bytes because they are neither overlong, surrogates nor beyond UNIC_MAX.
+	Bytes are read one at a time and only after a lead byte, so a NUL byte ends the span without reading past it.
+	@param n Maximum number of bytes, a character cut off by `n` isn't part of the span
+	@param maxChars Maximum number of characters
+	@param chars Overwritten with the number of characters in the span
+	@returns The length of the span in bytes
+*/
+static size_t _multibyte_span(const char *str, size_t n, size_t maxChars, size_t *chars)
+{
+	size_t i = 0, k = 0;
+
+	for(; k < maxChars && i < n; ++k)
+	{
+		const unsigned char b = str[i];
+
+		// C0 and C1 only start overlong encodings, F5 and above only exceed UNIC_MAX
+		if(b < 0xC2 || b > 0xF4)
+			break;
+
+		const unsigned t = b >= 0xF0 ? 3 : b >= 0xE0 ? 2 : 1;
+
+		if(t >= n - i)
+			break;
+
+		uchar_t c = b & (0x3F >> t);
+		unsigned j = 1;
+
+		for(; j <= t && (str[i + j] & 0xC0) == 0x80; ++j)
+			c = c << 6 | (str[i + j] & 0x3F);
+
+		if(j <= t || (t == 2 && (c < 0x800 || c - 0xD800 < 0x800)) || (t == 3 && (c < 0x10000 || c > UNIC_MAX)))
+			break;
+
+		i += j;
+	}
+
+	*chars = k;
+	return i;
+}
+
+/** Parses 4 hex digits
+	@returns Their value, or -1 if any isn't a hex digit
+*/
+static long _hex4(const char *str)
+{
+	long v = 0;
+
+	for(int i = 0; i < 4; ++i)
+	{
+		const unsigned char c = str[i];
+		int d;
+
+		if((unsigned)(c - '0') < 10)
+			d = c - '0';
+		else if((unsigned)((c | 0x20) - 'a') < 6)
+			d = (c | 0x20) - 'a' + 10;
+		else
+			return -1;
+
+		v = v << 4 | d;
+	}
+
+	return v;
+}
+
+u8size_t u8z_json_escape(const char *str, u8size_t size, char *dst, size_t cap, bool nulTerminate)
+{
+	static const char hex[] = "0123456789ABCDEF";
+	struct Out o = { dst, cap, 0, 0, nulTerminate };
+	size_t byteIx = 0, charIx = 0;
+	bool truncated = false;
+
+	while(HAS_NEXT(byteIx, charIx, size, str))
+	{
+		// clean spans are copied as a whole
+		size_t n = size.byteCount - byteIx;
+		const size_t maxChars = size.charCount - charIx;
+
+		if(n > _room(&o))
+			n = _room(&o);
+
+		size_t run = _json_span(str + byteIx, n < maxChars ? n : maxChars, size.bytesExact), chars = run;
+
+		if(! run)
+			run = _multibyte_span(str + byteIx, n, maxChars, &chars);
+
+		if(run)
+		{
+			_put(&o, str + byteIx, run, chars);
+			byteIx += run;
+			charIx += chars;
+			continue;
+		}
+
+		uchar_t c;
+		const size_t l = u8ndec(str + byteIx, size.byteCount - byteIx, &c);
+		char next[6] = { '\\' };
+		size_t nl = 2;
+
+		switch(c)
+		{
+			case '"':
+			case '\\':
+				next[1] = c;
+				break;
+			case '\b':
+				next[1] = 'b';
+				break;
+			case '\f':
+				next[1] = 'f';
+				break;
+			case '\n':
+				next[1] = 'n';
+				break;
+			case '\r':
+				next[1] = 'r';
+				break;
+			case '\t':
+				next[1] = 't';
+				break;
+
+			default:
+				if(c < 0x20)
+				{
+					memcpy(next + 1, "u00", 3);
+					next[4] = hex[c >> 4];
+					next[5] = hex[c & 15];
+					nl = 6;
+				}
+				else
+				{ // malformed input may decode to values that aren't valid in utf-8
+					if(c - 0xD800 < 0x800 || c > 0x10FFFF)
+						c = REPLACEMENT;
+
+					nl = u8enc(c, next);
+				}
+				break;
+		}
+
+		// escape sequences are plain ASCII
+		if(! _put(&o, next, nl, c < 0x80 ? nl : 1))
+		{
+			truncated = true;
+			break;
+		}
+
+		byteIx += l;
+		++charIx;
+	}
+
+	return _finish(&o, truncated);
+}
+
+u8size_t u8z_json_unescape(const char *str, u8size_t size, char *dst, size_t cap, bool nulTerminate)
+{
+	struct Out o = { dst, cap, 0, 0, nulTerminate };
+	size_t byteIx = 0, charIx = 0;
+	bool truncated = false;
+
+	while(HAS_NEXT(byteIx, charIx, size, str))
+	{
+		// spans without escape sequences are copied as a whole
+		size_t n = size.byteCount - byteIx;
+		const size_t maxChars = size.charCount - charIx;
+
+		if(n > _room(&o))
+			n = _room(&o);
+
+		size_t run = _ascii_span(str + byteIx, n < maxChars ? n : maxChars, size.bytesExact, '\\', 1, 0), chars = run;
+
+		if(! run)
+			run = _multibyte_span(str + byteIx, n, maxChars, &chars);
+
+		if(run)
+		{
+			_put(&o, str + byteIx, run, chars);
+			byteIx += run;
+			charIx += chars;
+			continue;
+		}
+
+		uchar_t c;
+		size_t l = u8ndec(str + byteIx, size.byteCount - byteIx, &c), lc = 1;
+
+		if(c == '\\' && _ascii_ahead(str, size, byteIx + 1, charIx + 1, 1))
+		{
+			// a malformed escape sequence keeps its backslash
+			const char e = str[byteIx + 1];
+
+			switch(e)
+			{
+				case '"':
+				case '\\':
+				case '/':
+					c = e;
+					l = 2;
+					break;
+				case 'b':
+					c = '\b';
+					l = 2;
+					break;
+				case 'f':
+					c = '\f';
+					l = 2;
+					break;
+				case 'n':
+					c = '\n';
+					l = 2;
+					break;
+				case 'r':
+					c = '\r';
+					l = 2;
+					break;
+				case 't':
+					c = '\t';
+					l = 2;
+					break;
+
+				case 'u':
+				{
+					const long u = _ascii_ahead(str, size, byteIx + 2, charIx + 2, 4) ? _hex4(str + byteIx + 2) : -1;
+
+					if(u < 0)
+						break;
+
+					c = u;
+					l = 6;
+
+					// a high surrogate must be followed by an escaped low surrogate
+					if(u >= 0xD800 && u < 0xDC00 && _ascii_ahead(str, size, byteIx + 6, charIx + 6, 6)
+						&& str[byteIx + 6] == '\\' && str[byteIx + 7] == 'u')
+					{
+						const long low = _hex4(str + byteIx + 8);
+
+						if(low >= 0xDC00 && low < 0xE000)
+						{
+							c = 0x10000 + ((u - 0xD800) << 10) + (low - 0xDC00);
+							l = 12;
+						}
+					}
+
+					break;
+				}
+			}
+
+			// every byte of an escape sequence is a character
+			lc = l;
+		}
+
+		if(c - 0xD800 < 0x800 || c > 0x10FFFF)
+			c = REPLACEMENT;
+
+		char next[UTF8_MAX];
+		size_t nl;
+
+		if(!c && nulTerminate)
+		{
+			next[0] = UNUL[0];
+			next[1] = UNUL[1];
+			nl = 2;
+		}
+		else
+			nl = u8enc(c, next);
+
+		if(! _put(&o, next, nl, 1))
+		{
+			truncated = true;
+			break;
+		}
+
+		byteIx += l;
+		charIx += lc;
+	}
+
+	return _finish(&o, truncated);
+}
@@ -0,0 +1,315 @@
+// u8norm.c: Implements the normalization forms of UAX #15
+#include "unic.h"
+#include "scan.h"
+#include "simd.h"
+#include "ucdb.h"
+#include <stdlib.h>
+#include <string.h>
+
+/** Hangul syllable constants, as per section 3.12 of the Unicode standard */
+#define HANGUL_S 0xAC00
+#define HANGUL_L 0x1100
+#define HANGUL_V 0x1161
+#define HANGUL_T 0x11A7
+#define HANGUL_L_COUNT 19
+#define HANGUL_V_COUNT 21
+#define HANGUL_T_COUNT 28
+#define HANGUL_N_COUNT (HANGUL_V_COUNT * HANGUL_T_COUNT)
+#define HANGUL_S_COUNT (HANGUL_L_COUNT * HANGUL_N_COUNT)
+
+/** Number of characters a `struct Chars` holds before allocating */
+#define CHARS_LOCAL 32
+
+/** A growable array of characters */
+struct Chars
+{
+	uchar_t *at;
+	size_t count, cap;
+	uchar_t local[CHARS_LOCAL];
+};
+
+static inline uint8_t _ccc(uchar_t c)
+{
+	return UCDB_STAGES(ccc, c);
+}
+
+/** Appends a character and moves it before any preceding characters of a higher combining class, which restores canonical order
+	@returns 0 on success
+	@returns -1 and sets errno on allocation failure
+*/
+static int _push(struct Chars *chars, uchar_t c)
+{
+	if(chars->count == chars->cap)
+	{
+		const size_t cap = 2 * chars->cap;
+		uchar_t *at = chars->at == chars->local ? malloc(cap * sizeof(uchar_t)) : realloc(chars->at, cap * sizeof(uchar_t));
+
+		if(! at)
+			return -1;
+		if(chars->at == chars->local)
+			memcpy(at, chars->local, sizeof(chars->local));
+
+		chars->at = at;
+		chars->cap = cap;
+	}
+
+	size_t i = chars->count++;
+	const uint8_t cc = _ccc(c);
+
+	if(cc)
+	{
+		for(; i > 0 && _ccc(chars->at[i - 1]) > cc; --i)
+			chars->at[i] = chars->at[i - 1];
+	}
+
+	chars->at[i] = c;
+	return 0;
+}
+
+/** Appends the full decomposition of a character in canonical order */
+static int _decompose(struct Chars *chars, uchar_t c, bool compat)
+{
+	if(c - HANGUL_S < HANGUL_S_COUNT)
+	{
+		const uchar_t s = c - HANGUL_S, t = s % HANGUL_T_COUNT;
+
+		return _push(chars, HANGUL_L + s / HANGUL_N_COUNT)
+			|| _push(chars, HANGUL_V + s % HANGUL_N_COUNT / HANGUL_T_COUNT)
+			|| (t && _push(chars, HANGUL_T + t));
+	}
+
+	const struct ucdb_decomp *d = &ucdb_decomps[UCDB_STAGES(decomp, c)];
+	const size_t n = compat ? d->compatLength : d->canonicalLength;
+	const uchar_t *seq = ucdb_decomp_chars + (compat ? d->compat : d->canonical);
+
+	if(! n)
+		return _push(chars, c);
+
+	for(size_t i = 0; i < n; ++i)
+	{
+		if(_push(chars, seq[i]))
+			return -1;
+	}
+
+	return 0;
+}
+
+/** Determines the primary composite of a pair of characters
+	@returns The composite, or 0 if there is none
+*/
+static uchar_t _composite(uchar_t a, uchar_t b)
+{
+	if(a - HANGUL_L < HANGUL_L_COUNT && b - HANGUL_V < HANGUL_V_COUNT)
+		return HANGUL_S + ((a - HANGUL_L) * HANGUL_V_COUNT + b - HANGUL_V) * HANGUL_T_COUNT;
+	if(a - HANGUL_S < HANGUL_S_COUNT && (a - HANGUL_S) % HANGUL_T_COUNT == 0 && b - HANGUL_T - 1 < HANGUL_T_COUNT - 1)
+		return a + b - HANGUL_T;
+
+	size_t lo = 0, hi = UCDB_COMPOSITIONS;
+
+	while(lo < hi)
+	{
+		const size_t mid = (lo + hi) / 2;
+		const struct ucdb_composition *e = &ucdb_compositions[mid];
+
+		if(e->first < a || (e->first == a && e->second < b))
+			lo = mid + 1;
+		else if(e->first == a && e->second == b)
+			return e->composite;
+		else
+			hi = mid;
+	}
+
+	return 0;
+}
+
+/** Applies the canonical composition algorithm to characters in canonical order
+	@returns The number of remaining characters
+*/
+static size_t _compose(uchar_t *at, size_t n)
+{
+	if(! n)
+		return 0;
+
+	size_t starter = 0, out = 1;
+	// the combining class of the last character kept, or 256 if there is no starter to compose with
+	unsigned last = _ccc(at[0]) ? 256 : 0;
+
+	for(size_t i = 1; i < n; ++i)
+	{
+		const uchar_t c = at[i];
+		const uint8_t cc = _ccc(c);
+		uchar_t comp;
+
+		// a character is blocked from the starter by any character in between of the same or a higher combining class
+		if((last < cc || last == 0) && (comp = _composite(at[starter], c)))
+		{
+			at[starter] = comp;
+			continue;
+		}
+
+		if(! cc)
+			starter = out;
+
+		last = cc;
+		at[out++] = c;
+	}
+
+	return out;
+}
+
+/** Normalizes a string that starts at a boundary and ends before one, appending the result to a buffer */
+static int _chunk(const char *str, size_t n, u8buf_t *buf, enum ucdb_norm_form form, struct Chars *chars)
+{
+	chars->count = 0;
+
+	for(size_t i = 0; i < n; )
+	{
+		uchar_t c;
+		i += u8ndec(str + i, n - i, &c);
+
+		if(_decompose(chars, c, form == UCDB_NFKD || form == UCDB_NFKC))
+			return -1;
+	}
+
+	const size_t count = form == UCDB_NFC || form == UCDB_NFKC ? _compose(chars->at, chars->count) : chars->count;
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		if(u8buf_appendc(buf, chars->at[i]))
+			return -1;
+	}
+
+	return 0;
+}
+
+/** Appends a part of the input to a buffer without changes */
+static int _copy(u8buf_t *buf, const char *str, size_t bytes, size_t chars)
+{
+	if(u8buf_reserve(buf, bytes))
+		return -1;
+
+	memcpy(buf->bytes + buf->byteCount, str, bytes);
+	buf->byteCount += bytes;
+	buf->charCount += chars;
+	return 0;
+}
+
+/** Determines if a decoded character may be copied to a buffer as-is, i.e. is encoded the way the buffer would encode it */
+static inline bool _verbatim(uchar_t c, size_t l, bool nulTerminate)
+{
+	return c ? l == 1u + (c >= 0x80) + (c >= 0x800) + (c >= 0x10000) : l == 1u + nulTerminate;
+}
+
+static u8size_t _normalize(const char *str, u8size_t size, u8buf_t *buf, enum ucdb_norm_form form)
+{
+	const size_t b0 = buf->byteCount, c0 = buf->charCount;
+	struct Chars chars = { .count = 0, .cap = CHARS_LOCAL };
+	chars.at = chars.local;
+	size_t byteIx = 0, charIx = 0;
+	// the start of the input not written to the buffer yet, and the last boundary since
+	size_t doneByte = 0, doneChar = 0, safeByte = 0, safeChar = 0;
+	uint8_t lastCcc = 0;
+	bool failed = false;
+
+	while(HAS_NEXT(byteIx, charIx, size, str))
+	{
+		// plain ASCII is normalized in every form, and no boundary only if followed by a combining character
+		size_t lim = size.byteCount - byteIx;
+
+		if(lim > size.charCount - charIx)
+			lim = size.charCount - charIx;
+
+		const size_t run = _ascii_span(str + byteIx, lim, size.bytesExact, 0, 1, 0);
+
+		if(run)
+		{
+			byteIx += run;
+			charIx += run;
+			safeByte = byteIx - 1;
+			safeChar = charIx - 1;
+			lastCcc = 0;
+			continue;
+		}
+
+		uchar_t c;
+		const size_t l = u8ndec(str + byteIx, size.byteCount - byteIx, &c);
+		const uint8_t v = UCDB_STAGES(norm, c);
+		// only characters that aren't boundaries can have a nonzero combining class
+		const uint8_t cc = (v & UCDB_NORM_STICKY(form)) ? _ccc(c) : 0;
+
+		if(!(v & UCDB_NORM_STICKY(form)))
+		{
+			safeByte = byteIx;
+			safeChar = charIx;
+		}
+
+		// quick check: the character is allowed in the form, in canonical order, and encoded properly
+		if(!(v & UCDB_NORM_QC(form)) && (!cc || lastCcc <= cc) && _verbatim(c, l, buf->nulTerminate))
+		{
+			lastCcc = cc;
+			byteIx += l;
+			++charIx;
+			continue;
+		}
+
+		// the text before the last boundary is unaffected, the text after it needs normalizing up to the next boundary
+		if(_copy(buf, str + doneByte, safeByte - doneByte, safeChar - doneChar))
+		{
+			failed = true;
+			break;
+		}
+
+		byteIx += l;
+		++charIx;
+
+		while(HAS_NEXT(byteIx, charIx, size, str))
+		{
+			uchar_t d;
+			const size_t dl = u8ndec(str + byteIx, size.byteCount - byteIx, &d);
+
+			if(!(UCDB_STAGES(norm, d) & UCDB_NORM_STICKY(form)))
+				break;
+
+			byteIx += dl;
+			++charIx;
+		}
+
+		if(_chunk(str + safeByte, byteIx - safeByte, buf, form, &chars))
+		{
+			failed = true;
+			break;
+		}
+
+		doneByte = safeByte = byteIx;
+		doneChar = safeChar = charIx;
+		lastCcc = 0;
+	}
+
+	if(! failed)
+		failed = _copy(buf, str + doneByte, byteIx - doneByte, charIx - doneChar);
+
+	if(chars.at != chars.local)
+		free(chars.at);
+
+	return (u8size_t){ !failed, buf->byteCount - b0, !failed, buf->charCount - c0 };
+}
+
+u8size_t u8z_nfd(const char *str, u8size_t size, u8buf_t *buf)
+{
+	return _normalize(str, size, buf, UCDB_NFD);
+}
+
+u8size_t u8z_nfkd(const char *str, u8size_t size, u8buf_t *buf)
+{
+	return _normalize(str, size, buf, UCDB_NFKD);
+}
+
+u8size_t u8z_nfc(const char *str, u8size_t size, u8buf_t *buf)
+{
+	return _normalize(str, size, buf, UCDB_NFC);
+}
+
+u8size_t u8z_nfkc(const char *str, u8size_t size, u8buf_t *buf)
+{
+	return _normalize(str, size, buf, UCDB_NFKC);
+}
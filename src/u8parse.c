@@ -0,0 +1,141 @@
+// u8parse.c: Implements parsing of integers written in the decimal digits of any script
+#include "unic.h"
+#include "scan.h"
+#include "simd.h"
+#include <errno.h>
+#include <stdint.h>
+
+/** Computes `v * f + d`, setting `overflow` if the result doesn't fit */
+static inline uint64_t _muladd(uint64_t v, uint64_t f, uint64_t d, bool *overflow)
+{
+	uint64_t r;
+
+	if(__builtin_mul_overflow(v, f, &r) || __builtin_add_overflow(r, d, &r))
+		*overflow = true;
+
+	return r;
+}
+
+/** Parses a run of decimal digits, which must all be from the same script.
+	@param byteIx The byte index to start at. Overwritten with the index after the digits on success.
+	@param charIx The character index to start at. Overwritten with the index after the digits on success.
+	@param out Overwritten with the value on success
+	@returns 0 on success
+	@returns -1 and sets errno to EINVAL if there are no digits or they mix scripts
+	@returns -1 and sets errno to ERANGE if the value doesn't fit 64 bits
+*/
+static int _digits(const char *str, u8size_t size, size_t *byteIx, size_t *charIx, uint64_t *out)
+{
+	size_t b = *byteIx, ch = *charIx;
+	// the zero digit of the run's script, if any digit was read yet
+	uchar_t zero = 0;
+	uint64_t v = 0;
+	bool overflow = false;
+
+	while(HAS_NEXT(b, ch, size, str))
+	{
+		if(! zero || zero == '0')
+		{ // convert runs of ASCII digits 8 at a time
+			size_t lim = size.byteCount - b;
+
+			if(lim > size.charCount - ch)
+				lim = size.charCount - ch;
+
+			const size_t run = _digit_span(str + b, lim, size.bytesExact);
+
+			if(run)
+			{
+				size_t i = 0;
+
+				for(; i + 8 <= run; i += 8)
+					v = _muladd(v, 100000000, _parse8(str + b + i), &overflow);
+				for(; i < run; ++i)
+					v = _muladd(v, 10, str[b + i] - '0', &overflow);
+
+				zero = '0';
+				b += run;
+				ch += run;
+				continue;
+			}
+		}
+
+		uchar_t c;
+		const size_t l = u8ndec(str + b, size.byteCount - b, &c);
+		const int d = uchar_digit(c);
+
+		if(d < 0)
+			break;
+		if(zero && c - d != zero)
+		{
+			errno = EINVAL;
+			return -1;
+		}
+
+		zero = c - d;
+		v = _muladd(v, 10, d, &overflow);
+		b += l;
+		++ch;
+	}
+
+	if(! zero || overflow)
+	{
+		errno = zero ? ERANGE : EINVAL;
+		return -1;
+	}
+
+	*byteIx = b;
+	*charIx = ch;
+	*out = v;
+	return 0;
+}
+
+/** Reads the sign before a number
+	@param allowMinus Whether to accept negative signs
+	@returns Whether the number is negative
+*/
+static bool _sign(const char *str, u8size_t size, size_t *byteIx, size_t *charIx, bool allowMinus)
+{
+	if(! HAS_NEXT(*byteIx, *charIx, size, str))
+		return false;
+
+	uchar_t c;
+	const size_t l = u8ndec(str + *byteIx, size.byteCount - *byteIx, &c);
+	// U+2212 MINUS SIGN
+	const bool neg = allowMinus && (c == '-' || c == 0x2212);
+
+	if(c == '+' || neg)
+	{
+		*byteIx += l;
+		++*charIx;
+	}
+
+	return neg;
+}
+
+const char *u8z_parse_u64(const char *str, u8size_t size, uint64_t *out)
+{
+	size_t byteIx = 0, charIx = 0;
+	_sign(str, size, &byteIx, &charIx, false);
+
+	return _digits(str, size, &byteIx, &charIx, out) ? NULL : str + byteIx;
+}
+
+const char *u8z_parse_i64(const char *str, u8size_t size, int64_t *out)
+{
+	size_t byteIx = 0, charIx = 0;
+	const bool neg = _sign(str, size, &byteIx, &charIx, true);
+	uint64_t v;
+
+	if(_digits(str, size, &byteIx, &charIx, &v))
+		return NULL;
+
+	if(v > (uint64_t)INT64_MAX + neg)
+	{
+		errno = ERANGE;
+		return NULL;
+	}
+
+	// negate without overflowing on INT64_MIN
+	*out = neg && v ? -(int64_t)(v - 1) - 1 : (int64_t)v;
+	return str + byteIx;
+}
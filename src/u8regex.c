@@ -0,0 +1,1302 @@
+// u8regex.c: Implements regular expressions as a lazily built DFA over a Thompson NFA
+#include "unic.h"
+#include "u8text.h"
+#include "scan.h"
+#include "u8class.h"
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Maximum number of NFA states of a single automaton */
+#define MAX_STATES (1 << 20)
+/** Maximum bound of a counted repetition */
+#define MAX_REPEAT 1000
+/** Number of cached DFA states at which the cache is flushed */
+#define DFA_MAX_STATES 4096
+/** Separates groups of NFA states within a DFA state */
+#define MARK UINT32_MAX
+/** Marks unset indices */
+#define NONE UINT32_MAX
+/** Marks unset byte positions */
+#define NOPOS SIZE_MAX
+
+/** Kinds of NFA states */
+enum
+{
+	/** Consumes a single character */
+	S_CHAR,
+	/** Consumes any character, except for newline without `U8RE_DOTALL` */
+	S_ANY,
+	/** Consumes a character in a class */
+	S_CLASS,
+	/** Epsilon transition to two states */
+	S_SPLIT,
+	/** Epsilon transition to a single state */
+	S_EPS,
+	/** Accepts */
+	S_MATCH
+};
+
+/** A character class, i.e. a union of items */
+struct Class
+{
+	bool negate;
+	/** Range of items within `Regex.items` */
+	uint32_t item, nitems;
+};
+
+struct NState
+{
+	uint8_t kind;
+	/** The character of `S_CHAR`, or the class index of `S_CLASS` */
+	uchar_t c;
+	uint32_t out, out1;
+};
+
+struct Nfa
+{
+	struct NState *states;
+	uint32_t n, cap;
+	uint32_t start;
+};
+
+/** A DFA state, i.e. an ordered list of groups of NFA states.
+	Every group consists of the states of matches that started at the same position, earlier starts come first.
+*/
+struct DState
+{
+	/** Location of the NFA states within `Dfa.content`. Every group is terminated by `MARK`. */
+	size_t off, len;
+	/** Whether some group is accepting */
+	bool match;
+	/** Whether a new group is started before every character */
+	bool starting;
+	/** Cached transitions on ASCII characters, or -1 if not yet computed */
+	int32_t next[0x80];
+};
+
+/** A cached transition on a non-ASCII character */
+struct Trans
+{
+	uint64_t key;
+	int32_t to;
+};
+
+/** A lazily built DFA */
+struct Dfa
+{
+	const struct Nfa *nfa;
+
+	struct DState *states;
+	size_t n, cap;
+
+	uint32_t *content;
+	size_t clen, ccap;
+
+	/** Hash table of DFA states by content. Holds indices plus 1, or 0 for an empty slot. */
+	uint32_t *table;
+	size_t tmask;
+
+	/** Hash table of non-ASCII transitions. A `to` of -1 marks an empty slot. */
+	struct Trans *trans;
+	size_t ntrans, trmask;
+
+	/** Cached start states for anchored and unanchored searches, or -1 */
+	int32_t start[2];
+
+	/** Scratch space for computing closures */
+	uint32_t *stack, *seen, *buf;
+	uint32_t gen;
+};
+
+struct Regex
+{
+	int flags;
+	bool anchorStart, anchorEnd;
+
+	struct Item *items;
+	size_t nitems, icap;
+	struct Class *classes;
+	size_t nclasses, ccap;
+
+	/** Automaton of the pattern, and of the reversed pattern */
+	struct Nfa fwd, rev;
+	struct Dfa dfwd, drev;
+};
+
+/** A fragment of an NFA under construction */
+struct Frag
+{
+	uint32_t start;
+	/** An `S_EPS` state whose `out` is not yet patched */
+	uint32_t end;
+};
+
+struct Parser
+{
+	struct Regex *re;
+	struct Nfa *nfa;
+	const char *pat;
+	size_t i, end;
+	/** Whether to build the automaton of the reversed pattern */
+	bool rev;
+	/** Number of enclosing groups */
+	unsigned depth;
+};
+
+//#region construction
+
+static int _fail(int err)
+{
+	errno = err;
+	return -1;
+}
+
+/** Appends an NFA state
+	@returns Its index, or `NONE` and sets errno on failure
+*/
+static uint32_t _state(struct Nfa *nfa, uint8_t kind, uchar_t c, uint32_t out, uint32_t out1)
+{
+	if(nfa->n == nfa->cap)
+	{
+		if(nfa->cap >= MAX_STATES)
+		{
+			errno = ENOMEM;
+			return NONE;
+		}
+
+		const uint32_t ncap = nfa->cap ? 2*nfa->cap : 64;
+		struct NState *ns = realloc(nfa->states, ncap * sizeof(struct NState));
+
+		if(! ns)
+			return NONE;
+
+		nfa->states = ns;
+		nfa->cap = ncap;
+	}
+
+	nfa->states[nfa->n] = (struct NState){ kind, c, out, out1 };
+	return nfa->n++;
+}
+
+/** Creates a fragment that consumes a single character */
+static int _consume(struct Nfa *nfa, uint8_t kind, uchar_t c, struct Frag *out)
+{
+	const uint32_t e = _state(nfa, S_EPS, 0, NONE, NONE);
+	const uint32_t s = e == NONE ? NONE : _state(nfa, kind, c, e, NONE);
+
+	*out = (struct Frag){ s, e };
+	return s == NONE ? -1 : 0;
+}
+
+static int _empty(struct Nfa *nfa, struct Frag *out)
+{
+	const uint32_t e = _state(nfa, S_EPS, 0, NONE, NONE);
+
+	*out = (struct Frag){ e, e };
+	return e == NONE ? -1 : 0;
+}
+
+static struct Frag _cat(struct Nfa *nfa, struct Frag a, struct Frag b)
+{
+	nfa->states[a.end].out = b.start;
+	return (struct Frag){ a.start, b.end };
+}
+
+static int _alt(struct Nfa *nfa, struct Frag a, struct Frag b, struct Frag *out)
+{
+	const uint32_t e = _state(nfa, S_EPS, 0, NONE, NONE);
+	const uint32_t s = e == NONE ? NONE : _state(nfa, S_SPLIT, 0, a.start, b.start);
+
+	if(s == NONE)
+		return -1;
+
+	nfa->states[a.end].out = e;
+	nfa->states[b.end].out = e;
+	*out = (struct Frag){ s, e };
+	return 0;
+}
+
+/** Repeats a fragment
+	@param min Whether the fragment must occur at least once
+	@param max Whether the fragment may occur more than once
+*/
+static int _repeat(struct Nfa *nfa, struct Frag a, bool min, bool max, struct Frag *out)
+{
+	const uint32_t e = _state(nfa, S_EPS, 0, NONE, NONE);
+	const uint32_t s = e == NONE ? NONE : _state(nfa, S_SPLIT, 0, a.start, e);
+
+	if(s == NONE)
+		return -1;
+
+	nfa->states[a.end].out = max ? s : e;
+	*out = (struct Frag){ min ? a.start : s, e };
+	return 0;
+}
+
+/** Begins a new character class
+	@returns Its index, or `NONE` on malloc failure
+*/
+static uint32_t _class(struct Regex *re, bool negate)
+{
+	if(re->nclasses == re->ccap)
+	{
+		const size_t ncap = re->ccap ? 2*re->ccap : 16;
+		struct Class *nc = realloc(re->classes, ncap * sizeof(struct Class));
+
+		if(! nc)
+			return NONE;
+
+		re->classes = nc;
+		re->ccap = ncap;
+	}
+
+	re->classes[re->nclasses] = (struct Class){ negate, re->nitems, 0 };
+	return re->nclasses++;
+}
+
+/** Appends an item to the last class */
+static int _item(struct Regex *re, struct Item it)
+{
+	if(re->nitems == re->icap)
+	{
+		const size_t ncap = re->icap ? 2*re->icap : 32;
+		struct Item *ni = realloc(re->items, ncap * sizeof(struct Item));
+
+		if(! ni)
+			return -1;
+
+		re->items = ni;
+		re->icap = ncap;
+	}
+
+	re->items[re->nitems++] = it;
+	++re->classes[re->nclasses - 1].nitems;
+	return 0;
+}
+
+/** Appends the items of a class name
+	@returns 0 on success, -1 and sets errno if the name is unknown
+*/
+static int _named(struct Regex *re, const char *name, size_t len, bool negate)
+{
+	struct Item items[NAMED_MAX];
+	const unsigned n = _class_named(name, len, items);
+
+	if(! n)
+		return _fail(EINVAL);
+
+	for(unsigned i = 0; i < n; ++i)
+	{
+		items[i].negate = negate;
+
+		if(_item(re, items[i]))
+			return -1;
+	}
+
+	return 0;
+}
+
+static inline bool _more(const struct Parser *p)
+{
+	return p->i < p->end;
+}
+
+static inline char _peek(const struct Parser *p)
+{
+	return _more(p) ? p->pat[p->i] : 0;
+}
+
+/** Reads the next literal character of the pattern */
+static uchar_t _char(struct Parser *p)
+{
+	uchar_t c;
+	p->i += u8ndec(p->pat + p->i, p->end - p->i, &c);
+	return c;
+}
+
+static int _hexdigit(char c)
+{
+	if(c >= '0' && c <= '9')
+		return c - '0';
+	if(c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if(c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+
+	return -1;
+}
+
+/** Parses an escape sequence, after the backslash.
+	Escapes that denote a single character overwrite `out_c` and return 1.
+	Escapes that denote a class are appended as items to the last class and return 0.
+	@returns -1 and sets errno on error
+*/
+static int _escape(struct Parser *p, uchar_t *out_c)
+{
+	if(! _more(p))
+		return _fail(EINVAL);
+
+	const char e = p->pat[p->i++];
+	const bool upper = e >= 'A' && e <= 'Z';
+
+	switch(e)
+	{
+		case 'n': *out_c = '\n'; return 1;
+		case 't': *out_c = '\t'; return 1;
+		case 'r': *out_c = '\r'; return 1;
+		case 'f': *out_c = '\f'; return 1;
+		case 'v': *out_c = '\v'; return 1;
+		case 'e': *out_c = 0x1B; return 1;
+		case '0': *out_c = 0; return 1;
+
+		case 'x':
+		{
+			const bool braced = _peek(p) == '{';
+			uchar_t c = 0;
+			int digits = 0;
+
+			if(braced)
+				++p->i;
+
+			for(int d; _more(p) && (braced || digits < 2) && (d = _hexdigit(p->pat[p->i])) >= 0; ++p->i, ++digits)
+			{
+				// checked before shifting so that overlong escapes can't wrap around
+				if(c > UNIC_MAX >> 4)
+					return _fail(EINVAL);
+
+				c = 16*c + d;
+			}
+
+			if(!digits || c > UNIC_MAX || (braced && _peek(p) != '}') || (!braced && digits < 2))
+				return _fail(EINVAL);
+			if(braced)
+				++p->i;
+
+			*out_c = c;
+			return 1;
+		}
+
+		case 'd':
+		case 'D':
+			return _item(p->re, (struct Item){ .kind = I_CLASS, .negate = upper, .class = UCLASS_DECIMAL_NUMBER });
+
+		case 's':
+		case 'S':
+			return _item(p->re, (struct Item){ .kind = I_SPACE, .negate = upper });
+
+		case 'w':
+		case 'W':
+			return _item(p->re, (struct Item){ .kind = I_WORD, .negate = upper });
+
+		case 'p':
+		case 'P':
+		{
+			size_t start = p->i, len = 1;
+
+			if(_peek(p) == '{')
+			{
+				const char *close = memchr(p->pat + p->i, '}', p->end - p->i);
+
+				if(! close)
+					return _fail(EINVAL);
+
+				++start;
+				len = close - (p->pat + start);
+			}
+			else if(! _more(p))
+				return _fail(EINVAL);
+
+			p->i = start + len + (start != p->i);
+			return _named(p->re, p->pat + start, len, upper);
+		}
+
+		default:
+			// unknown escapes are reserved for future use
+			if((e >= 'a' && e <= 'z') || upper || (e >= '0' && e <= '9'))
+				return _fail(EINVAL);
+
+			--p->i;
+			*out_c = _char(p);
+			return 1;
+	}
+}
+
+/** Parses a bracket expression, after the `[` */
+static int _bracket(struct Parser *p, struct Frag *out)
+{
+	const bool negate = _peek(p) == '^';
+
+	if(negate)
+		++p->i;
+
+	const uint32_t cls = _class(p->re, negate);
+
+	if(cls == NONE)
+		return -1;
+
+	for(bool first = true;; first = false)
+	{
+		if(! _more(p))
+			return _fail(EINVAL);
+		if(_peek(p) == ']' && !first)
+			break;
+
+		if(_peek(p) == '[' && p->i + 1 < p->end && p->pat[p->i + 1] == ':')
+		{
+			const char *name = p->pat + p->i + 2;
+			const char *close = name;
+
+			while(close + 1 < p->pat + p->end && !(close[0] == ':' && close[1] == ']'))
+				++close;
+
+			if(close + 1 >= p->pat + p->end || _named(p->re, name, close - name, false))
+				return _fail(EINVAL);
+
+			p->i = close + 2 - p->pat;
+			continue;
+		}
+
+		uchar_t lo, hi;
+
+		if(_peek(p) == '\\')
+		{
+			++p->i;
+			const int r = _escape(p, &lo);
+
+			if(r < 0)
+				return -1;
+			if(r == 0)
+				continue;
+		}
+		else
+			lo = _char(p);
+
+		hi = lo;
+
+		if(_peek(p) == '-' && p->i + 1 < p->end && p->pat[p->i + 1] != ']')
+		{
+			++p->i;
+
+			if(_peek(p) == '\\')
+			{
+				++p->i;
+
+				if(_escape(p, &hi) != 1)
+					return _fail(EINVAL);
+			}
+			else
+				hi = _char(p);
+
+			if(hi < lo)
+				return _fail(EINVAL);
+		}
+
+		if(_item(p->re, (struct Item){ .kind = I_RANGE, .lo = lo, .hi = hi }))
+			return -1;
+	}
+
+	++p->i;
+	return _consume(p->nfa, S_CLASS, cls, out);
+}
+
+static int _alternation(struct Parser *p, struct Frag *out);
+
+/** Parses a single atom, i.e. a character, class or group */
+static int _atom(struct Parser *p, struct Frag *out)
+{
+	const char c = p->pat[p->i];
+
+	switch(c)
+	{
+		case '(':
+			++p->i;
+
+			if(p->i + 1 < p->end && p->pat[p->i] == '?' && p->pat[p->i + 1] == ':')
+				p->i += 2;
+
+			++p->depth;
+
+			if(_alternation(p, out))
+				return -1;
+			if(_peek(p) != ')')
+				return _fail(EINVAL);
+
+			--p->depth;
+			++p->i;
+			return 0;
+
+		case '.':
+			++p->i;
+			return _consume(p->nfa, S_ANY, 0, out);
+
+		case '[':
+			++p->i;
+			return _bracket(p, out);
+
+		case '\\':
+		{
+			++p->i;
+			// parsed into a new class that is dropped if the escape is a single character
+			const uint32_t cls = _class(p->re, false);
+			uchar_t chr;
+
+			if(cls == NONE)
+				return -1;
+
+			const int r = _escape(p, &chr);
+
+			if(r < 0)
+				return -1;
+			if(r == 1)
+			{
+				--p->re->nclasses;
+				return _consume(p->nfa, S_CHAR, chr, out);
+			}
+
+			return _consume(p->nfa, S_CLASS, cls, out);
+		}
+
+		case '*':
+		case '+':
+		case '?':
+		case '{':
+		case '^':
+		case '$':
+		case ')':
+			return _fail(EINVAL);
+
+		default:
+			return _consume(p->nfa, S_CHAR, _char(p), out);
+	}
+}
+
+/** Parses a decimal number of a counted repetition */
+static int _count(struct Parser *p, size_t *out)
+{
+	size_t n = 0, digits = 0;
+
+	for(; _more(p) && p->pat[p->i] >= '0' && p->pat[p->i] <= '9'; ++p->i, ++digits)
+	{
+		n = 10*n + (p->pat[p->i] - '0');
+
+		if(n > MAX_REPEAT)
+			return _fail(EINVAL);
+	}
+
+	*out = n;
+	return digits ? 0 : _fail(EINVAL);
+}
+
+/** Parses an atom along with its quantifier.
+	Counted repetitions are built by parsing the atom repeatedly.
+*/
+static int _piece(struct Parser *p, struct Frag *out)
+{
+	const size_t at = p->i;
+
+	if(_atom(p, out))
+		return -1;
+
+	size_t min, max;
+
+	switch(_peek(p))
+	{
+		case '*': min = 0, max = SIZE_MAX; break;
+		case '+': min = 1, max = SIZE_MAX; break;
+		case '?': min = 0, max = 1; break;
+
+		case '{':
+			++p->i;
+
+			if(_count(p, &min))
+				return -1;
+
+			max = min;
+
+			if(_peek(p) == ',')
+			{
+				++p->i;
+				max = _peek(p) == '}' ? SIZE_MAX : 0;
+
+				if(max != SIZE_MAX && _count(p, &max))
+					return -1;
+			}
+
+			if(_peek(p) != '}' || max < min)
+				return _fail(EINVAL);
+
+			break;
+
+		default:
+			return 0;
+	}
+
+	++p->i;
+	const size_t after = p->i;
+	const char q = _peek(p);
+
+	// lazy and possessive quantifiers are meaningless for leftmost-longest matching
+	if(q == '*' || q == '+' || q == '?' || q == '{')
+		return _fail(EINVAL);
+
+	struct Frag res, f = *out;
+
+	if(_empty(p->nfa, &res))
+		return -1;
+
+	const size_t copies = (max == SIZE_MAX ? min + 1 : max);
+
+	for(size_t k = 0; k < copies; ++k)
+	{
+		if(k)
+		{
+			p->i = at;
+
+			if(_atom(p, &f))
+				return -1;
+		}
+
+		if(k >= min && _repeat(p->nfa, f, false, max == SIZE_MAX, &f))
+			return -1;
+
+		res = _cat(p->nfa, res, f);
+	}
+
+	p->i = after;
+	*out = res;
+	return 0;
+}
+
+/** Parses a sequence of pieces */
+static int _concat(struct Parser *p, struct Frag *out)
+{
+	if(_empty(p->nfa, out))
+		return -1;
+
+	while(_more(p) && _peek(p) != '|' && _peek(p) != ')')
+	{
+		struct Frag f;
+
+		if(_piece(p, &f))
+			return -1;
+
+		*out = p->rev ? _cat(p->nfa, f, *out) : _cat(p->nfa, *out, f);
+	}
+
+	return 0;
+}
+
+static int _alternation(struct Parser *p, struct Frag *out)
+{
+	if(_concat(p, out))
+		return -1;
+
+	while(_peek(p) == '|')
+	{
+		// anchors apply to the entire pattern, which would be ambiguous
+		if(!p->depth && (p->re->anchorStart || p->re->anchorEnd))
+			return _fail(EINVAL);
+
+		++p->i;
+		struct Frag f;
+
+		if(_concat(p, &f) || _alt(p->nfa, *out, f, out))
+			return -1;
+	}
+
+	return 0;
+}
+
+/** Builds the automaton of a pattern */
+static int _build(struct Regex *re, struct Nfa *nfa, const char *pattern, size_t start, size_t end, bool rev)
+{
+	struct Parser p = { re, nfa, pattern, start, end, rev, 0 };
+	struct Frag f;
+
+	if(_alternation(&p, &f))
+		return -1;
+	// unbalanced parenthesis
+	if(_more(&p))
+		return _fail(EINVAL);
+
+	const uint32_t m = _state(nfa, S_MATCH, 0, NONE, NONE);
+
+	if(m == NONE)
+		return -1;
+
+	nfa->states[f.end].out = m;
+	nfa->start = f.start;
+	return 0;
+}
+
+static int _dfa_init(struct Dfa *d, const struct Nfa *nfa)
+{
+	*d = (struct Dfa){
+		.nfa = nfa,
+		.start = { -1, -1 },
+		.stack = malloc(nfa->n * sizeof(uint32_t)),
+		.seen = calloc(nfa->n, sizeof(uint32_t)),
+		// every NFA state occurs at most once, and every group has at least one state
+		.buf = malloc(2 * nfa->n * sizeof(uint32_t)),
+	};
+
+	return d->stack && d->seen && d->buf ? 0 : -1;
+}
+
+static void _dfa_free(struct Dfa *d)
+{
+	free(d->states);
+	free(d->content);
+	free(d->table);
+	free(d->trans);
+	free(d->stack);
+	free(d->seen);
+	free(d->buf);
+}
+
+void u8regex_free(u8regex_t re)
+{
+	if(! re)
+		return;
+
+	_dfa_free(&re->dfwd);
+	_dfa_free(&re->drev);
+	free(re->fwd.states);
+	free(re->rev.states);
+	free(re->items);
+	free(re->classes);
+	free(re);
+}
+
+u8regex_t u8regex_compile(const char *pattern, int flags)
+{
+	struct Regex *re = calloc(1, sizeof(struct Regex));
+
+	if(! re)
+		return NULL;
+
+	re->flags = flags;
+	size_t start = 0, end = strlen(pattern);
+
+	if(pattern[0] == '^')
+	{
+		re->anchorStart = true;
+		++start;
+	}
+
+	if(end > start && pattern[end - 1] == '$')
+	{
+		size_t esc = 0;
+
+		while(end - 1 - esc > start && pattern[end - 2 - esc] == '\\')
+			++esc;
+
+		if(esc % 2 == 0)
+		{
+			re->anchorEnd = true;
+			--end;
+		}
+	}
+
+	if(_build(re, &re->fwd, pattern, start, end, false)
+		|| _build(re, &re->rev, pattern, start, end, true)
+		|| _dfa_init(&re->dfwd, &re->fwd)
+		|| _dfa_init(&re->drev, &re->rev))
+	{
+		u8regex_free(re);
+		return NULL;
+	}
+
+	return re;
+}
+
+//#endregion construction
+
+//#region DFA
+
+static bool _class_match(const struct Regex *re, const struct Class *cl, uchar_t c)
+{
+	uchar_t alt[3];
+	const unsigned nalt = _fold_alts(c, re->flags & U8RE_ICASE, alt);
+
+	for(uint32_t i = 0; i < cl->nitems; ++i)
+	{
+		if(_item_match(re->items + cl->item + i, c, alt, nalt))
+			return !cl->negate;
+	}
+
+	return cl->negate;
+}
+
+/** Determines whether a consuming NFA state consumes a character */
+static bool _consumes(const struct Regex *re, const struct NState *s, uchar_t c)
+{
+	switch(s->kind)
+	{
+		case S_CHAR:
+			return s->c == c || ((re->flags & U8RE_ICASE) && uchar_alike(s->c, c));
+
+		case S_ANY:
+			return c != '\n' || (re->flags & U8RE_DOTALL);
+
+		case S_CLASS:
+			return _class_match(re, re->classes + s->c, c);
+
+		default:
+			return false;
+	}
+}
+
+/** Appends the consuming states reachable from an NFA state to `d->buf`, skipping states seen before */
+static void _closure(struct Dfa *d, uint32_t from, size_t *len)
+{
+	size_t top = 0;
+	d->stack[top++] = from;
+
+	while(top)
+	{
+		const uint32_t s = d->stack[--top];
+
+		if(s == NONE || d->seen[s] == d->gen)
+			continue;
+
+		d->seen[s] = d->gen;
+		const struct NState *ns = d->nfa->states + s;
+
+		switch(ns->kind)
+		{
+			case S_SPLIT:
+				d->stack[top++] = ns->out1;
+			// fallthrough
+			case S_EPS:
+				d->stack[top++] = ns->out;
+			break;
+
+			default:
+				d->buf[(*len)++] = s;
+			break;
+		}
+	}
+}
+
+/** Starts a new generation of seen states */
+static void _generation(struct Dfa *d)
+{
+	if(++d->gen == 0)
+	{
+		memset(d->seen, 0, d->nfa->n * sizeof(uint32_t));
+		d->gen = 1;
+	}
+}
+
+static uint64_t _hash_content(const uint32_t *content, size_t len, bool starting)
+{
+	uint64_t h = 0xCBF29CE484222325u ^ starting;
+
+	for(size_t i = 0; i < len; ++i)
+		h = (h ^ content[i]) * 0x100000001B3u;
+
+	return h;
+}
+
+/** Drops every cached DFA state */
+static void _dfa_reset(struct Dfa *d)
+{
+	d->n = 0;
+	d->clen = 0;
+	d->ntrans = 0;
+	d->start[0] = d->start[1] = -1;
+
+	if(d->table)
+		memset(d->table, 0, (d->tmask + 1) * sizeof(uint32_t));
+	if(d->trans)
+	{
+		for(size_t i = 0; i <= d->trmask; ++i)
+			d->trans[i].to = -1;
+	}
+}
+
+/** Grows the content hash table to accommodate another state */
+static int _dfa_grow_table(struct Dfa *d)
+{
+	if(d->table && 2 * (d->n + 1) <= d->tmask + 1)
+		return 0;
+
+	const size_t size = d->table ? 2 * (d->tmask + 1) : 64;
+	uint32_t *table = calloc(size, sizeof(uint32_t));
+
+	if(! table)
+		return -1;
+
+	for(size_t i = 0; i < d->n; ++i)
+	{
+		const struct DState *s = d->states + i;
+		size_t h = _hash_content(d->content + s->off, s->len, s->starting) & (size - 1);
+
+		while(table[h])
+			h = (h + 1) & (size - 1);
+
+		table[h] = i + 1;
+	}
+
+	free(d->table);
+	d->table = table;
+	d->tmask = size - 1;
+	return 0;
+}
+
+/** Looks up or adds the DFA state with the content of `d->buf`
+	@returns Its index, or -1 on malloc failure
+*/
+static int32_t _intern(struct Dfa *d, size_t len, bool starting)
+{
+	// only keep the groups up to the first accepting one, since later groups started later
+	bool match = false;
+
+	for(size_t i = 0; i < len && !match; ++i)
+	{
+		if(d->buf[i] == MARK)
+			continue;
+		if(d->nfa->states[d->buf[i]].kind == S_MATCH)
+		{
+			match = true;
+
+			while(d->buf[i] != MARK)
+				++i;
+
+			len = i + 1;
+		}
+	}
+
+	starting = starting && !match;
+
+	if(d->n >= DFA_MAX_STATES)
+		_dfa_reset(d);
+	if(_dfa_grow_table(d))
+		return -1;
+
+	const uint64_t hash = _hash_content(d->buf, len, starting);
+	size_t h = hash & d->tmask;
+
+	for(; d->table[h]; h = (h + 1) & d->tmask)
+	{
+		const struct DState *s = d->states + d->table[h] - 1;
+
+		if(s->len == len && s->starting == starting && memcmp(d->content + s->off, d->buf, len * sizeof(uint32_t)) == 0)
+			return d->table[h] - 1;
+	}
+
+	if(d->n == d->cap)
+	{
+		const size_t ncap = d->cap ? 2*d->cap : 16;
+		struct DState *ns = realloc(d->states, ncap * sizeof(struct DState));
+
+		if(! ns)
+			return -1;
+
+		d->states = ns;
+		d->cap = ncap;
+	}
+
+	if(d->clen + len > d->ccap)
+	{
+		size_t ncap = d->ccap ? 2*d->ccap : 256;
+
+		while(ncap < d->clen + len)
+			ncap *= 2;
+
+		uint32_t *nc = realloc(d->content, ncap * sizeof(uint32_t));
+
+		if(! nc)
+			return -1;
+
+		d->content = nc;
+		d->ccap = ncap;
+	}
+
+	struct DState *s = d->states + d->n;
+	*s = (struct DState){ .off = d->clen, .len = len, .match = match, .starting = starting };
+	memset(s->next, -1, sizeof(s->next));
+	memcpy(d->content + d->clen, d->buf, len * sizeof(uint32_t));
+	d->clen += len;
+	d->table[h] = d->n + 1;
+
+	return d->n++;
+}
+
+/** Retrieves the start state
+	@param unanchored Whether a match may start at any position
+*/
+static int32_t _dfa_start(struct Dfa *d, bool unanchored)
+{
+	if(d->start[unanchored] >= 0)
+		return d->start[unanchored];
+
+	size_t len = 0;
+	_generation(d);
+	_closure(d, d->nfa->start, &len);
+	d->buf[len++] = MARK;
+
+	return d->start[unanchored] = _intern(d, len, unanchored);
+}
+
+static inline bool _dead(const struct Dfa *d, int32_t s)
+{
+	return d->states[s].len == 0 && !d->states[s].starting;
+}
+
+/** Computes the transition of a DFA state on a character
+	@returns The next state, or -1 on malloc failure
+*/
+static int32_t _dfa_compute(const struct Regex *re, struct Dfa *d, int32_t from, uchar_t c)
+{
+	const struct DState *s = d->states + from;
+	const bool starting = s->starting;
+	size_t len = 0;
+
+	_generation(d);
+
+	// groups stay in order, and states already reached by an earlier group are dropped
+	for(size_t i = s->off, end = s->off + s->len; i < end; ++i)
+	{
+		const size_t group = len;
+
+		for(; d->content[i] != MARK; ++i)
+		{
+			const struct NState *ns = d->nfa->states + d->content[i];
+
+			if(_consumes(re, ns, c))
+				_closure(d, ns->out, &len);
+		}
+
+		if(len > group)
+			d->buf[len++] = MARK;
+	}
+
+	if(starting)
+	{
+		const size_t group = len;
+		_closure(d, d->nfa->start, &len);
+
+		if(len > group)
+			d->buf[len++] = MARK;
+	}
+
+	return _intern(d, len, starting);
+}
+
+static inline size_t _trans_hash(uint64_t key, size_t mask)
+{
+	return (key * 0x9E3779B97F4A7C15u >> 32) & mask;
+}
+
+/** Caches a transition on a non-ASCII character */
+static void _trans_put(struct Dfa *d, uint64_t key, int32_t to)
+{
+	if(2 * (d->ntrans + 1) > (d->trans ? d->trmask + 1 : 0))
+	{
+		const size_t size = d->trans ? 2 * (d->trmask + 1) : 256;
+		struct Trans *nt = malloc(size * sizeof(struct Trans));
+
+		// the cache is merely an optimization
+		if(! nt)
+			return;
+
+		for(size_t i = 0; i < size; ++i)
+			nt[i].to = -1;
+
+		for(size_t i = 0; d->trans && i <= d->trmask; ++i)
+		{
+			if(d->trans[i].to < 0)
+				continue;
+
+			size_t h = _trans_hash(d->trans[i].key, size - 1);
+
+			while(nt[h].to >= 0)
+				h = (h + 1) & (size - 1);
+
+			nt[h] = d->trans[i];
+		}
+
+		free(d->trans);
+		d->trans = nt;
+		d->trmask = size - 1;
+	}
+
+	size_t h = _trans_hash(key, d->trmask);
+
+	while(d->trans[h].to >= 0)
+		h = (h + 1) & d->trmask;
+
+	d->trans[h] = (struct Trans){ key, to };
+	++d->ntrans;
+}
+
+/** Follows the transition of a DFA state on a character, computing it if it isn't cached
+	@returns The next state, or -1 on malloc failure
+*/
+static inline int32_t _dfa_step(const struct Regex *re, struct Dfa *d, int32_t from, uchar_t c)
+{
+	if(c < 0x80)
+	{
+		const int32_t to = d->states[from].next[c];
+
+		if(to >= 0)
+			return to;
+	}
+	else if(d->trans)
+	{
+		const uint64_t key = ((uint64_t)from << 21) | c;
+
+		for(size_t h = _trans_hash(key, d->trmask); d->trans[h].to >= 0; h = (h + 1) & d->trmask)
+		{
+			if(d->trans[h].key == key)
+				return d->trans[h].to;
+		}
+	}
+
+	const size_t n = d->n;
+	const int32_t to = _dfa_compute(re, d, from, c);
+
+	// a reset invalidates `from`
+	if(to < 0 || d->n < n)
+		return to;
+
+	if(c < 0x80)
+		d->states[from].next[c] = to;
+	else
+		_trans_put(d, ((uint64_t)from << 21) | c, to);
+
+	return to;
+}
+
+//#endregion DFA
+
+//#region matching
+
+/** Decodes the character preceding a position.
+	Agrees with the character boundaries of forward decoding.
+	@returns The length of that character
+*/
+static size_t _prev(const char *str, size_t pos, uchar_t *out_c)
+{
+	for(size_t k = 1; k <= UTF8_MAX && k <= pos; ++k)
+	{
+		if((str[pos - k] & 0xC0) == 0x80)
+			continue;
+
+		if(k > 1 && u8ndec(str + pos - k, k, out_c) == k)
+			return k;
+
+		break;
+	}
+
+	u8ndec(str + pos - 1, 1, out_c);
+	return 1;
+}
+
+/** Runs the reversed automaton backwards from a position
+	@returns The smallest position of a match ending at `end`, or `NOPOS` if there is none or on malloc failure
+*/
+static size_t _rscan(struct Regex *re, const char *str, size_t end)
+{
+	struct Dfa *d = &re->drev;
+	int32_t s = _dfa_start(d, false);
+
+	if(s < 0)
+		return NOPOS;
+
+	size_t best = d->states[s].match ? end : NOPOS;
+
+	for(size_t i = end; i > 0;)
+	{
+		uchar_t c;
+		i -= _prev(str, i, &c);
+
+		if((s = _dfa_step(re, d, s, c)) < 0)
+			return NOPOS;
+		if(_dead(d, s))
+			break;
+		if(d->states[s].match)
+			best = i;
+	}
+
+	return best;
+}
+
+bool u8regex_match(u8regex_t re, const char *str, u8size_t size)
+{
+	struct Dfa *d = &re->dfwd;
+	int32_t s = _dfa_start(d, false);
+
+	if(s < 0)
+		return false;
+
+	SCAN(str, size, {
+		if((s = _dfa_step(re, d, s, c)) < 0 || _dead(d, s))
+			return false;
+	})
+
+	return d->states[s].match;
+}
+
+const char *u8regex_search(u8regex_t re, const char *str, u8size_t size, size_t *out_len)
+{
+	size_t start, end = NOPOS;
+
+	if(re->anchorEnd)
+	{ // the match has to end at the end of the string
+		end = u8z_strsize(str, size).byteCount;
+	}
+	else
+	{ // find the end of the leftmost-longest match
+		struct Dfa *d = &re->dfwd;
+		int32_t s = _dfa_start(d, !re->anchorStart);
+
+		if(s < 0)
+			return NULL;
+		if(d->states[s].match)
+			end = 0;
+
+		SCAN(str, size, {
+			if((s = _dfa_step(re, d, s, c)) < 0)
+				return NULL;
+			if(_dead(d, s))
+				break;
+			if(d->states[s].match)
+				end = byteIx + l;
+		})
+
+		if(end == NOPOS)
+			return NULL;
+	}
+
+	if(re->anchorStart && !re->anchorEnd)
+		start = 0;
+	else
+	{ // the leftmost start is the longest match of the reversed pattern
+		start = _rscan(re, str, end);
+
+		if(start == NOPOS || (re->anchorStart && start != 0))
+			return NULL;
+	}
+
+	if(out_len)
+		*out_len = end - start;
+
+	return str + start;
+}
+
+const char *u8txt_search(u8file_t file, u8regex_t re, const char *from, size_t *out_len)
+{
+	if(! from)
+		from = file->bytes;
+	if(from < file->bytes || from > file->bytes + file->size.byteCount)
+		return NULL;
+
+	return u8regex_search(re, from, EXACT_BYTES(file->bytes + file->size.byteCount - from), out_len);
+}
+
+//#endregion matching
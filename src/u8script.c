@@ -0,0 +1,157 @@
+// u8script.c: Implements segmentation of text into runs of a single script
+#include "unic.h"
+#include "scan.h"
+#include "simd.h"
+#include "ucdb.h"
+#include <stdint.h>
+
+/** Number of words in a set of scripts */
+#define WORDS ((UNIC_SCRIPTS + 63) / 64)
+
+/** A set of scripts */
+struct Scripts
+{
+	/** Whether the set contains every script. The words are unused if set. */
+	bool any;
+	uint64_t w[WORDS];
+};
+
+/** Determines the scripts a character may belong to.
+	Characters of USCRIPT_COMMON or USCRIPT_INHERITED without explicit extensions belong to any script.
+*/
+static struct Scripts _scripts_of(uchar_t c)
+{
+	struct Scripts s = { false, { 0 } };
+	const struct ucdb_script_ext *e = ucdb_script_ext_get(c);
+
+	if(e)
+	{
+		for(unsigned i = 0; i < e->count; ++i)
+		{
+			const unsigned sc = ucdb_script_ext_list[e->offset + i];
+			s.w[sc / 64] |= (uint64_t)1 << (sc % 64);
+		}
+	}
+	else
+	{
+		const enum unic_script sc = uchar_script(c);
+
+		if(sc == USCRIPT_COMMON || sc == USCRIPT_INHERITED)
+			s.any = true;
+		else
+			s.w[sc / 64] |= (uint64_t)1 << (sc % 64);
+	}
+
+	return s;
+}
+
+/** Intersects two sets of scripts
+	@returns Whether the intersection is nonempty
+*/
+static bool _intersect(struct Scripts *a, const struct Scripts *b)
+{
+	if(b->any)
+		return true;
+	if(a->any)
+	{
+		*a = *b;
+		return true;
+	}
+
+	uint64_t nonempty = 0;
+
+	for(unsigned i = 0; i < WORDS; ++i)
+		nonempty |= a->w[i] & b->w[i];
+
+	if(nonempty)
+	{
+		for(unsigned i = 0; i < WORDS; ++i)
+			a->w[i] &= b->w[i];
+	}
+
+	return nonempty;
+}
+
+/** Determines if a set of scripts consists of a single script */
+static bool _only(const struct Scripts *s, enum unic_script sc)
+{
+	if(s->any)
+		return false;
+
+	for(unsigned i = 0; i < WORDS; ++i)
+	{
+		if(s->w[i] != (i == sc / 64 ? (uint64_t)1 << (sc % 64) : 0))
+			return false;
+	}
+
+	return true;
+}
+
+/** Picks the script reported for a run: the first of its candidates, or USCRIPT_COMMON if any would do */
+static enum unic_script _pick(const struct Scripts *s)
+{
+	if(! s->any)
+	{
+		for(unsigned i = 0; i < WORDS; ++i)
+		{
+			if(s->w[i])
+				return 64 * i + _ctz(s->w[i]);
+		}
+	}
+
+	return USCRIPT_COMMON;
+}
+
+int u8z_script_runs(const char *str, u8size_t size, script_run_f callback, void *ctx)
+{
+	size_t byteIx = 0, charIx = 0, runByte = 0, runChar = 0;
+	struct Scripts cand = { true, { 0 } };
+	// whether the candidates are exactly USCRIPT_LATIN, which every ASCII character is compatible with
+	bool latin = false;
+
+	while(HAS_NEXT(byteIx, charIx, size, str))
+	{
+		if(latin)
+		{ // skip plain ASCII without any lookups
+			size_t lim = size.byteCount - byteIx;
+
+			if(lim > size.charCount - charIx)
+				lim = size.charCount - charIx;
+
+			const size_t run = _ascii_span(str + byteIx, lim, size.bytesExact, 0, 1, 0);
+
+			byteIx += run;
+			charIx += run;
+
+			if(run)
+				continue;
+		}
+
+		uchar_t c;
+		const size_t l = u8ndec(str + byteIx, size.byteCount - byteIx, &c);
+		const struct Scripts s = _scripts_of(c);
+
+		if(! _intersect(&cand, &s))
+		{
+			const int r = callback(str + runByte, (u8size_t){ true, byteIx - runByte, true, charIx - runChar }, _pick(&cand), ctx);
+
+			if(r)
+				return r;
+
+			runByte = byteIx;
+			runChar = charIx;
+			cand = s;
+		}
+
+		if(! s.any)
+			latin = _only(&cand, USCRIPT_LATIN);
+
+		byteIx += l;
+		++charIx;
+	}
+
+	if(charIx > runChar)
+		return callback(str + runByte, (u8size_t){ true, byteIx - runByte, true, charIx - runChar }, _pick(&cand), ctx);
+
+	return 0;
+}
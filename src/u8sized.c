@@ -1,53 +1,8 @@
 #include "unic.h"
+#include "scan.h"
+#include "simd.h"
 #include <stdint.h>
-
-#define HAS_NEXT(byteIx, charIx, size, str) \
-	( (byteIx) < (size).byteCount && (charIx) < (size).charCount && ((size).bytesExact || (size).charsExact || str[byteIx]) )
-
-/** Expands to an iteration over every character in the string
-	@param str The string to iterate over
-	@param size The size of `str`
-	@param __VA_ARGS__ A statement of the loop body.
-		Received the variables `bytes` and `chars` giving the respective indices,
-		`c` giving the current character, and `l` giving that char's size
-*/
-#define SCAN(str, size, ...) \
-{ \
-	const char *const _s = (str); \
-	const u8size_t _z = (size); \
-	for(size_t byteIx = 0, charIx = 0; HAS_NEXT(byteIx, charIx, _z, _s); ++charIx) \
-	{ \
-		uchar_t c; \
-		const size_t l = u8ndec(_s + byteIx, _z.byteCount - byteIx, &c); \
-		{ __VA_ARGS__ } \
-		byteIx += l; \
-	} \
-}
-
-/** Scans over two strings simultaneously
-	Sets `c1` and `c2` to the current characters, and `l1` and `l2` to their lengths.
-	The end of strings is observable as a single char with `l* = 0`.
-	Once one such character is observed, iteration ends afterwards.
-*/
-#define BISCAN(str1, size1, str2, size2, ...) \
-{ \
-	const char *const _s1 = (str1), *const _s2 = (str2); \
-	const u8size_t _z1 = (size1), _z2 = (size2); \
-	for(size_t byteIx1 = 0, charIx1 = 0, byteIx2 = 0, charIx2 = 0;; ++charIx1, ++charIx2) \
-	{ \
-		uchar_t c1, c2; \
-		const size_t l1 = HAS_NEXT(byteIx1, charIx1, _z1, _s1) \
-			? u8ndec(_s1 + byteIx1, _z1.byteCount - byteIx1, &c1) \
-			: (c1 = 0); \
-		const size_t l2 = HAS_NEXT(byteIx2, charIx2, _z2, _s2) \
-			? u8ndec(_s2 + byteIx2, _z2.byteCount - byteIx2, &c2) \
-			: (c2 = 0); \
-		{ __VA_ARGS__ } \
-		byteIx1 += l1; \
-		byteIx2 += l2; \
-		if(l1 == 0 || l2 == 0) break; \
-	} \
-}
+#include <string.h>
 
 u8size_t u8z_min(u8size_t a, u8size_t b)
 {
@@ -300,6 +255,95 @@ bool u8z_prefixI(const char *prefix, u8size_t n, const char *full, u8size_t m)
 	return false;
 }
 
+/** Skips the longest common byte prefix of two strings that both have no character limit.
+	@returns The byte offset of a character boundary in both strings, such that all preceding characters are equal.
+*/
+static size_t _common_prefix(const char *a, u8size_t n, const char *b, u8size_t m)
+{
+	const size_t lim = n.byteCount < m.byteCount ? n.byteCount : m.byteCount;
+	size_t i = 0;
+
+	if(n.bytesExact && m.bytesExact)
+	{ // no NUL terminators to respect, compare a word at a time
+		for(; i + 8 <= lim; i += 8)
+		{
+			uint64_t x, y;
+			memcpy(&x, a + i, 8);
+			memcpy(&y, b + i, 8);
+
+			if(x != y)
+				break;
+		}
+
+		while(i < lim && a[i] == b[i])
+			++i;
+	}
+	else while(i < lim && a[i] == b[i] && a[i])
+		++i;
+
+	// back up to a character boundary. Non-continuation bytes always start a character.
+	for(size_t k = 1; k < UTF8_MAX; ++k)
+	{
+		if(k > i)
+			return 0;
+		if((a[i - k] & 0xC0) != 0x80)
+			return i - k;
+	}
+
+	// more than 3 continuation bytes can't be part of a preceding character
+	return i;
+}
+
+/** Determines if a string size has no character limit */
+static inline bool _unlimited(u8size_t z)
+{
+	return !z.charsExact && z.charCount == NUL_TERMINATED.charCount;
+}
+
+int u8z_strcmp(const char *a, u8size_t n, const char *b, u8size_t m)
+{
+	if(_unlimited(n) && _unlimited(m))
+	{
+		const size_t off = _common_prefix(a, n, b, m);
+		a += off;
+		b += off;
+		n = u8z_offset(n, off, 0);
+		m = u8z_offset(m, off, 0);
+	}
+
+	BISCAN(a, n, b, m, {
+		if(l1 == 0 || l2 == 0)
+			return (l1 > 0) - (l2 > 0);
+		if(c1 != c2)
+			return c1 < c2 ? -1 : +1;
+	})
+
+	return 0;
+}
+
+int u8z_strcmpI(const char *a, u8size_t n, const char *b, u8size_t m)
+{
+	if(_unlimited(n) && _unlimited(m))
+	{
+		const size_t off = _common_prefix(a, n, b, m);
+		a += off;
+		b += off;
+		n = u8z_offset(n, off, 0);
+		m = u8z_offset(m, off, 0);
+	}
+
+	BISCAN(a, n, b, m, {
+		if(l1 == 0 || l2 == 0)
+			return (l1 > 0) - (l2 > 0);
+		const uchar_t f1 = uchar_fold(c1), f2 = uchar_fold(c2);
+
+		if(f1 != f2)
+			return f1 < f2 ? -1 : +1;
+	})
+
+	return 0;
+}
+
 bool u8z_isnorm(const char *str, u8size_t size)
 {
 	return u8z_chknorm(str, size).bytesExact;
@@ -408,3 +452,39 @@ uint64_t u8z_hashF(const char *str, u8size_t size, uchar_t (*map_f)(uchar_t))
 
 	return acc;
 }
+
+u8size_t u8z_scan_ident(const char *str, u8size_t size)
+{
+	size_t byteIx = 0, charIx = 0;
+
+	while(HAS_NEXT(byteIx, charIx, size, str))
+	{
+		if(charIx)
+		{ // most identifiers continue in plain ASCII
+			size_t lim = size.byteCount - byteIx;
+
+			if(lim > size.charCount - charIx)
+				lim = size.charCount - charIx;
+
+			const size_t run = _word_span(str + byteIx, lim, size.bytesExact);
+
+			if(run)
+			{
+				byteIx += run;
+				charIx += run;
+				continue;
+			}
+		}
+
+		uchar_t c;
+		const size_t l = u8ndec(str + byteIx, size.byteCount - byteIx, &c);
+
+		if(charIx ? !uchar_isIdContinue(c) : !(c == '_' || uchar_isIdStart(c)))
+			break;
+
+		byteIx += l;
+		++charIx;
+	}
+
+	return (u8size_t){ true, byteIx, true, charIx };
+}
@@ -0,0 +1,222 @@
+// u8slice.c: Implements zero-copy slices and splitting iterators
+#include "unic.h"
+#include "simd.h"
+
+/** Splitting modes of a `u8split_t` */
+enum
+{
+	SPLIT_DELIM,
+	SPLIT_WS,
+	SPLIT_LINES,
+	SPLIT_WORDS,
+	SPLIT_DONE
+};
+
+u8slice_t u8slice(const char *str, u8size_t size)
+{
+	return (u8slice_t) {
+		.bytes = str,
+		.size = u8z_strsize(str, size),
+		.byteOffset = 0,
+		.charOffset = 0
+	};
+}
+
+/** Creates a slice of `s` starting `bytes` bytes and `chars` characters into it */
+static inline u8slice_t _sub(u8slice_t s, size_t bytes, size_t chars, size_t byteCount, size_t charCount)
+{
+	return (u8slice_t) {
+		.bytes = s.bytes + bytes,
+		.size = { true, byteCount, true, charCount },
+		.byteOffset = s.byteOffset + bytes,
+		.charOffset = s.charOffset + chars
+	};
+}
+
+/** Drops a prefix of `bytes` bytes and `chars` characters from a slice */
+static inline u8slice_t _drop(u8slice_t s, size_t bytes, size_t chars)
+{
+	return _sub(s, bytes, chars, s.size.byteCount - bytes, s.size.charCount - chars);
+}
+
+static inline u8split_t _split(u8slice_t s, uchar_t delim, int mode)
+{
+	return (u8split_t) {
+		.rest = s,
+		.delim = delim,
+		._mode = mode
+	};
+}
+
+u8split_t u8_split(u8slice_t s, uchar_t delim)
+{
+	return _split(s, delim, SPLIT_DELIM);
+}
+
+u8split_t u8_split_ws(u8slice_t s)
+{
+	return _split(s, 0, SPLIT_WS);
+}
+
+u8split_t u8_lines(u8slice_t s)
+{
+	return _split(s, '\n', s.size.byteCount ? SPLIT_LINES : SPLIT_DONE);
+}
+
+u8split_t u8_words(u8slice_t s)
+{
+	return _split(s, 0, SPLIT_WORDS);
+}
+
+/** Determines if a word segment is word-like, i.e. starts with a letter, number or connector like '_' */
+static bool _wordlike(u8slice_t s)
+{
+	uchar_t c;
+	u8ndec(s.bytes, s.size.byteCount, &c);
+
+	return uchar_is(c, UCLASS_LETTER) || uchar_is(c, UCLASS_NUMBER) || uchar_is(c, UCLASS_CONNECTOR_PUNCTUATION);
+}
+
+/** Finds the next occurrence of a delimiter character
+	@param out_bytes Overwritten with the byte index of the delimiter, or the size of `s` if there is none
+	@param out_chars Overwritten with the character index of the delimiter
+	@returns The encoded size of the delimiter, or 0 if there is none
+*/
+static size_t _find(u8slice_t s, uchar_t delim, size_t *out_bytes, size_t *out_chars)
+{
+	const size_t n = s.size.byteCount;
+	// only ASCII delimiters can be found by the vectorized scan
+	const unsigned char x = delim < 0x80 ? delim : 0;
+	size_t bytes = 0, chars = 0;
+
+	while(bytes < n)
+	{
+		const size_t run = _ascii_span(s.bytes + bytes, n - bytes, true, x, 1, 0);
+		bytes += run;
+		chars += run;
+
+		if(bytes == n)
+			break;
+
+		uchar_t c;
+		const size_t l = u8ndec(s.bytes + bytes, n - bytes, &c);
+
+		if(c == delim)
+		{
+			*out_bytes = bytes;
+			*out_chars = chars;
+			return l;
+		}
+
+		bytes += l;
+		++chars;
+	}
+
+	*out_bytes = bytes;
+	*out_chars = chars;
+	return 0;
+}
+
+/** Finds the next boundary between whitespace and non-whitespace
+	@param ws Whether to skip whitespace, rather than non-whitespace
+*/
+static void _skip(u8slice_t s, bool ws, size_t *out_bytes, size_t *out_chars)
+{
+	const size_t n = s.size.byteCount;
+	size_t bytes = 0, chars = 0;
+
+	while(bytes < n)
+	{
+		if(! ws)
+		{ // ASCII whitespace is '\t'...'\r' and ' '
+			const size_t run = _ascii_span(s.bytes + bytes, n - bytes, true, ' ', '\t', '\r');
+			bytes += run;
+			chars += run;
+
+			if(bytes == n)
+				break;
+		}
+
+		uchar_t c;
+		const size_t l = u8ndec(s.bytes + bytes, n - bytes, &c);
+
+		if((u_isspace(c) != 0) != ws)
+			break;
+
+		bytes += l;
+		++chars;
+	}
+
+	*out_bytes = bytes;
+	*out_chars = chars;
+}
+
+bool u8split_next(u8split_t *it, u8slice_t *out)
+{
+	size_t bytes, chars, l;
+
+	switch(it->_mode)
+	{
+		case SPLIT_DELIM:
+			l = _find(it->rest, it->delim, &bytes, &chars);
+			*out = _sub(it->rest, 0, 0, bytes, chars);
+
+			if(l)
+				it->rest = _drop(it->rest, bytes + l, chars + 1);
+			else
+				it->_mode = SPLIT_DONE;
+
+			return true;
+
+		case SPLIT_LINES:
+			l = _find(it->rest, '\n', &bytes, &chars);
+			*out = _sub(it->rest, 0, 0, bytes, chars);
+
+			// CRLF line endings, a final CR without LF is part of the line
+			if(l && bytes && it->rest.bytes[bytes - 1] == '\r')
+			{
+				--out->size.byteCount;
+				--out->size.charCount;
+			}
+
+			if(l)
+				it->rest = _drop(it->rest, bytes + l, chars + 1);
+			// a trailing line terminator doesn't start another line
+			if(!l || it->rest.size.byteCount == 0)
+				it->_mode = SPLIT_DONE;
+
+			return true;
+
+		case SPLIT_WS:
+			_skip(it->rest, true, &bytes, &chars);
+			it->rest = _drop(it->rest, bytes, chars);
+
+			if(it->rest.size.byteCount == 0)
+			{
+				it->_mode = SPLIT_DONE;
+				return false;
+			}
+
+			_skip(it->rest, false, &bytes, &chars);
+			*out = _sub(it->rest, 0, 0, bytes, chars);
+			it->rest = _drop(it->rest, bytes, chars);
+			return true;
+
+		case SPLIT_WORDS:
+			while(it->rest.size.byteCount)
+			{
+				const u8size_t w = u8z_next_word(it->rest.bytes, it->rest.size);
+				*out = _sub(it->rest, 0, 0, w.byteCount, w.charCount);
+				it->rest = _drop(it->rest, w.byteCount, w.charCount);
+
+				if(_wordlike(*out))
+					return true;
+			}
+
+			it->_mode = SPLIT_DONE;
+			return false;
+
+		default:
+			return false;
+	}
+}
@@ -0,0 +1,391 @@
+// u8sort.c: Implements an MSD radix sort for arrays of UTF-8 strings
+#include "unic.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if _POSIX_SOURCE >= 200112L
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/** Number of digits, i.e. every byte value plus the end of a string */
+#define RADIX 257
+/** Buckets below this size are finished with insertion sort */
+#define SMALL_BUCKET 24
+/** Buckets of at least this size are handed out to other threads */
+#define PARALLEL_GRAIN 4096
+/** Inputs below this size are never sorted in parallel */
+#define PARALLEL_MIN (1 << 16)
+
+/** A string being sorted, along with how much of it has been consumed */
+struct Key
+{
+	/** The original string */
+	const char *str;
+	/** Next unconsumed source byte */
+	const char *cur;
+	/** Pending bytes of the current (normalized, possibly folded) character, least significant first */
+	uint32_t pend;
+	/** Number of bytes in `pend` */
+	uint8_t npend;
+};
+
+/** A range of keys that share a common prefix */
+struct Range
+{
+	size_t lo, hi;
+};
+
+/** State shared by every thread working on a single sort */
+struct Sort
+{
+	struct Key *keys;
+	/** Scratch space for distributing keys */
+	struct Key *aux;
+	/** Scratch space for the current digit of every key */
+	uint16_t *digits;
+	int flags;
+
+	#if _POSIX_SOURCE >= 200112L
+	/** Ranges that wait to be sorted by any thread */
+	struct Range *queue;
+	size_t queued, queueCap;
+	/** Number of threads currently sorting a range */
+	unsigned active;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	#endif
+};
+
+/** Consumes the next digit of a key
+	@returns 0 at the end of the string, and `1 + b` for the next byte `b`
+*/
+static inline unsigned _digit(struct Key *k, int flags)
+{
+	if(flags & U8SORT_BYTES)
+		return *k->cur ? 1 + (unsigned char)*k->cur++ : 0;
+
+	if(! k->npend)
+	{
+		if(! *k->cur)
+			return 0;
+
+		uchar_t c;
+		char enc[UTF8_MAX];
+		k->cur += u8dec(k->cur, &c);
+
+		if(flags & U8SORT_FOLD)
+			c = uchar_fold(c);
+
+		k->npend = u8enc(c, enc);
+		k->pend = 0;
+
+		for(unsigned i = k->npend; i--;)
+			k->pend = (k->pend << 8) | (unsigned char)enc[i];
+	}
+
+	const unsigned b = k->pend & 0xFF;
+	k->pend >>= 8;
+	--k->npend;
+	return 1 + b;
+}
+
+/** Compares the unconsumed remainders of two keys */
+static int _cmp(struct Key a, struct Key b, int flags)
+{
+	for(;;)
+	{
+		const unsigned x = _digit(&a, flags), y = _digit(&b, flags);
+
+		if(x != y)
+			return x < y ? -1 : +1;
+		if(! x)
+			return 0;
+	}
+}
+
+static void _insertion_sort(struct Key *keys, size_t n, int flags)
+{
+	for(size_t i = 1; i < n; ++i)
+	{
+		const struct Key k = keys[i];
+		size_t j = i;
+
+		for(; j > 0 && _cmp(keys[j - 1], k, flags) > 0; --j)
+			keys[j] = keys[j - 1];
+
+		keys[j] = k;
+	}
+}
+
+/** Distributes a range of keys into buckets by their next digit
+	@param out_bounds Overwritten with the start index of every bucket, and the end index of the last
+*/
+static void _distribute(struct Sort *s, struct Range r, size_t out_bounds[RADIX + 1])
+{
+	size_t count[RADIX] = { 0 };
+
+	for(size_t i = r.lo; i < r.hi; ++i)
+		++count[ s->digits[i] = _digit(s->keys + i, s->flags) ];
+
+	out_bounds[0] = r.lo;
+
+	for(size_t d = 0; d < RADIX; ++d)
+		out_bounds[d + 1] = out_bounds[d] + count[d];
+
+	size_t next[RADIX];
+	memcpy(next, out_bounds, sizeof(next));
+
+	// stable scatter
+	for(size_t i = r.lo; i < r.hi; ++i)
+		s->aux[ next[s->digits[i]]++ ] = s->keys[i];
+
+	memcpy(s->keys + r.lo, s->aux + r.lo, (r.hi - r.lo) * sizeof(struct Key));
+}
+
+/** Hands a range to another thread
+	@returns 0 on success, -1 if the range must be sorted by the caller
+*/
+static int _share(struct Sort *s, struct Range r);
+
+/** Sorts a range of keys that share a common prefix of consumed digits
+	@param parallel Whether big sub-ranges may be handed to other threads
+	@returns 0 on success, -1 on malloc failure
+*/
+static int _sort_range(struct Sort *s, struct Range r, bool parallel)
+{
+	struct Range *stack = NULL;
+	size_t top = 0, cap = 0;
+
+	for(;;)
+	{
+		if(r.hi - r.lo < SMALL_BUCKET)
+			_insertion_sort(s->keys + r.lo, r.hi - r.lo, s->flags);
+		else
+		{
+			size_t bounds[RADIX + 1];
+			_distribute(s, r, bounds);
+
+			// bucket 0 contains strings that have ended, so they are all equal
+			for(size_t d = 1; d < RADIX; ++d)
+			{
+				const struct Range sub = { bounds[d], bounds[d + 1] };
+
+				if(sub.hi - sub.lo < 2)
+					continue;
+				if(parallel && sub.hi - sub.lo >= PARALLEL_GRAIN && _share(s, sub) == 0)
+					continue;
+
+				if(top == cap)
+				{
+					const size_t ncap = cap ? 2*cap : 64;
+					struct Range *nstack = realloc(stack, ncap * sizeof(struct Range));
+
+					if(! nstack)
+					{
+						free(stack);
+						return -1;
+					}
+
+					stack = nstack;
+					cap = ncap;
+				}
+
+				stack[top++] = sub;
+			}
+		}
+
+		if(! top)
+			break;
+
+		r = stack[--top];
+	}
+
+	free(stack);
+	return 0;
+}
+
+#if _POSIX_SOURCE >= 200112L
+static int _share(struct Sort *s, struct Range r)
+{
+	pthread_mutex_lock(&s->lock);
+
+	if(s->queued == s->queueCap)
+	{
+		const size_t ncap = s->queueCap ? 2*s->queueCap : 64;
+		struct Range *nqueue = realloc(s->queue, ncap * sizeof(struct Range));
+
+		if(! nqueue)
+		{
+			pthread_mutex_unlock(&s->lock);
+			return -1;
+		}
+
+		s->queue = nqueue;
+		s->queueCap = ncap;
+	}
+
+	s->queue[s->queued++] = r;
+	pthread_cond_signal(&s->cond);
+	pthread_mutex_unlock(&s->lock);
+
+	return 0;
+}
+
+/** Thread entry point. Sorts queued ranges until every thread runs out of work.
+	@returns NULL on success, or a non-NULL pointer on malloc failure
+*/
+static void *_worker(void *_s)
+{
+	struct Sort *s = _s;
+	void *res = NULL;
+
+	pthread_mutex_lock(&s->lock);
+
+	for(;;)
+	{
+		while(! s->queued && s->active)
+			pthread_cond_wait(&s->cond, &s->lock);
+
+		if(! s->queued)
+			break;
+
+		const struct Range r = s->queue[--s->queued];
+		++s->active;
+		pthread_mutex_unlock(&s->lock);
+
+		if(_sort_range(s, r, true))
+			res = s;
+
+		pthread_mutex_lock(&s->lock);
+		--s->active;
+	}
+
+	// wake up every other waiting thread so they can exit as well
+	pthread_cond_broadcast(&s->cond);
+	pthread_mutex_unlock(&s->lock);
+
+	return res;
+}
+
+/** Sorts all keys using every online processor
+	@returns 0 on success
+	@returns 1 if no threads could be started or the work couldn't be queued, and the keys should be sorted sequentially
+	@returns -1 on malloc failure
+*/
+static int _sort_parallel(struct Sort *s, size_t n)
+{
+	long nproc = sysconf(_SC_NPROCESSORS_ONLN);
+
+	if(nproc < 2)
+		return 1;
+
+	pthread_t *threads = malloc((nproc - 1) * sizeof(pthread_t));
+
+	// sorting sequentially needs no further memory
+	if(! threads)
+		return 1;
+	if(pthread_mutex_init(&s->lock, NULL))
+	{
+		free(threads);
+		return 1;
+	}
+	if(pthread_cond_init(&s->cond, NULL))
+	{
+		pthread_mutex_destroy(&s->lock);
+		free(threads);
+		return 1;
+	}
+
+	s->queue = NULL;
+	s->queued = s->queueCap = 0;
+	s->active = 0;
+
+	if(_share(s, (struct Range){ 0, n }))
+	{
+		pthread_cond_destroy(&s->cond);
+		pthread_mutex_destroy(&s->lock);
+		free(threads);
+		return 1;
+	}
+
+	int res = 0;
+	long started = 0;
+
+	while(started < nproc - 1 && pthread_create(threads + started, NULL, _worker, s) == 0)
+		++started;
+
+	// the calling thread participates as well
+	if(_worker(s))
+		res = -1;
+
+	for(long i = 0; i < started; ++i)
+	{
+		void *ret;
+		pthread_join(threads[i], &ret);
+
+		if(ret)
+			res = -1;
+	}
+
+	pthread_cond_destroy(&s->cond);
+	pthread_mutex_destroy(&s->lock);
+	free(s->queue);
+	free(threads);
+
+	return res;
+}
+#else
+static int _share(struct Sort *s, struct Range r)
+{
+	(void)s;
+	(void)r;
+	return -1;
+}
+
+static int _sort_parallel(struct Sort *s, size_t n)
+{
+	(void)s;
+	(void)n;
+	return 1;
+}
+#endif
+
+int u8_sort(const char **strings, size_t n, int flags)
+{
+	if(n < 2)
+		return 0;
+
+	struct Sort s = {
+		.keys = malloc(n * sizeof(struct Key)),
+		.aux = malloc(n * sizeof(struct Key)),
+		.digits = malloc(n * sizeof(uint16_t)),
+		.flags = flags
+	};
+
+	int res = -1;
+
+	if(!s.keys || !s.aux || !s.digits)
+		goto cleanup;
+
+	for(size_t i = 0; i < n; ++i)
+		s.keys[i] = (struct Key){ .str = strings[i], .cur = strings[i] };
+
+	res = (flags & U8SORT_PARALLEL) && n >= PARALLEL_MIN ? _sort_parallel(&s, n) : 1;
+
+	if(res > 0)
+		res = _sort_range(&s, (struct Range){ 0, n }, false);
+	if(res == 0)
+	{
+		for(size_t i = 0; i < n; ++i)
+			strings[i] = s.keys[i].str;
+	}
+
+	cleanup:
+	free(s.keys);
+	free(s.aux);
+	free(s.digits);
+
+	return res;
+}
@@ -0,0 +1,80 @@
+/* u8span.h: Character boundary and seeking helpers shared by text files and editable text */
+#pragma once
+#include "simd.h"
+#include "unic.h"
+
+/** Determines if a byte is a utf-8 continuation byte */
+static inline bool _is_cont(char c)
+{
+	return (c & 0xC0) == 0x80;
+}
+
+/** Finds the start of the character containing an offset, as seen by decoding from the start of the buffer.
+	Since a lead byte is never part of a preceding character, at most 3 bytes have to be looked back at.
+	@param bytes A buffer that starts at a character boundary
+	@returns The largest byte offset `<= off` at which a character starts
+*/
+static inline size_t _u8_start(const char *bytes, size_t size, size_t off)
+{
+	if(off >= size || ! _is_cont(bytes[off]))
+		return off;
+
+	size_t k = 1;
+
+	while(k <= off && k < UTF8_MAX && _is_cont(bytes[off - k]))
+		++k;
+
+	// every byte in reach is a continuation byte, so `off` can't be part of a sequence
+	if(k > off || k == UTF8_MAX)
+		return off;
+
+	return u8ndec(bytes + off - k, size - (off - k), NULL) > k ? off - k : off;
+}
+
+/** Moves forward through a string until it passed a number of characters, counting well-formed spans without decoding them
+	@param str A string that starts at a character boundary
+	@param n The size of `str`
+	@param index The number of characters to pass
+	@param chars, lines, tail Overwritten like with `_u8_count()`, for the bytes that were passed
+	@returns The number of bytes passed, which is `n` if `str` has fewer than `index` characters
+*/
+static inline size_t _u8_seek(const char *str, size_t n, size_t index, size_t *chars, size_t *lines, size_t *tail)
+{
+	size_t i = 0, nc = 0, nl = 0, nt = 0;
+
+	while(nc < index && i < n)
+	{
+		// every character takes at least one byte, so this never counts past `index`
+		size_t want = index - nc;
+
+		if(want > n - i)
+			want = n - i;
+
+		size_t c, l, t;
+		const size_t k = _u8_count(str + i, want, &c, &l, &t);
+		nc += c;
+		nl += l;
+		nt = l ? t : nt + t;
+		i += k;
+
+		if(k < want)
+		{ // a malformed sequence, or one cut off by `want`, is a single character
+			uchar_t u;
+			i += u8ndec(str + i, n - i, &u);
+			++nc;
+
+			if(u == '\n')
+			{
+				++nl;
+				nt = 0;
+			}
+			else
+				++nt;
+		}
+	}
+
+	*chars = nc;
+	*lines = nl;
+	*tail = nt;
+	return i;
+}
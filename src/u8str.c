@@ -0,0 +1,152 @@
+// u8str.c: Implements compact fixed-width strings with constant time indexing, as per PEP 393
+#include "unic.h"
+#include "scan.h"
+#include "simd.h"
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/** Selects the transcoder for the host's byte order */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	#define NATIVE(f) f##be
+#else
+	#define NATIVE(f) f##le
+#endif
+
+/** Determines the largest character of a string and its length, reading characters as the transcoders do */
+static uchar_t _max(const char *str, u8size_t size, size_t *length)
+{
+	uchar_t max = 0;
+	size_t byteIx = 0, charIx = 0;
+
+	while(HAS_NEXT(byteIx, charIx, size, str))
+	{
+		size_t n = size.byteCount - byteIx;
+
+		if(n > size.charCount - charIx)
+			n = size.charCount - charIx;
+
+		const size_t run = _ascii_span(str + byteIx, n, size.bytesExact, 0, 1, 0);
+
+		if(run)
+		{
+			byteIx += run;
+			charIx += run;
+
+			if(max < 0x7F)
+				max = 0x7F;
+			continue;
+		}
+
+		uchar_t c;
+		byteIx += u8ndec(str + byteIx, size.byteCount - byteIx, &c);
+		++charIx;
+
+		// surrogates and out of range values are replaced
+		if(c - 0xD800 < 0x800 || c > 0x10FFFF)
+			c = 0xFFFD;
+		if(c > max)
+			max = c;
+	}
+
+	*length = charIx;
+	return max;
+}
+
+int u8str_init(u8str_t *s, const char *str, u8size_t size)
+{
+	size_t length;
+	const uchar_t max = _max(str, size, &length);
+	const unsigned width = max <= 0xFF ? 1 : max <= 0xFFFF ? 2 : 4;
+
+	*s = (u8str_t){ NULL, 0, width, NULL };
+
+	if(! length)
+		return 0;
+
+	void *chars = malloc(length * width);
+
+	if(! chars)
+		return -1;
+
+	// every character fits, so the bulk transcoders never substitute anything but invalid input
+	switch(width)
+	{
+		case 1:
+			u8z_to_latin1(str, size, chars, length, false);
+			break;
+		case 2:
+			NATIVE(u8z_to_utf16)(str, size, chars, 2 * length, false);
+			break;
+		default:
+			NATIVE(u8z_to_utf32)(str, size, chars, 4 * length, false);
+			break;
+	}
+
+	*s = (u8str_t){ chars, length, width, chars };
+	return 0;
+}
+
+void u8str_free(u8str_t *s)
+{
+	free(s->_alloc);
+	*s = (u8str_t){ NULL, 0, 1, NULL };
+}
+
+uchar_t u8str_at(u8str_t s, size_t i)
+{
+	if(i >= s.length)
+		return UEOF;
+
+	switch(s.width)
+	{
+		case 1:
+			return ((const uint8_t*)s.chars)[i];
+		case 2:
+			return ((const uint16_t*)s.chars)[i];
+		default:
+			return ((const uint32_t*)s.chars)[i];
+	}
+}
+
+u8str_t u8str_slice(u8str_t s, size_t start, size_t end)
+{
+	if(end > s.length)
+		end = s.length;
+	if(start > end)
+		start = end;
+
+	return (u8str_t){ (const char*)s.chars + start * s.width, end - start, s.width, NULL };
+}
+
+u8size_t u8str_encode(u8str_t s, char *dst, size_t cap, bool nulTerminate)
+{
+	// an empty string has no characters to pass, but the converters still handle the terminator
+	if(! s.length)
+		return u8_from_latin1("", 0, dst, cap, nulTerminate);
+
+	switch(s.width)
+	{
+		case 1:
+			return u8_from_latin1(s.chars, s.length, dst, cap, nulTerminate);
+		case 2:
+			return NATIVE(u8_from_utf16)(s.chars, 2 * s.length, dst, cap, nulTerminate);
+		default:
+			return NATIVE(u8_from_utf32)(s.chars, 4 * s.length, dst, cap, nulTerminate);
+	}
+}
+
+u8size_t u8str_encode_into(u8str_t s, u8buf_t *buf)
+{
+	// over-encodes NULs like the buffer does, the terminator is dropped again
+	const u8size_t n = u8str_encode(s, NULL, SIZE_MAX, buf->nulTerminate);
+	const size_t bytes = n.byteCount - buf->nulTerminate;
+
+	if(u8buf_reserve(buf, n.byteCount))
+		return (u8size_t){ false, 0, false, 0 };
+
+	u8str_encode(s, buf->bytes + buf->byteCount, n.byteCount, buf->nulTerminate);
+	buf->byteCount += bytes;
+	buf->charCount += n.charCount;
+	return (u8size_t){ true, bytes, true, n.charCount };
+}
@@ -1,6 +1,7 @@
 // u8string.h: Implements string functions for utf-8 strings
 #include <stddef.h>
 #include <stdbool.h>
+#include <string.h>
 #include "../include/unic.h"
 
 size_t u8_strlen(const char *str)
@@ -122,3 +123,113 @@ uint64_t u8_hashF(const char *str, uchar_t (*map_f)(uchar_t))
 {
 	return u8z_hashF(str, NUL_TERMINATED, map_f);
 }
+
+u8size_t u8_strmap_into(const char *str, u8buf_t *buf, uchar_t (*map_f)(uchar_t))
+{
+	return u8z_strmap_into(str, NUL_TERMINATED, buf, map_f);
+}
+
+u8size_t u8_strcpy_into(const char *str, u8buf_t *buf)
+{
+	return u8z_strcpy_into(str, NUL_TERMINATED, buf);
+}
+
+int u8_strcmp(const char *a, const char *b)
+{
+	return u8z_strcmp(a, NUL_TERMINATED, b, NUL_TERMINATED);
+}
+
+int u8_strcmpI(const char *a, const char *b)
+{
+	return u8z_strcmpI(a, NUL_TERMINATED, b, NUL_TERMINATED);
+}
+
+size_t u8_editdist(const char *a, const char *b, size_t maxDist, int flags)
+{
+	return u8z_editdist(a, NUL_TERMINATED, b, NUL_TERMINATED, maxDist, flags);
+}
+
+const char *u8_strpbrk(const char *str, u8charset_t set)
+{
+	return u8z_strpbrk(str, NUL_TERMINATED, set);
+}
+
+u8size_t u8_strspn(const char *str, u8charset_t set)
+{
+	return u8z_strspn(str, NUL_TERMINATED, set);
+}
+
+u8size_t u8_strcspn(const char *str, u8charset_t set)
+{
+	return u8z_strcspn(str, NUL_TERMINATED, set);
+}
+
+u8size_t u8_scan_ident(const char *str)
+{
+	return u8z_scan_ident(str, NUL_TERMINATED);
+}
+
+const char *u8_parse_u64(const char *str, uint64_t *out)
+{
+	return u8z_parse_u64(str, NUL_TERMINATED, out);
+}
+
+const char *u8_parse_i64(const char *str, int64_t *out)
+{
+	return u8z_parse_i64(str, NUL_TERMINATED, out);
+}
+
+int u8_script_runs(const char *str, script_run_f callback, void *ctx)
+{
+	return u8z_script_runs(str, NUL_TERMINATED, callback, ctx);
+}
+
+u8size_t u8_next_grapheme(const char *str)
+{
+	return u8z_next_grapheme(str, NUL_TERMINATED);
+}
+
+size_t u8_grapheme_count(const char *str)
+{
+	return u8z_grapheme_count(str, NUL_TERMINATED);
+}
+
+u8size_t u8_next_word(const char *str)
+{
+	return u8z_next_word(str, NUL_TERMINATED);
+}
+
+u8size_t u8_nfd(const char *str, u8buf_t *buf)
+{
+	return u8z_nfd(str, NUL_TERMINATED, buf);
+}
+
+u8size_t u8_nfkd(const char *str, u8buf_t *buf)
+{
+	return u8z_nfkd(str, NUL_TERMINATED, buf);
+}
+
+u8size_t u8_nfc(const char *str, u8buf_t *buf)
+{
+	return u8z_nfc(str, NUL_TERMINATED, buf);
+}
+
+u8size_t u8_nfkc(const char *str, u8buf_t *buf)
+{
+	return u8z_nfkc(str, NUL_TERMINATED, buf);
+}
+
+size_t u8_sortkey(const char *str, enum u8collate_level level, char *out, size_t cap)
+{
+	return u8z_sortkey(str, NUL_TERMINATED, level, out, cap);
+}
+
+u8size_t u8_json_escape(const char *str, char *dst, size_t cap, bool nulTerminate)
+{
+	return u8z_json_escape(str, EXACT_BYTES(strlen(str)), dst, cap, nulTerminate);
+}
+
+u8size_t u8_json_unescape(const char *str, char *dst, size_t cap, bool nulTerminate)
+{
+	return u8z_json_unescape(str, EXACT_BYTES(strlen(str)), dst, cap, nulTerminate);
+}
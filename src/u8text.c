@@ -1,7 +1,10 @@
 #include "u8text.h"
 #include "unic.h"
+#include "simd.h"
+#include "u8span.h"
 #include <assert.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -10,11 +13,18 @@
 #include <errno.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
+#include <pthread.h>
 #endif
 
-/** Number of bytes between each marker */
+/** Default number of bytes between each marker */
 #define MARKER_FREQ 2048
 
+/** Number of lines per block of the line index, which stores line starts relative to their block */
+#define LINE_BLOCK 64
+
+/** Files are only split between threads into chunks of at least this many bytes */
+#define PARALLEL_GRAIN (1 << 20)
+
 /** Allocation grain for `FileList` dynamic array */
 #define FILE_LIST_GRAIN 16
 
@@ -246,11 +256,78 @@ static const u8loc_t initialLocation = {
 	.line = 1
 };
 
+/** Start of a line relative to the start of its block */
+struct LineStart
+{
+	uint32_t byte, chars;
+};
+
+/** Absolute start of the first line of a block */
+struct LineBlock
+{
+	size_t byte, chars;
+};
+
+/** Byte offset and character index of the start of every line */
+struct Lines
+{
+	/** Number of line starts found so far, and capacity of `starts` (a multiple of `LINE_BLOCK`) */
+	size_t count, cap;
+	/** Start of every `LINE_BLOCK`th line */
+	struct LineBlock *blocks;
+	/** Start of every line, relative to its block */
+	struct LineStart *starts;
+	/** Byte offset and character index that scanning continues at, always at a character boundary */
+	size_t pos, posChars;
+};
+
+/** Location of a character of the character index, whose character index is implicit */
+struct CharSample
+{
+	size_t byte;
+	unsigned line, column;
+};
+
+/** Location of every `stride`th character */
+struct Chars
+{
+	/** Number of characters between each sample */
+	size_t stride;
+	/** Number of samples found so far, and capacity of `samples` */
+	size_t count, cap;
+	/** Whether the entire file was scanned */
+	bool complete;
+	/** Location of character `i * stride` */
+	struct CharSample *samples;
+};
+
+/** Private data behind the `_opaque` member of a text file */
+struct Index
+{
+	/** The line index, or NULL if the file has none */
+	struct Lines *lines;
+	/** The character index, or NULL if the file has none */
+	struct Chars *chars;
+	/** Number of bytes between each marker */
+	size_t stride;
+	/** Number of markers computed so far, less than all of them only for lazily loaded files */
+	size_t built;
+	/** Whether the entire file was scanned, i.e. its size and line count are known */
+	bool complete;
+	/** Location of every `stride`th byte, starting at `stride` */
+	u8loc_t markers[];
+};
+
 //#region Helper Functions
 
+static inline struct Index *_getIndex(u8file_t file)
+{
+	return (struct Index*)&file->_opaque;
+}
+
 static inline const u8loc_t *_getMarkers(u8file_t file)
 {
-	return (u8loc_t*)&file->_opaque;
+	return _getIndex(file)->markers;
 }
 
 static inline u8loc_t _getMarker(const u8loc_t *array, size_t ix)
@@ -273,6 +350,37 @@ static inline u8loc_t _loc_incr(u8loc_t l0, uchar_t chr)
 	return l0;
 }
 
+/** Appends a location that was computed relative to a zeroed location.
+	@param base The location of the start of the relative location
+	@param rel A location whose line counts the newlines passed, and whose column is absolute only if it passed any
+	@returns The absolute location of `rel`
+*/
+static inline u8loc_t _loc_add(u8loc_t base, u8loc_t rel)
+{
+	base.characterIndex += rel.characterIndex;
+	base.charOff = rel.charOff;
+
+	if(rel.line)
+	{
+		base.line += rel.line;
+		base.column = rel.column;
+	}
+	else
+		base.column += rel.column;
+
+	return base;
+}
+
+/** Finds the first character boundary at or after an offset.
+	@see _u8_start
+	@returns The smallest byte offset `>= off` at which a character starts, or `size`
+*/
+static size_t _loc_sync(const char *bytes, size_t size, size_t off)
+{
+	const size_t start = _u8_start(bytes, size, off);
+	return start == off ? off : start + u8ndec(bytes + start, size - start, NULL);
+}
+
 /** Computes a location after moving further along the string
 	@param l0 The initial location of str[0]
 	@param n Number of bytes to consume
@@ -292,24 +400,26 @@ static u8loc_t _loc_move(u8loc_t l0, const char *str, size_t n, size_t size)
 		l0.charOff = 0;
 	}
 
-	for(size_t i = 0;;)
-	{
-		uchar_t c;
-		size_t l = u8ndec(str + i, size - i, &c);
+	// the character containing str[n] only determines the offset
+	const size_t end = _u8_start(str, size, n);
 
-		i += l;
-		u8loc_t nextLoc = _loc_incr(l0, c);
-
-		if(n < i)
-		{
-			l0.charOff = n - (i - l);
-			return l0;
+	for(size_t i = 0; i < end; )
+	{
+		// well-formed spans are counted without decoding
+		size_t chars, lines, tail;
+		i += _u8_count(str + i, end - i, &chars, &lines, &tail);
+		l0 = _loc_add(l0, (u8loc_t){ .line = lines, .column = lines ? tail + 1 : tail, .characterIndex = chars });
+
+		if(i < end)
+		{ // a malformed sequence is a single character
+			uchar_t c;
+			i += u8ndec(str + i, size - i, &c);
+			l0 = _loc_incr(l0, c);
 		}
-		else if(n == i)
-			return nextLoc;
-
-		l0 = nextLoc;
 	}
+
+	l0.charOff = n - end;
+	return l0;
 }
 //#endregion
 
@@ -325,6 +435,11 @@ void u8txt_cleanup_munmap(u8file_t file)
 }
 
 u8file_t u8txt_open(int fd)
+{
+	return u8txt_open_ex(fd, NULL);
+}
+
+u8file_t u8txt_open_ex(int fd, const u8txt_opts *opts)
 {
 	struct stat st;
 	if(fstat(fd, &st))
@@ -335,12 +450,13 @@ u8file_t u8txt_open(int fd)
 		goto fallback;
 
 	if(st.st_size == 0)
-		return u8txt_load(NULL, 0, NULL);
+		return u8txt_load_ex(NULL, 0, NULL, opts);
 
 	// attempt mmap()
 	int flags = MAP_PRIVATE;
 	#ifdef MAP_POPULATE // linux-specific; tells OS we plan to iterate the entire file immediately
-	flags |= MAP_POPULATE;
+	if(! (opts && opts->lazy)) // lazily loaded files are only read as far as they're queried
+		flags |= MAP_POPULATE;
 	#endif
 	void *const mapping = mmap(NULL, st.st_size, PROT_READ,  flags, fd, 0);
 
@@ -357,7 +473,7 @@ u8file_t u8txt_open(int fd)
 	}
 
 	{
-		u8file_t file = u8txt_load(mapping, st.st_size, u8txt_cleanup_munmap);
+		u8file_t file = u8txt_load_ex(mapping, st.st_size, u8txt_cleanup_munmap, opts);
 
 		if(! file)
 			munmap(mapping, st.st_size);
@@ -411,7 +527,7 @@ u8file_t u8txt_open(int fd)
 			if(nbuf)
 				buf = nbuf;
 
-			u8file_t file = u8txt_load(buf, size, u8txt_cleanup_free);
+			u8file_t file = u8txt_load_ex(buf, size, u8txt_cleanup_free, opts);
 
 			if(! file)
 				free(buf);
@@ -422,43 +538,524 @@ u8file_t u8txt_open(int fd)
 }
 #endif
 
-u8file_t u8txt_load(const char *bytes, size_t size, cleanup_f cleanup)
+/** Maximum number of threads used by `u8txt_load()`, 0 for every online processor */
+static unsigned threadCount = 0;
+
+unsigned u8txt_threads(unsigned n)
+{
+	const unsigned prev = threadCount;
+	threadCount = n;
+	return prev;
+}
+
+/** A contiguous range of a file whose markers are computed by a single thread */
+struct Chunk
 {
-	size_t nMark = size / MARKER_FREQ;
-	u8file_t file = malloc(sizeof(struct TextFile) + nMark * sizeof(u8loc_t));
+	const char *bytes;
+	size_t size;
+	u8loc_t *markers;
+	/** Number of bytes between each marker */
+	size_t stride;
+	/** First byte of the chunk, a multiple of `stride` */
+	size_t from;
+	/** First byte after the chunk, a multiple of `stride` or the file size */
+	size_t to;
+	/** Location of the first character that starts inside the chunk.
+		Zeroed for every chunk but the first, in which case all locations are relative until `_mark_fix()`.
+	*/
+	u8loc_t base;
+	/** Location of the first character that starts after the chunk, computed starting from `base` */
+	u8loc_t end;
+
+	#if _POSIX_SOURCE >= 200112L
+	pthread_t thread;
+	bool started;
+	#endif
+};
 
-	if(! file)
-		return NULL;
+/** Computes every marker within a chunk
+	@param _c actually `struct Chunk*`
+*/
+static void *_mark_chunk(void *_c)
+{
+	struct Chunk *c = _c;
+	// a character that crosses into this chunk is counted by the previous chunk
+	size_t o = _loc_sync(c->bytes, c->size, c->from);
+	u8loc_t cur = c->base;
+
+	for(size_t i = c->from / c->stride; (i + 1) * c->stride <= c->to; ++i)
+	{
+		const size_t p = (i + 1) * c->stride;
+		c->markers[i] = cur = _loc_move(cur, c->bytes + o, p - o, c->size - o);
+		o = p;
+	}
+
+	const size_t end = _loc_sync(c->bytes, c->size, c->to);
+	c->end = _loc_move(cur, c->bytes + o, end - o, c->size - o);
+	return NULL;
+}
+
+/** Turns the markers of a chunk computed relative to a zeroed location into absolute ones
+	@param _c actually `struct Chunk*`, with the correct `base`
+*/
+static void *_mark_fix(void *_c)
+{
+	struct Chunk *c = _c;
+
+	for(size_t i = c->from / c->stride; (i + 1) * c->stride <= c->to; ++i)
+		c->markers[i] = _loc_add(c->base, c->markers[i]);
+
+	return NULL;
+}
+
+/** Runs a function on every chunk, spreading the chunks across threads if possible */
+static void _mark_run(struct Chunk *chunks, size_t n, void *(*f)(void*))
+{
+	#if _POSIX_SOURCE >= 200112L
+	for(size_t i = 1; i < n; ++i)
+		chunks[i].started = pthread_create(&chunks[i].thread, NULL, f, chunks + i) == 0;
+
+	// the calling thread works as well, and takes over chunks that didn't get a thread
+	f(chunks);
+
+	for(size_t i = 1; i < n; ++i)
+	{
+		if(chunks[i].started)
+			pthread_join(chunks[i].thread, NULL);
+		else
+			f(chunks + i);
+	}
+	#else
+	for(size_t i = 0; i < n; ++i)
+		f(chunks + i);
+	#endif
+}
 
-	u8loc_t *m = (u8loc_t*)&file->_opaque;
-	u8loc_t cur = initialLocation;
+/** Determines how many threads should index a file of some size
+	@param n The requested number of threads, 0 for the limit set by `u8txt_threads()`
+*/
+static size_t _mark_threads(size_t size, size_t n)
+{
+	if(n == 0)
+		n = threadCount;
 
-	// create markers
-	for(size_t i = 0; i < nMark; ++i)
+	#if _POSIX_SOURCE >= 200112L
+	if(n == 0)
 	{
-		size_t o = i * MARKER_FREQ;
-		m[i] = cur = _loc_move(cur, bytes + o, MARKER_FREQ, size - o);
+		const long nproc = sysconf(_SC_NPROCESSORS_ONLN);
+		n = nproc > 1 ? nproc : 1;
 	}
+	#else
+	n = 1;
+	#endif
 
-	size_t leftover = size - nMark*MARKER_FREQ;
-	u8loc_t last = _loc_move(cur, bytes + nMark*MARKER_FREQ, leftover, leftover);
+	if(n > size / PARALLEL_GRAIN)
+		n = size / PARALLEL_GRAIN;
 
+	return n ? n : 1;
+}
+
+/** Stores the location of the end of a file, which completes its index */
+static void _mark_finish(u8file_t file, u8loc_t last)
+{
 	u8size_t siz = (u8size_t) {
 		.bytesExact = true,
-		.byteCount = size,
+		.byteCount = file->size.byteCount,
 		.charsExact = true,
 		.charCount = last.characterIndex
 	};
 
-	file->udata = NULL;
-	*(const char**)&(file->bytes) = bytes;
 	*(u8size_t*)&(file->size) = siz;
 	*(unsigned int*)&(file->lines) = last.line;
+	_getIndex(file)->complete = true;
+}
+
+/** Computes every marker of a file at once
+	@param threads The maximum number of threads to use, see `u8txt_opts`
+*/
+static void _mark_all(u8file_t file, unsigned threads)
+{
+	struct Index *index = _getIndex(file);
+	const size_t size = file->size.byteCount, stride = index->stride, nMark = size / stride;
+	size_t nChunk = _mark_threads(size, threads);
+	struct Chunk single, *chunks = nChunk > 1 ? malloc(nChunk * sizeof(struct Chunk)) : NULL;
+
+	if(! chunks)
+	{ // indexing sequentially always works
+		nChunk = 1;
+		chunks = &single;
+	}
+
+	// split the markers evenly, every chunk is computed relative to its first character
+	for(size_t i = 0; i < nChunk; ++i)
+	{
+		chunks[i] = (struct Chunk){
+			.bytes = file->bytes,
+			.size = size,
+			.markers = index->markers,
+			.stride = stride,
+			.from = (nMark * i / nChunk) * stride,
+			.to = i + 1 < nChunk ? (nMark * (i + 1) / nChunk) * stride : size,
+			.base = i ? (u8loc_t){ 0 } : initialLocation
+		};
+	}
+
+	_mark_run(chunks, nChunk, _mark_chunk);
+
+	// prefix sum over the chunks, then every chunk's markers are moved by its base
+	u8loc_t last = chunks[0].end;
+
+	for(size_t i = 1; i < nChunk; ++i)
+	{
+		chunks[i].base = last;
+		last = _loc_add(last, chunks[i].end);
+	}
+
+	if(nChunk > 1)
+	{
+		_mark_run(chunks + 1, nChunk - 1, _mark_fix);
+		free(chunks);
+	}
+
+	index->built = nMark;
+	_mark_finish(file, last);
+}
+
+/** What `_extend()` extends an index to */
+enum Need
+{
+	/** A number of markers */
+	NEED_MARKERS,
+	/** A marker after a character index */
+	NEED_CHAR,
+	/** A marker after a line */
+	NEED_LINE
+};
+
+/** Extends the index of a lazily loaded file until it covers a target, or the entire file.
+	Noop for files that were indexed completely.
+*/
+static void _extend(u8file_t file, enum Need need, size_t target)
+{
+	struct Index *index = _getIndex(file);
+
+	if(index->complete)
+		return;
+
+	const size_t size = file->size.byteCount, stride = index->stride, nMark = size / stride;
+	u8loc_t cur = _getMarker(index->markers, index->built);
+
+	for(; index->built < nMark; ++index->built)
+	{
+		if(need == NEED_MARKERS ? index->built >= target : need == NEED_CHAR ? cur.characterIndex > target : cur.line > target)
+			return;
+
+		const size_t o = index->built * stride;
+		index->markers[index->built] = cur = _loc_move(cur, file->bytes + o, stride, size - o);
+	}
+
+	const size_t o = nMark * stride;
+	_mark_finish(file, _loc_move(cur, file->bytes + o, size - o, size - o));
+}
+
+/** Records the start of the next line
+	@returns false on malloc failure, or if the line is too far from the start of its block
+*/
+static bool _lines_push(struct Lines *lines, size_t byte, size_t chars)
+{
+	if(lines->count == lines->cap)
+	{
+		const size_t cap = lines->cap ? 2 * lines->cap : LINE_BLOCK;
+		struct LineStart *starts = realloc(lines->starts, cap * sizeof(struct LineStart));
+
+		if(! starts)
+			return false;
+
+		lines->starts = starts;
+		struct LineBlock *blocks = realloc(lines->blocks, cap / LINE_BLOCK * sizeof(struct LineBlock));
+
+		if(! blocks)
+			return false;
+
+		lines->blocks = blocks;
+		lines->cap = cap;
+	}
+
+	struct LineBlock *block = lines->blocks + lines->count / LINE_BLOCK;
+
+	if(lines->count % LINE_BLOCK == 0)
+		*block = (struct LineBlock){ byte, chars };
+	else if(byte - block->byte > UINT32_MAX || chars - block->chars > UINT32_MAX)
+		return false;
+
+	lines->starts[lines->count++] = (struct LineStart){ byte - block->byte, chars - block->chars };
+	return true;
+}
+
+static void _lines_free(struct Lines *lines)
+{
+	if(lines)
+	{
+		free(lines->blocks);
+		free(lines->starts);
+		free(lines);
+	}
+}
+
+/** Looks up the start of a line in the line index
+	@param line A 1-based line index, no greater than `lines->count`
+	@param chars Overwritten with the character index of the line start
+	@returns The byte offset of the line start
+*/
+static inline size_t _lines_at(const struct Lines *lines, size_t line, size_t *chars)
+{
+	const struct LineBlock block = lines->blocks[(line - 1) / LINE_BLOCK];
+	const struct LineStart start = lines->starts[line - 1];
+
+	*chars = block.chars + start.chars;
+	return block.byte + start.byte;
+}
+
+/** Extends the line index until it contains the start of a line, or the entire file.
+	The line index is dropped if it can't be extended, after which lookups fall back to the markers.
+	@param want A 1-based line index
+	@returns The line index of `file`, or NULL if it has none
+*/
+static struct Lines *_lines_scan(u8file_t file, size_t want)
+{
+	struct Index *index = _getIndex(file);
+	struct Lines *lines = index->lines;
+
+	if(! lines)
+		return NULL;
+
+	const char *bytes = file->bytes;
+	const size_t size = file->size.byteCount;
+	size_t i = lines->pos, chars = lines->posChars;
+
+	while(lines->count < want && i < size)
+	{
+		// a plain newline is always a character of its own, so the text between them is scanned separately
+		const char *nl = memchr(bytes + i, '\n', size - i);
+		const size_t stop = nl ? (size_t)(nl - bytes) : size;
+
+		while(i < stop)
+		{
+			size_t n, lf, tail;
+			const size_t end = i + _u8_count(bytes + i, stop - i, &n, &lf, &tail);
+
+			if(lf)
+			{ // overlong newlines are rare enough to be located by decoding
+				while(i < end)
+				{
+					uchar_t c;
+					i += u8ndec(bytes + i, end - i, &c);
+					++chars;
+
+					if(c == '\n' && ! _lines_push(lines, i, chars))
+						goto fail;
+				}
+			}
+			else
+			{
+				i = end;
+				chars += n;
+			}
+
+			if(i < stop)
+			{ // a malformed sequence is a single character
+				uchar_t c;
+				i += u8ndec(bytes + i, stop - i, &c);
+				++chars;
+
+				if(c == '\n' && ! _lines_push(lines, i, chars))
+					goto fail;
+			}
+		}
+
+		if(nl && ! _lines_push(lines, ++i, ++chars))
+			goto fail;
+	}
+
+	lines->pos = i;
+	lines->posChars = chars;
+	return lines;
+
+	fail:
+	_lines_free(lines);
+	index->lines = NULL;
+	return NULL;
+}
+
+/** Moves a location forward to a character index, counting well-formed spans without decoding them
+	@param loc A character-aligned location
+	@param off The byte offset of `loc`, overwritten with the byte offset of the result
+	@param target The character index to move to
+	@returns The location of character `target`, or of the end of the file if it's out of bounds
+*/
+static u8loc_t _loc_seek(u8file_t file, u8loc_t loc, size_t *off, size_t target)
+{
+	if(loc.characterIndex >= target)
+		return loc;
+
+	size_t chars, lines, tail;
+	*off += _u8_seek(file->bytes + *off, file->size.byteCount - *off, target - loc.characterIndex, &chars, &lines, &tail);
+	return _loc_add(loc, (u8loc_t){ .line = lines, .column = lines ? tail + 1 : tail, .characterIndex = chars });
+}
+
+static void _chars_free(struct Chars *chars)
+{
+	if(chars)
+	{
+		free(chars->samples);
+		free(chars);
+	}
+}
+
+/** Extends the character index until it contains a number of samples, or the entire file.
+	The character index is dropped if it can't be extended, after which lookups fall back to the markers.
+	@returns The character index of `file`, or NULL if it has none
+*/
+static struct Chars *_chars_scan(u8file_t file, size_t want)
+{
+	struct Index *index = _getIndex(file);
+	struct Chars *chars = index->chars;
+
+	if(! chars)
+		return NULL;
+
+	while(chars->count < want && ! chars->complete)
+	{
+		if(chars->count == chars->cap)
+		{
+			const size_t cap = chars->cap ? 2 * chars->cap : 64;
+			struct CharSample *samples = realloc(chars->samples, cap * sizeof(struct CharSample));
+
+			if(! samples)
+			{
+				_chars_free(chars);
+				index->chars = NULL;
+				return NULL;
+			}
+
+			chars->samples = samples;
+			chars->cap = cap;
+		}
+
+		const struct CharSample last = chars->samples[chars->count - 1];
+		const size_t target = chars->count * chars->stride;
+		size_t off = last.byte;
+		const u8loc_t loc = _loc_seek(file, (u8loc_t){ .line = last.line, .column = last.column, .characterIndex = target - chars->stride }, &off, target);
+
+		// the end of the file isn't a character
+		if(loc.characterIndex < target || off == file->size.byteCount)
+			chars->complete = true;
+		else
+			chars->samples[chars->count++] = (struct CharSample){ off, loc.line, loc.column };
+	}
+
+	return chars;
+}
+
+/** Starts the character index of a file, which initially only knows the first character
+	@param stride Number of characters between each sample
+*/
+static void _chars_init(u8file_t file, size_t stride)
+{
+	struct Chars *chars = malloc(sizeof(struct Chars));
+	struct CharSample *samples = malloc(64 * sizeof(struct CharSample));
+
+	if(chars && samples)
+	{
+		*samples = (struct CharSample){ 0, initialLocation.line, initialLocation.column };
+		*chars = (struct Chars){ .stride = stride, .count = 1, .cap = 64, .complete = false, .samples = samples };
+	}
+	else
+	{
+		free(chars);
+		free(samples);
+		chars = NULL;
+	}
+
+	_getIndex(file)->chars = chars;
+}
+
+/** Starts the line index of a file, which initially only knows the first line */
+static void _lines_init(u8file_t file)
+{
+	struct Lines *lines = malloc(sizeof(struct Lines));
+
+	if(lines)
+	{
+		*lines = (struct Lines){ 0 };
+
+		if(! _lines_push(lines, 0, 0))
+		{
+			_lines_free(lines);
+			lines = NULL;
+		}
+	}
+
+	_getIndex(file)->lines = lines;
+}
+
+u8file_t u8txt_load(const char *bytes, size_t size, cleanup_f cleanup)
+{
+	return u8txt_load_ex(bytes, size, cleanup, NULL);
+}
+
+u8file_t u8txt_load_ex(const char *bytes, size_t size, cleanup_f cleanup, const u8txt_opts *opts)
+{
+	const u8txt_opts o = opts ? *opts : (u8txt_opts){ 0 };
+	// a character crossing into a chunk must end before the chunk's first marker
+	const size_t stride = o.stride ? (o.stride < UTF8_MAX ? UTF8_MAX : o.stride) : MARKER_FREQ;
+	u8file_t file = malloc(sizeof(struct TextFile) + sizeof(struct Index) + size / stride * sizeof(u8loc_t));
+
+	if(! file)
+		return NULL;
+
+	struct Index *index = _getIndex(file);
+	index->stride = stride;
+	index->built = 0;
+	index->complete = false;
+	index->lines = NULL;
+	index->chars = NULL;
+
+	// the size in characters is only known once the index is complete
+	file->udata = NULL;
+	*(const char**)&(file->bytes) = bytes;
+	*(u8size_t*)&(file->size) = (u8size_t){ .bytesExact = true, .byteCount = size, .charsExact = false, .charCount = 0 };
+	*(unsigned int*)&(file->lines) = 0;
 	*(cleanup_f*)&(file->cleanupCallback) = cleanup;
 
+	// the secondary indexes are optional, so lookups simply fall back to the markers if it can't be allocated
+	if(o.lineIndex)
+		_lines_init(file);
+	if(o.charStride)
+		_chars_init(file, o.charStride);
+
+	if(! o.lazy)
+	{
+		_mark_all(file, o.threads);
+		_lines_scan(file, SIZE_MAX);
+		_chars_scan(file, SIZE_MAX);
+	}
+
 	return file;
 }
 
+u8size_t u8txt_size(u8file_t file)
+{
+	_extend(file, NEED_MARKERS, SIZE_MAX);
+	return file->size;
+}
+
+unsigned u8txt_lines(u8file_t file)
+{
+	_extend(file, NEED_MARKERS, SIZE_MAX);
+	return file->lines;
+}
+
 void u8txt_cleanup_free(u8file_t file)
 {
 	free((char*)file->bytes);
@@ -469,6 +1066,8 @@ void u8txt_free(u8file_t file)
 	if(file->cleanupCallback)
 		file->cleanupCallback(file);
 	
+	_lines_free(_getIndex(file)->lines);
+	_chars_free(_getIndex(file)->chars);
 	free(file);
 }
 //#endregion
@@ -488,9 +1087,11 @@ int u8txt_loc(u8file_t file, const char *chr, u8loc_t *out_loc)
 
 	size_t off = chr - file->bytes;
 	// look up marker
-	size_t mi = off / MARKER_FREQ;
+	const size_t stride = _getIndex(file)->stride;
+	size_t mi = off / stride;
+	_extend(file, NEED_MARKERS, mi);
 	u8loc_t marker = _getMarker(_getMarkers(file), mi);
-	size_t mOff = mi * MARKER_FREQ;
+	size_t mOff = mi * stride;
 
 	*out_loc = _loc_move(marker, file->bytes + mOff, off - mOff, file->size.byteCount - mOff);
 
@@ -509,52 +1110,103 @@ inline static size_t u8txt_dec(u8file_t file, const char *chr, uchar_t *out_chr)
 	return u8ndec(chr, file->size.byteCount - (chr - file->bytes), out_chr);
 }
 
-const char *u8txt_line(u8file_t file, unsigned line, u8size_t *out_size)
+/** Byte offsets and character indices of the bounds of a line */
+struct LineSpan
 {
-	if(line <= 0 || line > file->lines)
-		return NULL;
+	size_t start, startChars, end, endChars;
+};
+
+/** Looks up where a line starts and ends, including its final newline
+	@param line A 1-based line index
+	@returns false if the line is out of bounds
+*/
+static bool _line_span(u8file_t file, size_t line, struct LineSpan *span)
+{
+	if(line <= 0)
+		return false;
+
+	const struct Lines *lines = _lines_scan(file, line + 1);
+
+	if(lines)
+	{
+		if(line > lines->count)
+			return false;
+
+		span->start = _lines_at(lines, line, &span->startChars);
+
+		if(line < lines->count)
+			span->end = _lines_at(lines, line + 1, &span->endChars);
+		else
+		{ // the index is complete, so the line ends at the end of the file
+			span->end = lines->pos;
+			span->endChars = lines->posChars;
+		}
+
+		return true;
+	}
+
+	// unless the index is complete, there's a marker after the line
+	_extend(file, NEED_LINE, line);
+	const bool last = _getIndex(file)->complete && line == file->lines;
+
+	if(_getIndex(file)->complete && line > file->lines)
+		return false;
 
-	const char *start;
-	size_t startIndex; // character index of `start`
-	
 	if(line == 1)
 	{
-		start = file->bytes;
-		startIndex = 0;
+		span->start = 0;
+		span->startChars = 0;
 	}
 	else
 	{
-		start = u8txt_unLoc(file, line, 1, &startIndex);
+		const char *start = u8txt_unLoc(file, line, 1, &span->startChars);
 		assert(start);
+		span->start = start - file->bytes;
+	}
+
+	if(last)
+	{ // is final line
+		span->end = file->size.byteCount;
+		span->endChars = file->size.charCount;
+	}
+	else
+	{
+		const char *end = u8txt_unLoc(file, line + 1, 1, &span->endChars);
+		assert(end);
+		span->end = end - file->bytes;
 	}
 
+	return true;
+}
+
+const char *u8txt_line(u8file_t file, unsigned line, u8size_t *out_size)
+{
+	return u8txt_lineRange(file, line, line, out_size);
+}
+
+const char *u8txt_lineRange(u8file_t file, unsigned first, unsigned last, u8size_t *out_size)
+{
+	struct LineSpan a, b;
+
+	if(last < first || ! _line_span(file, first, &a))
+		return NULL;
+
+	if(last == first)
+		b = a;
+	else if(! _line_span(file, last, &b))
+		return NULL;
+
 	if(out_size)
 	{
-		if(line == file->lines)
-		{ // is final line
-			*out_size = (u8size_t) {
-				.byteCount = file->size.byteCount - (start - file->bytes),
-				.bytesExact = true,
-				.charCount = file->size.charCount - startIndex,
-				.charsExact = true
-			};
-		}
-		else
-		{
-			size_t endIndex;
-			const char *end = u8txt_unLoc(file, line + 1, 1, &endIndex);
-			assert(end);
-
-			*out_size = (u8size_t) {
-				.byteCount = end - start,
-				.bytesExact = true,
-				.charCount = endIndex - startIndex,
-				.charsExact = true
-			};
-		}
+		*out_size = (u8size_t) {
+			.byteCount = b.end - a.start,
+			.bytesExact = true,
+			.charCount = b.endChars - a.startChars,
+			.charsExact = true
+		};
 	}
 
-	return start;
+	return file->bytes + a.start;
 }
 
 /** Prefab for `_bseek`
@@ -578,7 +1230,33 @@ static inline int _ord_loc_ix(size_t ix, void *_markers, void *_target)
 
 const char *u8txt_chr(u8file_t file, size_t index, u8loc_t *out_loc)
 {
-	if(index >= file->size.charCount)
+	const struct Chars *chars = _getIndex(file)->chars;
+
+	if(chars && (chars = _chars_scan(file, index / chars->stride + 1)))
+	{
+		const size_t k = index / chars->stride;
+
+		if(k >= chars->count)
+			return NULL;
+
+		const struct CharSample s = chars->samples[k];
+		size_t off = s.byte;
+		const u8loc_t loc = _loc_seek(file, (u8loc_t){ .line = s.line, .column = s.column, .characterIndex = k * chars->stride }, &off, index);
+
+		if(off == file->size.byteCount)
+			return NULL;
+
+		if(out_loc)
+			*out_loc = loc;
+
+		return file->bytes + off;
+	}
+
+	// unless the index is complete, there's a marker after the character
+	_extend(file, NEED_CHAR, index);
+	const struct Index *ix = _getIndex(file);
+
+	if(ix->complete && index >= file->size.charCount)
 		return NULL;
 
 	// possible range of byte offsets corresponding to `chrIx`
@@ -587,8 +1265,12 @@ const char *u8txt_chr(u8file_t file, size_t index, u8loc_t *out_loc)
 	if(bMax >= file->size.byteCount)
 		bMax = file->size.byteCount - 1;
 
-	bMin /= MARKER_FREQ;
-	bMax /= MARKER_FREQ;
+	const size_t stride = ix->stride;
+	bMin /= stride;
+	bMax /= stride;
+
+	if(bMax > ix->built)
+		bMax = ix->built;
 	
 	const u8loc_t *m = _getMarkers(file);
 	signed long long i = _bseek(bMin, bMax, (void*)m, (void*)index, _ord_loc_ix);
@@ -602,7 +1284,7 @@ const char *u8txt_chr(u8file_t file, size_t index, u8loc_t *out_loc)
 	}
 
 	u8loc_t loc = _getMarker(m, i);
-	const char *p = file->bytes + i*MARKER_FREQ;
+	const char *p = file->bytes + i*stride;
 
 	if(loc.charOff)
 	{
@@ -650,18 +1332,58 @@ static inline int _ord_loc_pos(size_t ix, void *_file, void *_pos)
 
 const char *u8txt_unLoc(u8file_t file, unsigned line, unsigned col, size_t *out_charIndex)
 {
-	if(line <= 0 || line > file->lines)
+	if(line <= 0)
+		return NULL;
+
+	// the first line is counted from column 0, every other line from column 1
+	const unsigned col0 = line > 1;
+	const struct Lines *lines = _lines_scan(file, line);
+
+	// columns far into a line are found faster from the markers
+	if(lines && (col < col0 || col - col0 <= _getIndex(file)->stride))
+	{
+		if(line > lines->count || col < col0)
+			return NULL;
+
+		size_t charIndex;
+		const char *p = file->bytes + _lines_at(lines, line, &charIndex), *end = file->bytes + file->size.byteCount;
+
+		for(unsigned c = col0; c < col; ++c, ++charIndex)
+		{
+			uchar_t chr;
+
+			if(p == end)
+				return NULL;
+
+			p += u8txt_dec(file, p, &chr);
+
+			if(chr == '\n')
+				return NULL;
+		}
+
+		if(out_charIndex)
+			*out_charIndex = charIndex;
+
+		return p;
+	}
+
+	// unless the index is complete, there's a marker after the line
+	_extend(file, NEED_LINE, line);
+	const struct Index *ix = _getIndex(file);
+
+	if(ix->complete && line > file->lines)
 		return NULL;
 
 	unsigned want[2] = { line, col };
-	const signed long long negIx =  _bseek(0, file->size.byteCount / MARKER_FREQ, file, want, _ord_loc_pos);
+	const size_t stride = ix->stride;
+	const signed long long negIx =  _bseek(0, ix->built, file, want, _ord_loc_pos);
 	assert(negIx < 0); // _ord_loc_pos never returns 0
 	const size_t next = -negIx - 1; // first marker after target
 	assert(next > 0); // can't be initial position
 	const size_t mIx = next - 1;
 	
 	u8loc_t loc = _getMarker(_getMarkers(file), mIx); // last marker before target
-	const char *p = file->bytes + mIx*MARKER_FREQ;
+	const char *p = file->bytes + mIx*stride;
 
 	if(loc.charOff)
 	{
@@ -671,12 +1393,6 @@ const char *u8txt_unLoc(u8file_t file, unsigned line, unsigned col, size_t *out_
 
 	while(loc.line <= line)
 	{
-		uchar_t c;
-		size_t l = u8txt_dec(file, p, &c);
-
-		if(l == 0)
-			break;
-
 		if(loc.line == line && loc.column == col)
 		{
 			if(out_charIndex)
@@ -685,8 +1401,13 @@ const char *u8txt_unLoc(u8file_t file, unsigned line, unsigned col, size_t *out_
 			return p;
 		}
 
+		// the end of the file is the last valid column
+		if(p == file->bytes + file->size.byteCount)
+			break;
+
+		uchar_t c;
+		p += u8txt_dec(file, p, &c);
 		loc = _loc_incr(loc, c);
-		p += l;
 	}
 
 	return NULL;
@@ -0,0 +1,150 @@
+// u8word.c: Implements word boundaries as per UAX #29
+#include "unic.h"
+#include "scan.h"
+#include "simd.h"
+#include "ucdb.h"
+
+/** Marks the absence of a character in the rule context */
+#define WB_NONE 0xFF
+
+static inline bool _ahletter(uint8_t c)
+{
+	return c == WB_ALETTER || c == WB_HEBREW_LETTER;
+}
+
+static inline bool _midletter(uint8_t c)
+{
+	return c == WB_MIDLETTER || c == WB_MIDNUMLET || c == WB_SINGLE_QUOTE;
+}
+
+static inline bool _midnum(uint8_t c)
+{
+	return c == WB_MIDNUM || c == WB_MIDNUMLET || c == WB_SINGLE_QUOTE;
+}
+
+static inline bool _ignored(uint8_t c)
+{
+	return c == WB_EXTEND || c == WB_FORMAT || c == WB_ZWJ;
+}
+
+/** The Word_Break value of an ASCII letter, digit or underscore */
+static inline uint8_t _ascii_class(unsigned char b)
+{
+	return b == '_' ? WB_EXTENDNUMLET : (unsigned char)(b - '0') < 10 ? WB_NUMERIC : WB_ALETTER;
+}
+
+/** Determines the Word_Break value of the first character after `byteIx` that isn't ignored as per WB4 */
+static uint8_t _lookahead(const char *str, u8size_t size, size_t byteIx, size_t charIx)
+{
+	while(HAS_NEXT(byteIx, charIx, size, str))
+	{
+		uchar_t c;
+		byteIx += u8ndec(str + byteIx, size.byteCount - byteIx, &c);
+		++charIx;
+
+		const uint8_t cls = UCDB_STAGES(wb, c) & ~UCDB_WB_EXTPICT;
+
+		if(! _ignored(cls))
+			return cls;
+	}
+
+	return WB_NONE;
+}
+
+u8size_t u8z_next_word(const char *str, u8size_t size)
+{
+	size_t byteIx = 0, charIx = 0;
+	// the last two characters that weren't ignored as per WB4, and the actual last character
+	uint8_t prev = WB_NONE, prev2 = WB_NONE, last = WB_NONE;
+	// whether an odd number of regional indicators precedes
+	bool riOdd = false;
+
+	while(HAS_NEXT(byteIx, charIx, size, str))
+	{
+		if(prev == WB_ALETTER || prev == WB_NUMERIC || prev == WB_EXTENDNUMLET)
+		{ // ASCII letters, digits and underscores all join a word (WB5, WB8 to WB10, WB13a, WB13b)
+			size_t lim = size.byteCount - byteIx;
+
+			if(lim > size.charCount - charIx)
+				lim = size.charCount - charIx;
+
+			const size_t run = _word_span(str + byteIx, lim, size.bytesExact);
+
+			if(run)
+			{
+				prev2 = run > 1 ? _ascii_class(str[byteIx + run - 2]) : prev;
+				prev = last = _ascii_class(str[byteIx + run - 1]);
+				byteIx += run;
+				charIx += run;
+				continue;
+			}
+		}
+
+		uchar_t c;
+		const size_t l = u8ndec(str + byteIx, size.byteCount - byteIx, &c);
+		const uint8_t v = UCDB_STAGES(wb, c), cur = v & ~UCDB_WB_EXTPICT;
+
+		if(charIx)
+		{
+			bool join;
+
+			if(last == WB_CR && cur == WB_LF)
+				join = true; // WB3
+			else if(last == WB_CR || last == WB_LF || last == WB_NEWLINE || cur == WB_CR || cur == WB_LF || cur == WB_NEWLINE)
+				join = false; // WB3a, WB3b
+			else if(last == WB_ZWJ && (v & UCDB_WB_EXTPICT))
+				join = true; // WB3c
+			else if(last == WB_WSEGSPACE && cur == WB_WSEGSPACE)
+				join = true; // WB3d
+			else if(_ignored(cur))
+				join = true; // WB4
+			else if(_ahletter(prev) && _ahletter(cur))
+				join = true; // WB5
+			else if(_ahletter(prev) && _midletter(cur) && _ahletter(_lookahead(str, size, byteIx + l, charIx + 1)))
+				join = true; // WB6
+			else if(_ahletter(prev2) && _midletter(prev) && _ahletter(cur))
+				join = true; // WB7
+			else if(prev == WB_HEBREW_LETTER && cur == WB_SINGLE_QUOTE)
+				join = true; // WB7a
+			else if(prev == WB_HEBREW_LETTER && cur == WB_DOUBLE_QUOTE && _lookahead(str, size, byteIx + l, charIx + 1) == WB_HEBREW_LETTER)
+				join = true; // WB7b
+			else if(prev2 == WB_HEBREW_LETTER && prev == WB_DOUBLE_QUOTE && cur == WB_HEBREW_LETTER)
+				join = true; // WB7c
+			else if((prev == WB_NUMERIC || _ahletter(prev)) && cur == WB_NUMERIC)
+				join = true; // WB8, WB9
+			else if(prev == WB_NUMERIC && _ahletter(cur))
+				join = true; // WB10
+			else if(prev2 == WB_NUMERIC && _midnum(prev) && cur == WB_NUMERIC)
+				join = true; // WB11
+			else if(prev == WB_NUMERIC && _midnum(cur) && _lookahead(str, size, byteIx + l, charIx + 1) == WB_NUMERIC)
+				join = true; // WB12
+			else if(prev == WB_KATAKANA && cur == WB_KATAKANA)
+				join = true; // WB13
+			else if((_ahletter(prev) || prev == WB_NUMERIC || prev == WB_KATAKANA || prev == WB_EXTENDNUMLET) && cur == WB_EXTENDNUMLET)
+				join = true; // WB13a
+			else if(prev == WB_EXTENDNUMLET && (_ahletter(cur) || cur == WB_NUMERIC || cur == WB_KATAKANA))
+				join = true; // WB13b
+			else if(prev == WB_REGIONAL_INDICATOR && cur == WB_REGIONAL_INDICATOR)
+				join = riOdd; // WB15, WB16
+			else
+				join = false; // WB999
+
+			if(! join)
+				break;
+		}
+
+		// WB4 doesn't apply to the first character, which line breaks always precede
+		if(!_ignored(cur) || prev == WB_NONE)
+		{
+			riOdd = cur == WB_REGIONAL_INDICATOR && !(prev == WB_REGIONAL_INDICATOR && riOdd);
+			prev2 = prev;
+			prev = cur;
+		}
+
+		last = cur;
+		byteIx += l;
+		++charIx;
+	}
+
+	return (u8size_t){ true, byteIx, true, charIx };
+}
@@ -1,6 +1,8 @@
 /* utf8.h: Allows for working with utf-8 encoded streams or buffers. */
 #include <stdio.h>
 #include "../include/unic.h"
+#include "scan.h"
+#include "simd.h"
 
 inline static size_t u8len(uchar_t c)
 {
@@ -13,49 +15,15 @@ inline static size_t u8len(uchar_t c)
 				: 1;
 }
 
+/** Windows-1252 interpretations of the bytes 0x80 to 0x9F. Bytes it leaves undefined map to the C1 control of the same value. */
+static const uint16_t _w1252[32] = {
+	0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021, 0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+	0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014, 0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178,
+};
+
 static inline uchar_t _w1252_fallback(unsigned char c)
 {
-	#define MAP(w, u) case w: return u;
-
-	switch(c)
-	{
-		MAP(0x80, 0x20AC)
-
-		MAP(0x82, 0x201A)
-		MAP(0x83, 0x0192)
-		MAP(0x84, 0x201E)
-		MAP(0x85, 0x2026)
-		MAP(0x86, 0x2020)
-		MAP(0x87, 0x2021)
-		MAP(0x88, 0x02C6)
-		MAP(0x89, 0x2030)
-		MAP(0x8A, 0x0160)
-		MAP(0x8B, 0x2039)
-		MAP(0x8C, 0x0152)
-
-		MAP(0x8E, 0x017D)
-
-		MAP(0x91, 0x2018)
-		MAP(0x92, 0x2019)
-		MAP(0x93, 0x201C)
-		MAP(0x94, 0x201D)
-		MAP(0x95, 0x2022)
-		MAP(0x96, 0x2013)
-		MAP(0x97, 0x2014)
-		MAP(0x98, 0x02DC)
-		MAP(0x99, 0x2122)
-		MAP(0x9A, 0x0161)
-		MAP(0x9B, 0x203A)
-		MAP(0x9C, 0x0153)
-
-		MAP(0x9E, 0x017E)
-		MAP(0x9F, 0x0178)
-
-		default:
-			return c;
-	}
-
-	#undef MAP
+	return c - 0x80u < 32 ? _w1252[c - 0x80] : c;
 }
 
 /* Count the amount of leading ones in i */
@@ -134,6 +102,535 @@ size_t u8enc(uchar_t uc, char *buf)
 	return l;
 }
 
+/** Substitute for characters that can't be transcoded */
+#define REPLACEMENT 0xFFFD
+
+/** Determines if a code point is a surrogate or out of range, i.e. not a valid scalar value */
+static inline bool _unscalar(uchar_t c)
+{
+	return c - 0xD800 < 0x800 || c > 0x10FFFF;
+}
+
+/** Reads a UTF-16 or UTF-32 code unit of the given size */
+static inline uint32_t _getunit(const unsigned char *p, unsigned width, bool be)
+{
+	uint32_t u = 0;
+
+	for(unsigned i = 0; i < width; ++i)
+		u |= (uint32_t)p[be ? i : width - 1 - i] << (8 * (width - 1 - i));
+
+	return u;
+}
+
+/** Writes a UTF-16 or UTF-32 code unit of the given size */
+static inline void _putunit(unsigned char *p, uint32_t u, unsigned width, bool be)
+{
+	for(unsigned i = 0; i < width; ++i)
+		p[be ? i : width - 1 - i] = u >> (8 * (width - 1 - i));
+}
+
+/** Variant of `u8enc()` that the transcoders inline */
+static inline size_t _enc(uchar_t c, char *out)
+{
+	if(c < 0x80)
+	{
+		out[0] = c;
+		return 1;
+	}
+	if(c < 0x800)
+	{
+		out[0] = 0xC0 | c >> 6;
+		out[1] = 0x80 | (c & 0x3F);
+		return 2;
+	}
+	if(c < 0x10000)
+	{
+		out[0] = 0xE0 | c >> 12;
+		out[1] = 0x80 | (c >> 6 & 0x3F);
+		out[2] = 0x80 | (c & 0x3F);
+		return 3;
+	}
+
+	out[0] = 0xF0 | c >> 18;
+	out[1] = 0x80 | (c >> 12 & 0x3F);
+	out[2] = 0x80 | (c >> 6 & 0x3F);
+	out[3] = 0x80 | (c & 0x3F);
+	return 4;
+}
+
+/** Variant of `u8ndec()` that the transcoders inline for two and three byte sequences */
+static inline size_t _dec(const char *str, size_t n, uchar_t *c)
+{
+	const unsigned char *s = (const unsigned char*)str;
+
+	// never reads past a mismatched continuation byte, just like u8dec()
+	if(n >= 2 && (s[0] & 0xE0) == 0xC0 && (s[1] & 0xC0) == 0x80)
+	{
+		*c = (s[0] & 0x1F) << 6 | (s[1] & 0x3F);
+		return 2;
+	}
+	if(n >= 3 && (s[0] & 0xF0) == 0xE0 && (s[1] & 0xC0) == 0x80 && (s[2] & 0xC0) == 0x80)
+	{
+		*c = (s[0] & 0x0F) << 12 | (s[1] & 0x3F) << 6 | (s[2] & 0x3F);
+		return 3;
+	}
+
+	return u8ndec(str, n, c);
+}
+
+/** Transcodes UTF-16 or UTF-32 to utf-8. Reports sizes like `u8z_strmap()`.
+	Inlined into every entry point so that the unit size and byte order are constants.
+*/
+__attribute__((always_inline)) static inline u8size_t _from_units(const unsigned char *src, size_t size, unsigned width, bool be, char *dst, size_t cap, bool nulTerminate)
+{
+	size_t bytes = 0, chars = 0;
+	bool truncated = false;
+
+	for(size_t i = 0; i < size; )
+	{
+		// runs of ASCII are narrowed without decoding every unit
+		if(size - i >= width && _getunit(src + i, width, be) < 0x80)
+		{
+			size_t n = (size - i) / width;
+			const size_t room = cap > bytes + nulTerminate ? cap - bytes - nulTerminate : 0;
+
+			if(n > room)
+				n = room;
+
+			const size_t run = _narrow_ascii(src + i, n, width, be, nulTerminate, dst ? dst + bytes : NULL);
+
+			if(run)
+			{
+				i += run * width;
+				bytes += run;
+				chars += run;
+				continue;
+			}
+		}
+
+		uchar_t c = REPLACEMENT;
+		size_t l = size - i;
+
+		// an incomplete final unit is replaced
+		if(l >= width)
+		{
+			c = _getunit(src + i, width, be);
+			l = width;
+
+			if(width == 2 && c - 0xD800 < 0x400 && size - i >= 4)
+			{
+				const uchar_t low = _getunit(src + i + 2, 2, be);
+
+				if(low - 0xDC00 < 0x400)
+				{
+					c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+					l = 4;
+				}
+			}
+			else if(width == 2 && c - 0xD800 < 0x400)
+			{ // a high surrogate and incomplete unit only make for a single replacement
+				l = size - i;
+			}
+
+			if(_unscalar(c))
+				c = REPLACEMENT;
+		}
+
+		char next[UTF8_MAX];
+		size_t nl;
+
+		if(!c && nulTerminate)
+		{
+			next[0] = UNUL[0];
+			next[1] = UNUL[1];
+			nl = 2;
+		}
+		else
+			nl = _enc(c, next);
+
+		if(bytes + nl + nulTerminate > cap)
+		{
+			truncated = true;
+			break;
+		}
+
+		if(dst)
+			memcpy(dst + bytes, next, nl);
+
+		i += l;
+		bytes += nl;
+		++chars;
+	}
+
+	if(nulTerminate)
+	{
+		if(cap == 0)
+			truncated = true;
+		else
+		{
+			if(dst)
+				dst[bytes] = 0;
+			++bytes;
+		}
+	}
+
+	return (u8size_t){ .bytesExact = !truncated, .byteCount = bytes, .charsExact = !truncated, .charCount = chars };
+}
+
+/** Transcodes utf-8 to UTF-16 or UTF-32. Reports sizes like `u8z_strmap()`, but in bytes of the target encoding. */
+__attribute__((always_inline)) static inline u8size_t _to_units(const char *str, u8size_t size, unsigned width, bool be, unsigned char *dst, size_t cap, bool nulTerminate)
+{
+	const size_t term = nulTerminate ? width : 0;
+	size_t bytes = 0, chars = 0, byteIx = 0;
+	bool truncated = false;
+
+	while(HAS_NEXT(byteIx, chars, size, str))
+	{
+		// runs of ASCII are widened without decoding every character
+		if((unsigned char)str[byteIx] < 0x80)
+		{
+			size_t n = size.byteCount - byteIx;
+			const size_t room = cap > bytes + term ? (cap - bytes - term) / width : 0;
+
+			if(n > size.charCount - chars)
+				n = size.charCount - chars;
+			if(n > room)
+				n = room;
+
+			const size_t run = _ascii_span(str + byteIx, n, size.bytesExact, 0, 1, 0);
+
+			if(run)
+			{
+				if(dst)
+					_widen_ascii(str + byteIx, run, width, be, dst + bytes);
+
+				byteIx += run;
+				bytes += run * width;
+				chars += run;
+				continue;
+			}
+		}
+
+		uchar_t c;
+		const size_t l = _dec(str + byteIx, size.byteCount - byteIx, &c);
+
+		if(_unscalar(c))
+			c = REPLACEMENT;
+
+		// characters outside the BMP take a surrogate pair in UTF-16
+		const size_t nl = width == 2 && c > 0xFFFF ? 4 : width;
+
+		if(bytes + nl + term > cap)
+		{
+			truncated = true;
+			break;
+		}
+
+		if(dst && nl > width)
+		{
+			_putunit(dst + bytes, 0xD800 | (c - 0x10000) >> 10, 2, be);
+			_putunit(dst + bytes + 2, 0xDC00 | (c & 0x3FF), 2, be);
+		}
+		else if(dst)
+			_putunit(dst + bytes, c, width, be);
+
+		byteIx += l;
+		bytes += nl;
+		++chars;
+	}
+
+	if(nulTerminate)
+	{
+		if(bytes + term > cap)
+			truncated = true;
+		else
+		{
+			if(dst)
+				memset(dst + bytes, 0, term);
+			bytes += term;
+		}
+	}
+
+	return (u8size_t){ .bytesExact = !truncated, .byteCount = bytes, .charsExact = !truncated, .charCount = chars };
+}
+
+u8size_t u8_from_utf16le(const void *src, size_t size, char *dst, size_t cap, bool nulTerminate)
+{
+	return _from_units(src, size, 2, false, dst, cap, nulTerminate);
+}
+
+u8size_t u8_from_utf16be(const void *src, size_t size, char *dst, size_t cap, bool nulTerminate)
+{
+	return _from_units(src, size, 2, true, dst, cap, nulTerminate);
+}
+
+u8size_t u8_from_utf32le(const void *src, size_t size, char *dst, size_t cap, bool nulTerminate)
+{
+	return _from_units(src, size, 4, false, dst, cap, nulTerminate);
+}
+
+u8size_t u8_from_utf32be(const void *src, size_t size, char *dst, size_t cap, bool nulTerminate)
+{
+	return _from_units(src, size, 4, true, dst, cap, nulTerminate);
+}
+
+u8size_t u8z_to_utf16le(const char *str, u8size_t size, void *dst, size_t cap, bool nulTerminate)
+{
+	return _to_units(str, size, 2, false, dst, cap, nulTerminate);
+}
+
+u8size_t u8z_to_utf16be(const char *str, u8size_t size, void *dst, size_t cap, bool nulTerminate)
+{
+	return _to_units(str, size, 2, true, dst, cap, nulTerminate);
+}
+
+u8size_t u8z_to_utf32le(const char *str, u8size_t size, void *dst, size_t cap, bool nulTerminate)
+{
+	return _to_units(str, size, 4, false, dst, cap, nulTerminate);
+}
+
+u8size_t u8z_to_utf32be(const char *str, u8size_t size, void *dst, size_t cap, bool nulTerminate)
+{
+	return _to_units(str, size, 4, true, dst, cap, nulTerminate);
+}
+
+// the terminator is found up front so that the ASCII kernels may read ahead
+
+u8size_t u8_to_utf16le(const char *str, void *dst, size_t cap, bool nulTerminate)
+{
+	return u8z_to_utf16le(str, EXACT_BYTES(strlen(str)), dst, cap, nulTerminate);
+}
+
+u8size_t u8_to_utf16be(const char *str, void *dst, size_t cap, bool nulTerminate)
+{
+	return u8z_to_utf16be(str, EXACT_BYTES(strlen(str)), dst, cap, nulTerminate);
+}
+
+u8size_t u8_to_utf32le(const char *str, void *dst, size_t cap, bool nulTerminate)
+{
+	return u8z_to_utf32le(str, EXACT_BYTES(strlen(str)), dst, cap, nulTerminate);
+}
+
+u8size_t u8_to_utf32be(const char *str, void *dst, size_t cap, bool nulTerminate)
+{
+	return u8z_to_utf32be(str, EXACT_BYTES(strlen(str)), dst, cap, nulTerminate);
+}
+
+/** Substitute for characters a single-byte encoding can't represent */
+#define SUBSTITUTE '?'
+
+/** Encodes a character as Windows-1252
+	@returns Its byte, or -1 if it has none
+*/
+static inline int _w1252_byte(uchar_t c)
+{
+	if(c < 0x80 || (c >= 0xA0 && c <= 0xFF))
+		return c;
+	// C1 controls only exist where Windows-1252 leaves bytes undefined
+	if(c < 0xA0)
+		return _w1252[c - 0x80] == c ? (int)c : -1;
+
+	for(unsigned i = 0; i < 32; ++i)
+	{
+		if(_w1252[i] == c)
+			return 0x80 + i;
+	}
+
+	return -1;
+}
+
+/** Transcodes a single-byte encoding to utf-8. Reports sizes like `u8z_strmap()`.
+	@param w1252 Whether bytes are Windows-1252 rather than Latin-1
+	@param repair Whether to keep valid utf-8 sequences and only reinterpret the bytes around them
+*/
+__attribute__((always_inline)) static inline u8size_t _from_bytes(const char *src, size_t size, char *dst, size_t cap, bool nulTerminate, bool w1252, bool repair)
+{
+	size_t bytes = 0, chars = 0;
+	bool truncated = false;
+
+	for(size_t i = 0; i < size; )
+	{
+		// ASCII is the same in every encoding
+		size_t n = size - i;
+		const size_t room = cap > bytes + nulTerminate ? cap - bytes - nulTerminate : 0;
+
+		if(n > room)
+			n = room;
+
+		const size_t run = _ascii_span(src + i, n, true, 0, 1, 0);
+
+		if(run)
+		{
+			if(dst)
+				memcpy(dst + bytes, src + i, run);
+
+			i += run;
+			bytes += run;
+			chars += run;
+			continue;
+		}
+
+		const unsigned char b = src[i];
+		uchar_t c = w1252 ? _w1252_fallback(b) : b;
+		size_t l = 1;
+
+		if(repair && b >= 0x80)
+		{
+			uchar_t d;
+			const size_t dl = u8ndec(src + i, size - i, &d);
+
+			// only take well-formed sequences, except for the over-encoded NUL
+			if(dl > 1 && !_unscalar(d) && (dl == u8len(d) || (!d && dl == 2)))
+			{
+				c = d;
+				l = dl;
+			}
+		}
+
+		char next[UTF8_MAX];
+		size_t nl;
+
+		if(!c && nulTerminate)
+		{
+			next[0] = UNUL[0];
+			next[1] = UNUL[1];
+			nl = 2;
+		}
+		else
+			nl = _enc(c, next);
+
+		if(bytes + nl + nulTerminate > cap)
+		{
+			truncated = true;
+			break;
+		}
+
+		if(dst)
+			memcpy(dst + bytes, next, nl);
+
+		i += l;
+		bytes += nl;
+		++chars;
+	}
+
+	if(nulTerminate)
+	{
+		if(cap == 0)
+			truncated = true;
+		else
+		{
+			if(dst)
+				dst[bytes] = 0;
+			++bytes;
+		}
+	}
+
+	return (u8size_t){ .bytesExact = !truncated, .byteCount = bytes, .charsExact = !truncated, .charCount = chars };
+}
+
+/** Transcodes utf-8 to a single-byte encoding. Reports sizes like `u8z_strmap()`.
+	@param w1252 Whether to write Windows-1252 rather than Latin-1
+*/
+__attribute__((always_inline)) static inline u8size_t _to_bytes(const char *str, u8size_t size, char *dst, size_t cap, bool nulTerminate, bool w1252)
+{
+	size_t bytes = 0, chars = 0, byteIx = 0;
+	bool truncated = false;
+
+	while(HAS_NEXT(byteIx, chars, size, str))
+	{
+		size_t n = size.byteCount - byteIx;
+		const size_t room = cap > bytes + nulTerminate ? cap - bytes - nulTerminate : 0;
+
+		if(n > size.charCount - chars)
+			n = size.charCount - chars;
+		if(n > room)
+			n = room;
+
+		const size_t run = _ascii_span(str + byteIx, n, size.bytesExact, 0, 1, 0);
+
+		if(run)
+		{
+			if(dst)
+				memcpy(dst + bytes, str + byteIx, run);
+
+			byteIx += run;
+			bytes += run;
+			chars += run;
+			continue;
+		}
+
+		uchar_t c;
+		const size_t l = _dec(str + byteIx, size.byteCount - byteIx, &c);
+		int b = w1252 ? _w1252_byte(c) : c <= 0xFF ? (int)c : -1;
+
+		// a NUL byte would end NUL-terminated output early
+		if(b < 0 || (!b && nulTerminate))
+			b = SUBSTITUTE;
+
+		if(bytes + 1 + nulTerminate > cap)
+		{
+			truncated = true;
+			break;
+		}
+
+		if(dst)
+			dst[bytes] = b;
+
+		byteIx += l;
+		++bytes;
+		++chars;
+	}
+
+	if(nulTerminate)
+	{
+		if(cap == 0)
+			truncated = true;
+		else
+		{
+			if(dst)
+				dst[bytes] = 0;
+			++bytes;
+		}
+	}
+
+	return (u8size_t){ .bytesExact = !truncated, .byteCount = bytes, .charsExact = !truncated, .charCount = chars };
+}
+
+u8size_t u8_from_latin1(const char *src, size_t size, char *dst, size_t cap, bool nulTerminate)
+{
+	return _from_bytes(src, size, dst, cap, nulTerminate, false, false);
+}
+
+u8size_t u8_from_cp1252(const char *src, size_t size, char *dst, size_t cap, bool nulTerminate)
+{
+	return _from_bytes(src, size, dst, cap, nulTerminate, true, false);
+}
+
+u8size_t u8_repair_cp1252(const char *src, size_t size, char *dst, size_t cap, bool nulTerminate)
+{
+	return _from_bytes(src, size, dst, cap, nulTerminate, true, true);
+}
+
+u8size_t u8z_to_latin1(const char *str, u8size_t size, char *dst, size_t cap, bool nulTerminate)
+{
+	return _to_bytes(str, size, dst, cap, nulTerminate, false);
+}
+
+u8size_t u8z_to_cp1252(const char *str, u8size_t size, char *dst, size_t cap, bool nulTerminate)
+{
+	return _to_bytes(str, size, dst, cap, nulTerminate, true);
+}
+
+u8size_t u8_to_latin1(const char *str, char *dst, size_t cap, bool nulTerminate)
+{
+	return u8z_to_latin1(str, EXACT_BYTES(strlen(str)), dst, cap, nulTerminate);
+}
+
+u8size_t u8_to_cp1252(const char *str, char *dst, size_t cap, bool nulTerminate)
+{
+	return u8z_to_cp1252(str, EXACT_BYTES(strlen(str)), dst, cap, nulTerminate);
+}
+
 uchar_t fgetu8(FILE *f)
 {
 	char b[4];
@@ -1,5 +1,6 @@
 /* util.h: Provides functions for working with unicode characters */
 #include <ctype.h>
+#include <string.h>
 #include "ucdb.h"
 
 enum unic_gc uchar_class(uchar_t c)
@@ -50,6 +51,58 @@ bool uchar_is(uchar_t chr, enum unic_gc class)
 	return uclass_is(class, uchar_class(chr));
 }
 
+bool uchar_isIdStart(uchar_t c)
+{
+	return UCDB_BITSET(xid_start, c);
+}
+
+bool uchar_isIdContinue(uchar_t c)
+{
+	return UCDB_BITSET(xid_continue, c);
+}
+
+enum unic_script uchar_script(uchar_t c)
+{
+	return c < 0x110000 ? ucdb_script_blocks[ucdb_script_index[c >> UCDB_BLOCK_BITS]][c % (1 << UCDB_BLOCK_BITS)] : USCRIPT_UNKNOWN;
+}
+
+bool uchar_hasScript(uchar_t c, enum unic_script script)
+{
+	const struct ucdb_script_ext *e = ucdb_script_ext_get(c);
+
+	if(! e)
+		return uchar_script(c) == script;
+
+	for(unsigned i = 0; i < e->count; ++i)
+	{
+		if(ucdb_script_ext_list[e->offset + i] == script)
+			return true;
+	}
+
+	return false;
+}
+
+int uchar_digit(uchar_t c)
+{
+	if(c - '0' < 10)
+		return c - '0';
+
+	// find the last run of digits that starts at or before c
+	size_t l = 0, r = UCDB_DIGIT_RUNS;
+
+	while(l < r)
+	{
+		const size_t m = (l + r) / 2;
+
+		if(ucdb_digit_zeros[m] <= c)
+			l = m + 1;
+		else
+			r = m;
+	}
+
+	return l && c - ucdb_digit_zeros[l - 1] < 10 ? (int)(c - ucdb_digit_zeros[l - 1]) : -1;
+}
+
 int u_isspace(uchar_t c)
 {
 	return (c < 0x80 && isspace(c)) || uchar_is(c, UCLASS_SEPARATOR);
@@ -66,3 +119,46 @@ uchar_t uchar_upper(uchar_t c)
 	const struct ucdb_entry *e = ucdb_get(c);
 	return e ? c + e->uppercaseDelta : c;
 }
+
+uchar_t uchar_fold(uchar_t c)
+{
+	return uchar_lower(uchar_upper(c));
+}
+
+/** Advances past characters that are ignored under loose matching */
+static inline size_t _loose_skip(const char *str, size_t i, size_t len)
+{
+	while(i < len && (str[i] == '_' || str[i] == '-' || str[i] == ' '))
+		++i;
+
+	return i;
+}
+
+bool uclass_byname(const char *name, size_t len, enum unic_gc *out)
+{
+	for(size_t k = 0; k < UCDB_CLASS_NAMES; ++k)
+	{
+		const char *cand = ucdb_class_names[k].name;
+		const size_t clen = strlen(cand);
+		size_t i = 0, j = 0;
+
+		for(;;)
+		{
+			i = _loose_skip(name, i, len);
+			j = _loose_skip(cand, j, clen);
+
+			if(i == len || j == clen || tolower((unsigned char)name[i]) != tolower((unsigned char)cand[j]))
+				break;
+
+			++i, ++j;
+		}
+
+		if(i == len && j == clen)
+		{
+			*out = ucdb_class_names[k].class;
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,79 @@
+#include "common.h"
+#include "unic.h"
+
+/** u8z_strmap_into must produce the same output as u8z_strmap */
+TEST(strmap_into_matches_strmap, str_t, str)
+{
+	char expect[256];
+	u8size_t want = u8z_strmap(str.bytes, EXACT_BYTES(str.size), expect, sizeof(expect), true, uchar_upper);
+	assertTrue(want.bytesExact);
+
+	u8buf_t buf = u8buf_init(NULL, 0, true);
+	u8size_t got = u8z_strmap_into(str.bytes, EXACT_BYTES(str.size), &buf, uchar_upper);
+	assertTrue(got.bytesExact);
+	assertUEq(want.charCount, got.charCount);
+	assertUEq(want.byteCount, got.byteCount + 1);
+
+	u8size_t fin;
+	char *res = u8buf_finish(&buf, &fin);
+	assertTrue(res != NULL);
+	assertUEq(want.byteCount, fin.byteCount);
+	assertSEq(expect, res);
+	free(res);
+}
+
+TEST(strcpy_into_normalizes)
+{
+	const char overEncoded[] = "\xC1\xA6" "oo" UNUL "b\xE0\x81\xA1r";
+	u8buf_t buf = u8buf_init(NULL, 0, false);
+
+	u8size_t z = u8_strcpy_into(overEncoded, &buf);
+	assertTrue(z.bytesExact);
+	assertUEq(7, z.charCount);
+	assertUEq(7, buf.byteCount);
+	assertTrue(memcmp(buf.bytes, "foo\0bar", 7) == 0);
+
+	u8buf_free(&buf);
+	assertUEq(0, buf.byteCount);
+}
+
+TEST(arena_overflow)
+{
+	char arena[8];
+	u8buf_t buf = u8buf_init(arena, sizeof(arena), true);
+
+	assertIEq(0, u8buf_append(&buf, "abc", NUL_TERMINATED));
+	assertPEq(arena, buf.bytes);
+
+	assertIEq(0, u8buf_append(&buf, "d" "\xC3\xBC" "efghij", NUL_TERMINATED));
+	assertTrue(buf.bytes != arena);
+	assertIEq(0, u8buf_appendc(&buf, 0));
+
+	u8size_t z;
+	char *res = u8buf_finish(&buf, &z);
+	assertSEq("abcd" "\xC3\xBC" "efghij" UNUL, res);
+	assertUEq(15, z.byteCount);
+	assertUEq(12, z.charCount);
+	free(res);
+}
+
+TEST(arena_kept)
+{
+	char arena[16];
+	u8buf_t buf = u8buf_init(arena, sizeof(arena), true);
+
+	assertIEq(0, u8buf_append(&buf, "short", NUL_TERMINATED));
+	assertPEq(arena, u8buf_finish(&buf, NULL));
+	assertSEq("short", arena);
+}
+
+TEST(strmapdup_lower)
+{
+	u8size_t z;
+	char *res = u8z_strmapdup("FooB\xC3\x84R", NUL_TERMINATED, uchar_lower, &z);
+
+	assertSEq("foob\xC3\xA4r", res);
+	assertUEq(8, z.byteCount);
+	assertUEq(6, z.charCount);
+	free(res);
+}
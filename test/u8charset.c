@@ -0,0 +1,89 @@
+#include "common.h"
+#include "unic.h"
+
+/** Checks that the span of a string's own characters is the entire string */
+TEST(charset_own_chars, str_t, str)
+{
+	u8charset_t set = u8charset_new(str.bytes, EXACT_BYTES(str.size));
+	assertTrue(set);
+
+	const u8size_t n = u8z_strspn(str.bytes, EXACT_BYTES(str.size), set);
+	assertUEq(str.size, n.byteCount);
+	assertUEq(str.count, n.charCount);
+	assertUEq(0, u8z_strcspn(str.bytes, EXACT_BYTES(str.size), set).byteCount);
+
+	u8charset_free(set);
+}
+
+TEST(charset_members)
+{
+	u8charset_t set = u8charset_new(",\t" "\xE2\x80\x9C", NUL_TERMINATED);
+	assertTrue(set);
+
+	assertIEq(0, u8charset_addRange(set, 0x3B1, 0x3C9));
+	assertIEq(0, u8charset_addRange(set, 0x3C0, 0x3D0));
+	assertIEq(0, u8charset_add(set, 0x3AF));
+	assertIEq(-1, u8charset_addRange(set, 'z', 'a'));
+
+	assertTrue(u8charset_has(set, ','));
+	assertTrue(u8charset_has(set, '\t'));
+	assertTrue(u8charset_has(set, 0x201C));
+	assertTrue(u8charset_has(set, 0x3B1));
+	assertTrue(u8charset_has(set, 0x3D0));
+	assertTrue(u8charset_has(set, 0x3AF));
+	assertTrue(!u8charset_has(set, 0x3B0));
+	assertTrue(!u8charset_has(set, 0x201D));
+	assertTrue(!u8charset_has(set, 'a'));
+	assertTrue(!u8charset_has(set, 0));
+
+	u8charset_addClass(set, UCLASS_DECIMAL_NUMBER);
+	assertTrue(u8charset_has(set, '7'));
+	assertTrue(u8charset_has(set, 0x0663));
+	assertTrue(!u8charset_has(set, 'x'));
+
+	u8charset_free(set);
+}
+
+TEST(charset_pbrk)
+{
+	u8charset_t set = u8charset_new(",\"" "\xE2\x80\x9C" "\xE2\x80\x9D", NUL_TERMINATED);
+	assertTrue(set);
+
+	// long enough for the vectorized scan to classify whole blocks
+	const char *csv = "plain ascii field without delimiters," "\"quoted\"";
+	assertSEq(",\"quoted\"", u8_strpbrk(csv, set));
+	assertUEq(36, u8_strcspn(csv, set).byteCount);
+
+	const char *quoted = "\xC3\xA4" "hnlich wie ein sehr langes Feld " "\xE2\x80\x9D" "x";
+	assertSEq("\xE2\x80\x9D" "x", u8_strpbrk(quoted, set));
+	assertUEq(33, u8_strcspn(quoted, set).charCount);
+
+	assertTrue(u8_strpbrk("no delimiters in here at all, really", set) != NULL);
+	assertTrue(u8_strpbrk("no delimiters in here at all; really", set) == NULL);
+	// sized prefixes end the search
+	assertTrue(u8z_strpbrk(csv, MAX_CHARS(36), set) == NULL);
+	assertTrue(u8z_strpbrk(csv, MAX_BYTES(37), set) != NULL);
+
+	u8charset_free(set);
+}
+
+TEST(charset_span)
+{
+	u8charset_t set = u8charset_new(" ", NUL_TERMINATED);
+	assertTrue(set);
+	u8charset_addClass(set, UCLASS_LETTER);
+
+	u8size_t n = u8_strspn("Gr" "\xC3\xBC\xC3\x9F" "e aus K" "\xC3\xB6" "ln, 2024", set);
+	assertUEq(17, n.byteCount);
+	assertUEq(14, n.charCount);
+
+	// members past a NUL byte are only reached with exact sizes
+	n = u8z_strspn("abc\0def", EXACT_BYTES(7), set);
+	assertUEq(3, n.byteCount);
+	assertIEq(0, u8charset_add(set, 0));
+	n = u8z_strspn("abc\0def", EXACT_BYTES(7), set);
+	assertUEq(7, n.byteCount);
+	assertUEq(3, u8_strspn("abc\0def", set).byteCount);
+
+	u8charset_free(set);
+}
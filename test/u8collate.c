@@ -0,0 +1,69 @@
+#include "common.h"
+#include "unic.h"
+
+/** Compares the sort keys of two strings
+	@returns The sign of comparing the keys with `memcmp()`, where a key that is a prefix of the other one sorts first
+*/
+static int cmpKeys(const char *a, const char *b, enum u8collate_level level)
+{
+	char ka[256], kb[256];
+	const size_t na = u8_sortkey(a, level, ka, sizeof(ka)), nb = u8_sortkey(b, level, kb, sizeof(kb));
+	assertTrue(na <= sizeof(ka) && nb <= sizeof(kb));
+
+	const int r = memcmp(ka, kb, na < nb ? na : nb);
+	return r ? (r > 0) - (r < 0) : (na > nb) - (na < nb);
+}
+
+/** Checks that a string's key is the same whether or not it is truncated */
+TEST(sortkey_truncated, str_t, str)
+{
+	const size_t n = u8z_sortkey(str.bytes, EXACT_BYTES(str.size), U8COLLATE_TERTIARY, NULL, 0);
+	char *full = malloc(n + 1), *part = malloc(n / 2 + 1);
+
+	assertUEq(n, u8z_sortkey(str.bytes, EXACT_BYTES(str.size), U8COLLATE_TERTIARY, full, n));
+	assertUEq(n, u8z_sortkey(str.bytes, EXACT_BYTES(str.size), U8COLLATE_TERTIARY, part, n / 2));
+	assertTrue(memcmp(full, part, n / 2) == 0);
+
+	free(full);
+	free(part);
+}
+
+TEST(sortkey_levels)
+{
+	// case only matters at the third level
+	assertIEq(0, cmpKeys("Apple", "apple", U8COLLATE_SECONDARY));
+	assertIEq(1, cmpKeys("Apple", "apple", U8COLLATE_TERTIARY));
+	// accents only matter from the second level on
+	assertIEq(0, cmpKeys("r\xC3\xA9sum\xC3\xA9", "resume", U8COLLATE_PRIMARY));
+	assertIEq(1, cmpKeys("r\xC3\xA9sum\xC3\xA9", "resume", U8COLLATE_SECONDARY));
+	assertIEq(1, cmpKeys("R\xC3\xA9sum\xC3\xA9", "resume", U8COLLATE_SECONDARY));
+	// but base letters always come first
+	assertIEq(-1, cmpKeys("r\xC3\xA9sum\xC3\xA9", "resumes", U8COLLATE_TERTIARY));
+	assertIEq(-1, cmpKeys("\xC3\x84nderung", "Bericht", U8COLLATE_TERTIARY));
+	assertIEq(1, cmpKeys("zebra", "\xC3\x85ngstr\xC3\xB6m", U8COLLATE_PRIMARY));
+}
+
+TEST(sortkey_equivalence)
+{
+	// precomposed and decomposed e with acute
+	assertIEq(0, cmpKeys("caf\xC3\xA9", "cafe\xCC\x81", U8COLLATE_TERTIARY));
+	// HANGUL SYLLABLE GAG and its jamo
+	assertIEq(0, cmpKeys("\xEA\xB0\x81", "\xE1\x84\x80\xE1\x85\xA1\xE1\x86\xA8", U8COLLATE_TERTIARY));
+	// digits of different scripts share their primary weight
+	assertIEq(0, cmpKeys("1", "\xD9\xA1", U8COLLATE_PRIMARY));
+}
+
+TEST(sortkey_order)
+{
+	// spaces and punctuation before digits, before letters, before ideographs
+	const char *sorted[] = { " x", "-x", "1x", "9x", "ax", "Ax", "\xC3\xA1x", "bx", "\xCE\xB1x", "\xD0\xB0x", "\xE4\xB8\x80x", "\xF0\xA0\x80\x80x" };
+	const size_t n = sizeof(sorted) / sizeof(*sorted);
+
+	for(size_t i = 0; i + 1 < n; ++i)
+		assertIEq(-1, cmpKeys(sorted[i], sorted[i + 1], U8COLLATE_TERTIARY), " at %zu", i);
+
+	// a prefix sorts first
+	assertIEq(-1, cmpKeys("abc", "abcd", U8COLLATE_TERTIARY));
+	assertIEq(0, cmpKeys("", "", U8COLLATE_TERTIARY));
+	assertUEq(0, u8_sortkey("", U8COLLATE_PRIMARY, NULL, 0));
+}
@@ -0,0 +1,229 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <u8text.h>
+#include "common.h"
+#include "interface.h"
+#include "unic.h"
+
+/** Checks that an editor agrees with a text file loaded from the expected content */
+static void checkEditor(u8edit_t ed, const char *want, size_t size)
+{
+	u8file_t ref = u8txt_load(want, size, NULL);
+
+	if(! ref)
+		testFailure("Malloc failure");
+
+	const u8size_t n = u8edit_size(ed);
+	assertUEq(size, n.byteCount);
+	assertUEq(ref->size.charCount, n.charCount);
+	assertUEq(ref->lines, u8edit_lines(ed));
+
+	u8file_t snap = u8edit_snapshot(ed, NULL);
+	assertUEq(size, snap->size.byteCount);
+	assertTrue(memcmp(want, snap->bytes, size) == 0);
+	u8txt_free(snap);
+
+	for(size_t o = 0; o < size; o += 1 + o / 16)
+	{
+		u8loc_t a, b;
+		assertIEq(0, u8txt_loc(ref, want + o, &a));
+		assertIEq(0, u8edit_loc(ed, o, &b));
+		assertUEq(a.line, b.line, " at %zu", o);
+		assertUEq(a.column, b.column, " at %zu", o);
+		assertUEq(a.characterIndex, b.characterIndex, " at %zu", o);
+		assertUEq(a.charOff, b.charOff, " at %zu", o);
+	}
+
+	for(size_t i = 0; i <= ref->size.charCount; i += 1 + i / 16)
+	{
+		u8loc_t a, b;
+		const char *p = u8txt_chr(ref, i, &a);
+		const size_t o = u8edit_chr(ed, i, &b);
+
+		if(! p)
+		{
+			assertUEq(SIZE_MAX, o, " at %zu", i);
+			continue;
+		}
+
+		assertUEq((size_t)(p - want), o, " at %zu", i);
+		assertUEq(a.line, b.line, " at %zu", i);
+		assertUEq(a.column, b.column, " at %zu", i);
+	}
+
+	for(unsigned l = 1; l <= ref->lines + 1; l += 1 + l / 16)
+	{
+		u8size_t a, b;
+		const char *line = u8txt_line(ref, l, &a);
+		const size_t o = u8edit_line(ed, l, &b);
+
+		if(! line)
+		{
+			assertUEq(SIZE_MAX, o, " in line %u", l);
+			continue;
+		}
+
+		assertUEq((size_t)(line - want), o, " in line %u", l);
+		assertUEq(a.byteCount, b.byteCount, " in line %u", l);
+		assertUEq(a.charCount, b.charCount, " in line %u", l);
+
+		for(unsigned c = 0; c <= a.charCount + 1; c += 1 + c / 8)
+		{
+			size_t ia = 0, ib = 0;
+			const char *p = u8txt_unLoc(ref, l, c, &ia);
+			const size_t q = u8edit_unLoc(ed, l, c, &ib);
+
+			assertUEq(p ? (size_t)(p - want) : SIZE_MAX, q, " at %u:%u", l, c);
+			assertUEq(ia, ib, " at %u:%u", l, c);
+		}
+	}
+
+	u8txt_free(ref);
+}
+
+TEST(edit_basic)
+{
+	const char text[] = "Zeile eins\nZw\xC3\xB6lf \xE2\x82\xAC\n";
+	u8file_t f = u8txt_load(text, sizeof(text) - 1, NULL);
+	u8edit_t ed = u8edit_open(f);
+
+	assertIEq(0, u8edit_insertAt(ed, 2, 1, "\xC3\x9C" "ber ", 6));
+	assertIEq(0, u8edit_insertAt(ed, 3, 1, "drei", 4));
+	assertIEq(0, u8edit_deleteAt(ed, 1, 4, 1));
+	checkEditor(ed, "Zeil eins\n\xC3\x9C" "ber Zw\xC3\xB6lf \xE2\x82\xAC\ndrei", 31);
+
+	char buf[8];
+	assertUEq(4, u8edit_read(ed, 27, buf, sizeof(buf)));
+	assertTrue(memcmp(buf, "drei", 4) == 0);
+
+	// offsets within a character and out of bounds are rejected
+	errno = 0;
+	assertIEq(-1, u8edit_insert(ed, 11, "x", 1));
+	assertIEq(EINVAL, errno);
+	assertIEq(-1, u8edit_delete(ed, 0, 32));
+	assertIEq(-1, u8edit_insertAt(ed, 5, 1, "x", 1));
+	checkEditor(ed, "Zeil eins\n\xC3\x9C" "ber Zw\xC3\xB6lf \xE2\x82\xAC\ndrei", 31);
+
+	assertIEq(0, u8edit_deleteAt(ed, 1, 0, SIZE_MAX));
+	checkEditor(ed, "", 0);
+
+	u8edit_free(ed);
+	u8txt_free(f);
+}
+
+/** Checks that incomplete sequences join into characters across edits */
+TEST(edit_join)
+{
+	u8edit_t ed = u8edit_open(NULL);
+	checkEditor(ed, "", 0);
+
+	assertIEq(0, u8edit_insert(ed, 0, "a\xE2", 2));
+	assertIEq(0, u8edit_insert(ed, 2, "\x82\xAC" "b", 3));
+	checkEditor(ed, "a\xE2\x82\xAC" "b", 5);
+	assertUEq(3, u8edit_size(ed).charCount);
+
+	// the joined character can't be split anymore
+	assertIEq(-1, u8edit_insert(ed, 3, "x", 1));
+
+	assertIEq(0, u8edit_insert(ed, 4, "\xC0", 1));
+	assertIEq(0, u8edit_insert(ed, 5, "y", 1));
+	assertIEq(0, u8edit_insert(ed, 6, "\x8A", 1));
+	checkEditor(ed, "a\xE2\x82\xAC\xC0y\x8A" "b", 8);
+	assertUEq(1, u8edit_lines(ed));
+
+	// an overlong newline only forms once the text between is deleted
+	assertIEq(0, u8edit_delete(ed, 5, 6));
+	checkEditor(ed, "a\xE2\x82\xAC\xC0\x8A" "b", 7);
+	assertUEq(2, u8edit_lines(ed));
+
+	// an overlong newline within a piece starts a line like a plain one
+	u8file_t f = u8txt_load("a\xC0\x8A" "bc\xC0\x8A" "d\n" "e", 9, NULL);
+	u8edit_t ov = u8edit_open(f);
+	checkEditor(ov, "a\xC0\x8A" "bc\xC0\x8A" "d\n" "e", 9);
+	assertIEq(0, u8edit_insertAt(ov, 2, 2, "x", 1));
+	assertIEq(0, u8edit_deleteAt(ov, 3, 1, 1));
+	checkEditor(ov, "a\xC0\x8A" "bxc\xC0\x8A" "\n" "e", 9);
+	u8edit_free(ov);
+	u8txt_free(f);
+
+	// a sequence may span more than two pieces
+	assertIEq(0, u8edit_delete(ed, 0, 7));
+	assertIEq(0, u8edit_insert(ed, 0, "\xF0", 1));
+	assertIEq(0, u8edit_insert(ed, 1, "-\x9F", 2));
+	assertIEq(0, u8edit_insert(ed, 3, "\x98", 1));
+	assertIEq(0, u8edit_insert(ed, 4, "-\x80", 2));
+	assertIEq(0, u8edit_delete(ed, 4, 5));
+	checkEditor(ed, "\xF0-\x9F\x98\x80", 5);
+	assertIEq(0, u8edit_delete(ed, 1, 2));
+	checkEditor(ed, "\xF0\x9F\x98\x80", 4);
+	assertUEq(1, u8edit_size(ed).charCount);
+
+	u8edit_free(ed);
+}
+
+/** Checks a big text under random edits against a plain copy */
+TEST(edit_random)
+{
+	const size_t cap = 1 << 20;
+	char *text = malloc(cap), *want = malloc(cap);
+	size_t size = 0;
+
+	if(! text || ! want)
+		testFailure("Malloc failure");
+
+	for(size_t i = 0; size + 64 < cap / 2; ++i)
+		size += sprintf(text + size, "Zeile %zu: \xC3\xA4\xE2\x82\xAC%s", i, i % 5 ? "\n" : " ");
+
+	memcpy(want, text, size);
+	u8file_t f = u8txt_load(text, size, NULL);
+	u8edit_t ed = u8edit_open(f);
+	checkEditor(ed, want, size);
+
+	const char *inserts[] = { "x", "\n", "\xC3\xB6", "\xE2\x82", "\xAC", "\xC0", "\x8A", "Gr\xC3\xBC\xC3\x9F" "e\n", "\xF0\x9F\x98\x80" };
+	srand(1234);
+
+	for(int step = 0; step < 400; ++step)
+	{
+		u8file_t ref = u8txt_load(want, size, NULL);
+		const size_t chars = u8txt_size(ref).charCount;
+		const size_t i = rand() % (chars + 1), j = i + rand() % 40;
+		const char *p = u8txt_chr(ref, i, NULL);
+		const size_t from = p ? (size_t)(p - want) : size;
+		p = u8txt_chr(ref, j, NULL);
+		const size_t to = p ? (size_t)(p - want) : size;
+		u8txt_free(ref);
+
+		if(rand() % 2)
+		{
+			const char *s = inserts[rand() % (sizeof(inserts) / sizeof(*inserts))];
+			const size_t n = strlen(s);
+			assertIEq(0, u8edit_insert(ed, from, s, n), " in step %d", step);
+			memmove(want + from + n, want + from, size - from);
+			memcpy(want + from, s, n);
+			size += n;
+		}
+		else
+		{
+			assertIEq(0, u8edit_delete(ed, from, to), " in step %d", step);
+			memmove(want + from, want + to, size - to);
+			size -= to - from;
+		}
+
+		if(step % 100 == 99)
+			checkEditor(ed, want, size);
+	}
+
+	// a paste bigger than a piece
+	assertIEq(0, u8edit_insert(ed, 0, text, size / 2));
+	memmove(want + size / 2, want, size);
+	memcpy(want, text, size / 2);
+	size += size / 2;
+	checkEditor(ed, want, size);
+
+	u8edit_free(ed);
+	u8txt_free(f);
+	free(text);
+	free(want);
+}
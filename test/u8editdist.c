@@ -0,0 +1,62 @@
+#include "common.h"
+#include "unic.h"
+
+/** Checks the distance to itself and to the empty string */
+TEST(editdist_trivial, str_t, str)
+{
+	assertUEq(0, u8z_editdist(str.bytes, EXACT_BYTES(str.size), str.bytes, EXACT_BYTES(str.size), SIZE_MAX, 0));
+	assertUEq(str.count, u8z_editdist(str.bytes, EXACT_BYTES(str.size), "", NUL_TERMINATED, SIZE_MAX, 0));
+	assertUEq(str.count, u8z_editdist("", NUL_TERMINATED, str.bytes, EXACT_BYTES(str.size), SIZE_MAX, U8DIST_DAMERAU));
+}
+
+TEST(editdist_levenshtein)
+{
+	assertUEq(3, u8_editdist("kitten", "sitting", SIZE_MAX, 0));
+	assertUEq(3, u8_editdist("sitting", "kitten", SIZE_MAX, 0));
+	assertUEq(2, u8_editdist("ab", "ba", SIZE_MAX, 0));
+	// codepoints, not bytes: U+00E4 and U+00F6 share their lead byte
+	assertUEq(1, u8_editdist("b" "\xC3\xA4" "r", "b" "\xC3\xB6" "r", SIZE_MAX, 0));
+	assertUEq(1, u8_editdist("\xF0\x9F\x98\x80", "", SIZE_MAX, 0));
+}
+
+TEST(editdist_damerau)
+{
+	assertUEq(1, u8_editdist("ab", "ba", SIZE_MAX, U8DIST_DAMERAU));
+	assertUEq(1, u8_editdist("\xC3\xA4" "x", "x" "\xC3\xA4", SIZE_MAX, U8DIST_DAMERAU));
+	// optimal string alignment doesn't edit a substring twice
+	assertUEq(3, u8_editdist("ca", "abc", SIZE_MAX, U8DIST_DAMERAU));
+}
+
+TEST(editdist_fold)
+{
+	assertUEq(0, u8_editdist("\xC3\x84" "rger", "\xC3\xA4" "RGER", SIZE_MAX, U8DIST_FOLD));
+	assertUEq(5, u8_editdist("\xC3\x84" "rger", "\xC3\xA4" "RGER", SIZE_MAX, 0));
+	assertUEq(1, u8_editdist("Ab", "bA", SIZE_MAX, U8DIST_FOLD | U8DIST_DAMERAU));
+}
+
+TEST(editdist_bound)
+{
+	assertUEq(3, u8_editdist("kitten", "sitting", 2, 0));
+	assertUEq(3, u8_editdist("kitten", "sitting", 3, 0));
+	assertUEq(1, u8_editdist("a", "abcdefgh", 0, 0));
+	assertUEq(6, u8_editdist("aaaaa", "bbbbbbbbbbbb", 5, 0));
+}
+
+/** Strings longer than a single 64 character block */
+TEST(editdist_blocks)
+{
+	char a[301], b[301];
+
+	for(int i = 0; i < 300; ++i)
+		a[i] = b[i] = 'a' + i % 26;
+
+	a[300] = b[300] = 0;
+	b[0] = b[100] = b[299] = '#';
+	// a swap across the boundary between the first two blocks
+	b[63] = a[64];
+	b[64] = a[63];
+
+	assertUEq(5, u8_editdist(a, b, SIZE_MAX, 0));
+	assertUEq(4, u8_editdist(a, b, SIZE_MAX, U8DIST_DAMERAU));
+	assertUEq(4, u8_editdist(a + 1, b, SIZE_MAX, U8DIST_DAMERAU));
+}
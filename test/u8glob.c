@@ -0,0 +1,108 @@
+#include "common.h"
+#include "unic.h"
+
+/** Compiles a glob and matches a NUL-terminated string against it */
+static bool globMatch(const char *pattern, int flags, const char *str)
+{
+	u8glob_t g = u8glob_compile(pattern, flags);
+	assertTrue(g != NULL, " for pattern '%s'", pattern);
+
+	const int res = u8glob_match(g, str, NUL_TERMINATED);
+	assertTrue(res >= 0, " for pattern '%s'", pattern);
+	u8glob_free(g);
+	return res;
+}
+
+TEST(glob_wildcards)
+{
+	assertTrue(globMatch("*.c", 0, "u8glob.c"));
+	assertTrue(globMatch("*.c", 0, ".c"));
+	assertTrue(! globMatch("*.c", 0, "u8glob.h"));
+	assertTrue(globMatch("a?c", 0, "a" "\xE2\x82\xAC" "c"));
+	assertTrue(! globMatch("a?c", 0, "ac"));
+	assertTrue(globMatch("*a*b*c*", 0, "xxaxxbxxcxx"));
+	assertTrue(globMatch("", 0, ""));
+	assertTrue(! globMatch("", 0, "a"));
+	assertTrue(globMatch("\\*", 0, "*"));
+	assertTrue(! globMatch("\\*", 0, "a"));
+}
+
+TEST(glob_brackets)
+{
+	assertTrue(globMatch("[a-c]x", 0, "bx"));
+	assertTrue(! globMatch("[!a-c]x", 0, "bx"));
+	assertTrue(globMatch("[]]", 0, "]"));
+	assertTrue(globMatch("[" "\xC3\xA0" "-" "\xC3\xBF" "]", 0, "\xC3\xA4"));
+	assertTrue(globMatch("[[:L:]][[:Nd:]]", 0, "\xCE\xB1" "7"));
+	assertTrue(! globMatch("[[:L:]][[:Nd:]]", 0, "7" "\xCE\xB1"));
+	assertTrue(globMatch("[[:Uppercase_Letter:]]*", 0, "\xC3\x84" "rger"));
+	assertTrue(globMatch("[[:space:]]", 0, "\xE3\x80\x80"));
+	assertTrue(globMatch("[[:word:]]*", 0, "_\xC3\xA4" "7"));
+}
+
+TEST(glob_malformed)
+{
+	assertTrue(u8glob_compile("[abc", 0) == NULL);
+	assertTrue(u8glob_compile("[[:nope:]]", 0) == NULL);
+	assertTrue(u8glob_compile("[z-a]", 0) == NULL);
+	assertTrue(u8glob_compile("abc\\", 0) == NULL);
+}
+
+TEST(glob_fold)
+{
+	assertTrue(globMatch("*.TXT", U8GLOB_FOLD, "readme.txt"));
+	assertTrue(globMatch("\xC3\x84" "rger", U8GLOB_FOLD, "\xC3\xA4" "RGER"));
+	assertTrue(! globMatch("\xC3\x84" "rger", 0, "\xC3\xA4" "rger"));
+	assertTrue(globMatch("[a-z]", U8GLOB_FOLD, "Q"));
+	// KELVIN SIGN lowercases to 'k'
+	assertTrue(globMatch("k", U8GLOB_FOLD, "\xE2\x84\xAA"));
+}
+
+TEST(glob_pathname)
+{
+	assertTrue(globMatch("/api/*", U8GLOB_PATHNAME, "/api/users"));
+	assertTrue(! globMatch("/api/*", U8GLOB_PATHNAME, "/api/users/1"));
+	assertTrue(globMatch("/api/**", U8GLOB_PATHNAME, "/api/users/1"));
+	assertTrue(! globMatch("a?b", U8GLOB_PATHNAME, "a/b"));
+	assertTrue(globMatch("/api/*", 0, "/api/users/1"));
+}
+
+/** Patterns that need more than one word of states, and would make a backtracking matcher explode */
+TEST(glob_long)
+{
+	char pattern[301], str[301];
+
+	for(int i = 0; i < 100; ++i)
+		memcpy(pattern + 3*i, "*a?", 3);
+
+	pattern[300] = 0;
+	memset(str, 'a', 300);
+	str[300] = 0;
+
+	assertTrue(globMatch(pattern, 0, str));
+	str[299] = 'b';
+	assertTrue(globMatch(pattern, 0, str));
+	memset(str, 'b', 200);
+	assertTrue(! globMatch(pattern, 0, str));
+}
+
+/** Every string matches itself when escaped */
+TEST(glob_literal, str_t, str)
+{
+	char pattern[2 * str.size + 1];
+	size_t n = 0;
+
+	for(size_t i = 0; i < str.size; ++i)
+	{
+		if(str.bytes[i] == '*' || str.bytes[i] == '?' || str.bytes[i] == '[' || str.bytes[i] == '\\')
+			pattern[n++] = '\\';
+
+		pattern[n++] = str.bytes[i];
+	}
+
+	pattern[n] = 0;
+	u8glob_t g = u8glob_compile(pattern, 0);
+	assertTrue(g != NULL);
+	assertIEq(1, u8glob_match(g, str.bytes, EXACT_BYTES(str.size)));
+	u8glob_free(g);
+}
@@ -0,0 +1,92 @@
+#include "common.h"
+#include "unic.h"
+
+/** Checks that clusters never split a string's characters and cover it exactly */
+TEST(grapheme_cover, str_t, str)
+{
+	size_t bytes = 0, chars = 0, count = 0;
+
+	while(bytes < str.size)
+	{
+		const u8size_t g = u8z_next_grapheme(str.bytes + bytes, EXACT_BYTES(str.size - bytes));
+		assertTrue(g.byteCount > 0);
+		bytes += g.byteCount;
+		chars += g.charCount;
+		++count;
+	}
+
+	assertUEq(str.size, bytes);
+	assertUEq(str.count, chars);
+	assertUEq(count, u8z_grapheme_count(str.bytes, EXACT_BYTES(str.size)));
+}
+
+TEST(grapheme_ascii)
+{
+	assertUEq(0, u8_grapheme_count(""));
+	assertUEq(0, u8_next_grapheme("").byteCount);
+	assertUEq(5, u8_grapheme_count("hello"));
+	assertUEq(1, u8_next_grapheme("hello").byteCount);
+	// CR LF is a single cluster
+	assertUEq(2, u8_next_grapheme("\r\nx").byteCount);
+	assertUEq(1, u8_next_grapheme("\n\rx").byteCount);
+	assertUEq(12, u8_grapheme_count("line one\r\n" "\r\n" "\r" "\n\n"));
+	assertUEq(40, u8_grapheme_count("a long line of plain ascii text\r\nand more"));
+}
+
+TEST(grapheme_combining)
+{
+	// e + COMBINING ACUTE ACCENT + COMBINING DIAERESIS
+	assertUEq(5, u8_next_grapheme("e" "\xCC\x81\xCC\x88" "x").byteCount);
+	assertUEq(3, u8_next_grapheme("e" "\xCC\x81\xCC\x88" "x").charCount);
+	assertUEq(2, u8_grapheme_count("e" "\xCC\x81\xCC\x88" "x"));
+	// a mark after a long ASCII run joins its last character
+	assertUEq(20, u8_grapheme_count("twenty ascii letter" "s" "\xCC\x81"));
+	// a mark after a control character stands alone
+	assertUEq(2, u8_grapheme_count("\n" "\xCC\x81"));
+	// HANGUL CHOSEONG KIYEOK, JUNGSEONG A and JONGSEONG KIYEOK form a syllable
+	assertUEq(1, u8_grapheme_count("\xE1\x84\x80\xE1\x85\xA1\xE1\x86\xA8"));
+}
+
+TEST(grapheme_emoji)
+{
+	// MAN, ZWJ, WOMAN, ZWJ, GIRL
+	const char *family = "\xF0\x9F\x91\xA8\xE2\x80\x8D\xF0\x9F\x91\xA9\xE2\x80\x8D\xF0\x9F\x91\xA7";
+	assertUEq(18, u8_next_grapheme(family).byteCount);
+	assertUEq(1, u8_grapheme_count(family));
+	// HEAVY BLACK HEART, VARIATION SELECTOR-16, ZWJ, FIRE
+	assertUEq(1, u8_grapheme_count("\xE2\x9D\xA4\xEF\xB8\x8F\xE2\x80\x8D\xF0\x9F\x94\xA5"));
+	// a ZWJ without a preceding pictograph doesn't join
+	assertUEq(2, u8_grapheme_count("a" "\xE2\x80\x8D\xF0\x9F\x94\xA5"));
+	// THUMBS UP with a skin tone modifier
+	assertUEq(1, u8_grapheme_count("\xF0\x9F\x91\x8D\xF0\x9F\x8F\xBD"));
+}
+
+TEST(grapheme_flags)
+{
+	// regional indicators pair up: DE, FR, and a lone U
+	const char *flags = "\xF0\x9F\x87\xA9\xF0\x9F\x87\xAA" "\xF0\x9F\x87\xAB\xF0\x9F\x87\xB7" "\xF0\x9F\x87\xBA";
+	assertUEq(3, u8_grapheme_count(flags));
+	assertUEq(8, u8_next_grapheme(flags).byteCount);
+	assertUEq(4, u8_next_grapheme(flags + 16).byteCount);
+}
+
+#if UNIC_VERSION >= 1510
+/** Checks GB9c with cases from GraphemeBreakTest.txt */
+TEST(grapheme_conjunct)
+{
+	// KA, VIRAMA, SSA
+	assertUEq(9, u8_next_grapheme("\xE0\xA4\x95\xE0\xA5\x8D\xE0\xA4\xB7").byteCount);
+	// KA, VIRAMA, ZWJ, TA and KA, NUKTA, ZWJ, VIRAMA, TA
+	assertUEq(1, u8_grapheme_count("\xE0\xA4\x95\xE0\xA5\x8D\xE2\x80\x8D\xE0\xA4\xA4"));
+	assertUEq(1, u8_grapheme_count("\xE0\xA4\x95\xE0\xA4\xBC\xE2\x80\x8D\xE0\xA5\x8D\xE0\xA4\xA4"));
+	// KA, VIRAMA, TA, VIRAMA, YA and KA, VIRAMA, VIRAMA, TA
+	assertUEq(1, u8_grapheme_count("\xE0\xA4\x95\xE0\xA5\x8D\xE0\xA4\xA4\xE0\xA5\x8D\xE0\xA4\xAF"));
+	assertUEq(1, u8_grapheme_count("\xE0\xA4\x95\xE0\xA5\x8D\xE0\xA5\x8D\xE0\xA4\xA4"));
+	// a virama only links consonants
+	assertUEq(2, u8_grapheme_count("\xE0\xA4\x95\xE0\xA5\x8D" "a"));
+	assertUEq(2, u8_grapheme_count("a" "\xE0\xA5\x8D\xE0\xA4\xA4"));
+	assertUEq(2, u8_grapheme_count("?" "\xE0\xA5\x8D\xE0\xA4\xA4"));
+	// a consonant without a virama doesn't join
+	assertUEq(2, u8_grapheme_count("\xE0\xA4\x95\xE0\xA4\xBC\xE0\xA4\xA4"));
+}
+#endif
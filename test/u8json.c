@@ -0,0 +1,121 @@
+#include "common.h"
+#include "unic.h"
+
+/** Checks that escaping a string produces exactly the given result */
+static void assertEscape(const char *str, size_t size, const char *expect)
+{
+	char out[128];
+	const u8size_t n = u8z_json_escape(str, EXACT_BYTES(size), out, sizeof(out), true);
+
+	assertTrue(n.bytesExact);
+	assertUEq(strlen(expect) + 1, n.byteCount);
+	assertUEq(u8_strlen(expect), n.charCount);
+	assertSEq(expect, out);
+}
+
+/** Checks that unescaping a string produces exactly the given result */
+static void assertUnescape(const char *str, const char *expect)
+{
+	char out[128];
+	const u8size_t n = u8_json_unescape(str, out, sizeof(out), true);
+
+	assertTrue(n.bytesExact);
+	assertUEq(strlen(expect) + 1, n.byteCount);
+	assertUEq(u8_strlen(expect), n.charCount);
+	assertSEq(expect, out);
+}
+
+/** Checks that unescaping an escaped string reproduces it */
+TEST(json_round_trip, str_t, str)
+{
+	const u8size_t n = u8z_json_escape(str.bytes, EXACT_BYTES(str.size), NULL, SIZE_MAX, false);
+	char *esc = malloc(n.byteCount + 1), *back = malloc(str.size + 1);
+
+	assertUEq(n.byteCount, u8z_json_escape(str.bytes, EXACT_BYTES(str.size), esc, n.byteCount, false).byteCount);
+
+	const u8size_t m = u8z_json_unescape(esc, EXACT_BYTES(n.byteCount), back, str.size, false);
+	assertTrue(m.bytesExact);
+	assertUEq(str.size, m.byteCount);
+	assertUEq(str.count, m.charCount);
+	assertTrue(memcmp(str.bytes, back, str.size) == 0);
+
+	free(esc);
+	free(back);
+}
+
+TEST(json_escape)
+{
+	assertEscape("plain text that is longer than a vector", 39, "plain text that is longer than a vector");
+	assertEscape("say \"hi\"\\n\n\ttab\r\b\f", 18, "say \\\"hi\\\"\\\\n\\n\\ttab\\r\\b\\f");
+	// other control characters, including NUL, have no short form
+	assertEscape("a\0b\x1F\x7F", 5, "a\\u0000b\\u001F\x7F");
+	assertEscape("a" UNUL, 3, "a\\u0000");
+	// non-ASCII characters are kept, an encoded surrogate is replaced
+	assertEscape("\xC3\xA9\xF0\x9F\x98\x80/\xED\xA0\x80", 10, "\xC3\xA9\xF0\x9F\x98\x80/\xEF\xBF\xBD");
+}
+
+TEST(json_unescape)
+{
+	assertUnescape("say \\\"hi\\\"\\\\n\\n\\ttab\\r\\b\\f\\/", "say \"hi\"\\n\n\ttab\r\b\f/");
+	// GRINNING FACE as a surrogate pair, in either case
+	assertUnescape("\\u00e9\\uD83D\\uDE00\\ud83d\\ude00", "\xC3\xA9\xF0\x9F\x98\x80\xF0\x9F\x98\x80");
+	// unpaired surrogates
+	assertUnescape("\\uD83Dx\\uDE00\\uD83D", "\xEF\xBF\xBDx\xEF\xBF\xBD\xEF\xBF\xBD");
+	// malformed escapes are kept
+	assertUnescape("\\q\\u12\\u12G4\\", "\\q\\u12\\u12G4\\");
+	// NULs are over-encoded in NUL-terminated output
+	assertUnescape("a\\u0000b", "a" UNUL "b");
+}
+
+TEST(json_sized)
+{
+	char out[16];
+
+	// the escape doesn't fit
+	u8size_t n = u8_json_escape("ab\"", out, 4, true);
+	assertTrue(! n.bytesExact);
+	assertUEq(3, n.byteCount);
+	assertSEq("ab", out);
+
+	// a surrogate pair cut off by the size is unpaired, and what remains of the second escape is kept
+	assertUEq(5, u8z_json_unescape("\\uD83D\\uDE00", MAX_BYTES(8), NULL, SIZE_MAX, false).byteCount);
+	assertUEq(4, u8z_json_unescape("\\uD83D\\uDE00", MAX_CHARS(12), NULL, SIZE_MAX, false).byteCount);
+	assertUEq(2, u8z_json_unescape("a\\n", EXACT_BYTES(2), out, sizeof(out), false).byteCount);
+	assertTrue(memcmp(out, "a\\", 2) == 0);
+}
+
+/** Long runs of non-ASCII characters are kept as-is, but still sized and cut off per character */
+TEST(json_multibyte)
+{
+	static const char word[] = "\xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82 \xE4\xB8\x96\xE7\x95\x8C \xF0\x9F\x98\x80 ";
+	const size_t reps = 200, len = sizeof(word) - 1;
+	char *str = malloc(reps * len + 1), *out = malloc(reps * len + 1);
+
+	for(size_t i = 0; i < reps; ++i)
+		memcpy(str + i * len, word, len);
+	str[reps * len] = 0;
+
+	u8size_t n = u8_json_escape(str, out, reps * len + 1, true);
+	assertTrue(n.bytesExact);
+	assertUEq(reps * len + 1, n.byteCount);
+	assertUEq(reps * u8_strlen(word), n.charCount);
+	assertSEq(str, out);
+
+	n = u8_json_unescape(str, out, reps * len + 1, true);
+	assertTrue(n.bytesExact);
+	assertUEq(reps * len + 1, n.byteCount);
+	assertSEq(str, out);
+
+	// a character that doesn't fit isn't split
+	n = u8z_json_escape(str, EXACT_BYTES(reps * len), out, 5, false);
+	assertTrue(! n.bytesExact);
+	assertUEq(4, n.byteCount);
+	assertUEq(2, n.charCount);
+	assertUEq(6, u8z_json_unescape(str, MAX_CHARS(3), NULL, SIZE_MAX, false).byteCount);
+
+	free(str);
+	free(out);
+
+	// overlong encodings within a run are decoded, even if that makes them need an escape
+	assertEscape("\xC3\xA9\xC0\xA2\xC3\xA9\xE0\x80\x8A", 9, "\xC3\xA9\\\"\xC3\xA9\\n");
+}
@@ -0,0 +1,115 @@
+#include "common.h"
+#include "unic.h"
+
+typedef u8size_t (*norm_f)(const char *str, u8size_t size, u8buf_t *buf);
+
+/** Checks that normalizing a string produces exactly the given result */
+static void assertNorm(norm_f f, const char *str, const char *expect)
+{
+	char arena[8];
+	u8buf_t buf = u8buf_init(arena, sizeof(arena), true);
+	const u8size_t n = f(str, NUL_TERMINATED, &buf);
+
+	assertTrue(n.bytesExact);
+	assertUEq(strlen(expect), n.byteCount);
+	assertUEq(u8_strlen(expect), n.charCount);
+
+	char *res = u8buf_finish(&buf, NULL);
+	assertSEq(expect, res);
+
+	if(res != arena)
+		free(res);
+}
+
+/** Checks that every normalization form is idempotent */
+TEST(norm_idempotent, str_t, str)
+{
+	norm_f forms[] = { u8z_nfd, u8z_nfkd, u8z_nfc, u8z_nfkc };
+
+	for(size_t i = 0; i < sizeof(forms) / sizeof(*forms); ++i)
+	{
+		u8buf_t once = u8buf_init(NULL, 0, false), twice = u8buf_init(NULL, 0, false);
+		assertTrue(forms[i](str.bytes, EXACT_BYTES(str.size), &once).bytesExact);
+		assertTrue(forms[i](once.bytes, EXACT_BYTES(once.byteCount), &twice).bytesExact);
+
+		assertUEq(once.byteCount, twice.byteCount);
+		assertTrue(memcmp(once.bytes, twice.bytes, once.byteCount) == 0);
+
+		u8buf_free(&once);
+		u8buf_free(&twice);
+	}
+}
+
+TEST(norm_composition)
+{
+	// precomposed and decomposed e with acute
+	assertNorm(u8z_nfc, "caf" "e\xCC\x81", "caf" "\xC3\xA9");
+	assertNorm(u8z_nfc, "caf" "\xC3\xA9", "caf" "\xC3\xA9");
+	assertNorm(u8z_nfd, "caf" "\xC3\xA9", "caf" "e\xCC\x81");
+	// ANGSTROM SIGN is a singleton decomposition
+	assertNorm(u8z_nfc, "\xE2\x84\xAB", "\xC3\x85");
+	// d with COMBINING DOT ABOVE and COMBINING DOT BELOW in either order
+	assertNorm(u8z_nfc, "d\xCC\x87\xCC\xA3", "\xE1\xB8\x8D\xCC\x87");
+	assertNorm(u8z_nfc, "d\xCC\xA3\xCC\x87", "\xE1\xB8\x8D\xCC\x87");
+	assertNorm(u8z_nfd, "\xE1\xB8\x8B\xCC\xA3", "d\xCC\xA3\xCC\x87");
+	// a mark blocked by one of the same class doesn't compose
+	assertNorm(u8z_nfc, "a\xCC\x81\xCC\x81", "\xC3\xA1\xCC\x81");
+}
+
+TEST(norm_hangul)
+{
+	// HANGUL SYLLABLE GAG and its jamo
+	assertNorm(u8z_nfd, "\xEA\xB0\x81", "\xE1\x84\x80\xE1\x85\xA1\xE1\x86\xA8");
+	assertNorm(u8z_nfc, "\xE1\x84\x80\xE1\x85\xA1\xE1\x86\xA8", "\xEA\xB0\x81");
+	// HANGUL SYLLABLE GA followed by a trailing consonant
+	assertNorm(u8z_nfc, "\xEA\xB0\x80\xE1\x86\xA8", "\xEA\xB0\x81");
+}
+
+TEST(norm_compatibility)
+{
+	assertNorm(u8z_nfkc, "\xEF\xAC\x81" "le x" "\xC2\xB2", "file x2");
+	assertNorm(u8z_nfc, "\xEF\xAC\x81" "le x" "\xC2\xB2", "\xEF\xAC\x81" "le x" "\xC2\xB2");
+	// LATIN SMALL LETTER LONG S WITH DOT ABOVE
+	assertNorm(u8z_nfkc, "\xE1\xBA\x9B", "\xE1\xB9\xA1");
+	assertNorm(u8z_nfkd, "\xE1\xBA\x9B", "s\xCC\x87");
+	assertNorm(u8z_nfc, "\xE1\xBA\x9B", "\xE1\xBA\x9B");
+	// HALFWIDTH KATAKANA LETTER KA and a halfwidth voiced sound mark
+	assertNorm(u8z_nfkc, "\xEF\xBD\xB6\xEF\xBE\x9E", "\xE3\x82\xAC");
+}
+
+TEST(norm_encoding)
+{
+	// over-encoded characters are re-encoded
+	assertNorm(u8z_nfc, "x" "\xC1\x81" "y", "xAy");
+	assertNorm(u8z_nfc, "x" "\xE0\x83\xA9", "x" "\xC3\xA9");
+	// NULs stay over-encoded in NUL-terminated buffers
+	assertNorm(u8z_nfc, "a" UNUL "b", "a" UNUL "b");
+
+	u8buf_t buf = u8buf_init(NULL, 0, false);
+	assertUEq(3, u8z_nfc("a\0b", EXACT_BYTES(3), &buf).byteCount);
+	assertUEq(3, u8z_nfc("a" UNUL "b", NUL_TERMINATED, &buf).byteCount);
+	assertTrue(memcmp(buf.bytes, "a\0ba\0b", 6) == 0);
+	u8buf_free(&buf);
+}
+
+TEST(norm_long_runs)
+{
+	// more combining marks than fit the local storage, in reverse canonical order
+	char str[1 + 2 * 2 * 40 + 1] = "a";
+	char expect[sizeof(str)] = "a";
+
+	for(int i = 0; i < 40; ++i)
+	{
+		memcpy(str + 1 + 4 * i, "\xCC\x81\xCC\xA3", 4);
+		memcpy(expect + 1 + 2 * i, "\xCC\xA3", 2);
+		memcpy(expect + 1 + 80 + 2 * i, "\xCC\x81", 2);
+	}
+
+	str[sizeof(str) - 1] = 0;
+	expect[sizeof(expect) - 1] = 0;
+	assertNorm(u8z_nfd, str, expect);
+
+	// LATIN SMALL LETTER A WITH DOT BELOW absorbs the first dot below
+	memcpy(expect, "\xE1\xBA\xA1", 3);
+	assertNorm(u8z_nfc, str, expect);
+}
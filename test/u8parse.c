@@ -0,0 +1,110 @@
+#include "common.h"
+#include "unic.h"
+#include <errno.h>
+
+TEST(digit_values)
+{
+	assertIEq(0, uchar_digit('0'));
+	assertIEq(9, uchar_digit('9'));
+	assertIEq(-1, uchar_digit('a'));
+	assertIEq(-1, uchar_digit('/'));
+	// ARABIC-INDIC, DEVANAGARI and FULLWIDTH digits
+	assertIEq(4, uchar_digit(0x0664));
+	assertIEq(7, uchar_digit(0x096D));
+	assertIEq(9, uchar_digit(0xFF19));
+	assertIEq(-1, uchar_digit(0xFF1A));
+	// MATHEMATICAL BOLD DIGIT ZERO, and a letter right before it
+	assertIEq(0, uchar_digit(0x1D7CE));
+	assertIEq(-1, uchar_digit(0x1D7CB));
+	// SUPERSCRIPT TWO and VULGAR FRACTION ONE HALF are numbers, but no decimal digits
+	assertIEq(-1, uchar_digit(0xB2));
+	assertIEq(-1, uchar_digit(0xBD));
+}
+
+/** Checks that every decimal digit has a value */
+TEST(digit_category, struct Codepoint, chr)
+{
+	if(chr.category == UCLASS_DECIMAL_NUMBER)
+		assertTrue(uchar_digit(chr.codepoint) >= 0);
+	else
+		assertIEq(-1, uchar_digit(chr.codepoint));
+}
+
+TEST(parse_u64)
+{
+	uint64_t v;
+	const char *s = "12345 apples";
+
+	assertTrue(u8_parse_u64(s, &v) == s + 5);
+	assertUEq(12345, v);
+
+	s = "+0000000000000000000000000000018446744073709551615";
+	assertTrue(u8_parse_u64(s, &v) == s + strlen(s));
+	assertUEq(UINT64_MAX, v);
+
+	errno = 0;
+	assertTrue(u8_parse_u64("18446744073709551616", &v) == NULL);
+	assertIEq(ERANGE, errno);
+	assertTrue(u8_parse_u64("99999999999999999999999", &v) == NULL);
+	assertIEq(ERANGE, errno);
+
+	errno = 0;
+	assertTrue(u8_parse_u64("", &v) == NULL);
+	assertIEq(EINVAL, errno);
+	assertTrue(u8_parse_u64("-1", &v) == NULL);
+	assertTrue(u8_parse_u64("+", &v) == NULL);
+	assertTrue(u8_parse_u64(" 1", &v) == NULL);
+
+	// sized prefixes
+	assertTrue(u8z_parse_u64("123456789", MAX_CHARS(4), &v) != NULL);
+	assertUEq(1234, v);
+	assertTrue(u8z_parse_u64("12\0" "34", EXACT_BYTES(5), &v) != NULL);
+	assertUEq(12, v);
+}
+
+TEST(parse_scripts)
+{
+	uint64_t v;
+	// ARABIC-INDIC 2024
+	const char *s = "\xD9\xA2\xD9\xA0\xD9\xA2\xD9\xA4/";
+	assertTrue(u8_parse_u64(s, &v) == s + 8);
+	assertUEq(2024, v);
+
+	// FULLWIDTH 1, 0, 5
+	s = "\xEF\xBC\x91\xEF\xBC\x90\xEF\xBC\x95";
+	assertTrue(u8_parse_u64(s, &v) == s + 9);
+	assertUEq(105, v);
+
+	// DEVANAGARI 3 followed by an ASCII 3, and the other way around
+	errno = 0;
+	assertTrue(u8_parse_u64("\xE0\xA5\xA9" "3", &v) == NULL);
+	assertIEq(EINVAL, errno);
+	assertTrue(u8_parse_u64("3" "\xE0\xA5\xA9", &v) == NULL);
+	assertTrue(u8_parse_u64("12345678901234567890" "\xE0\xA5\xA9", &v) == NULL);
+}
+
+TEST(parse_i64)
+{
+	int64_t v;
+
+	assertTrue(u8_parse_i64("-42", &v) != NULL);
+	assertIEq(-42, v);
+	assertTrue(u8_parse_i64("+42", &v) != NULL);
+	assertIEq(42, v);
+	// U+2212 MINUS SIGN
+	assertTrue(u8_parse_i64("\xE2\x88\x92" "7", &v) != NULL);
+	assertIEq(-7, v);
+	assertTrue(u8_parse_i64("-0", &v) != NULL);
+	assertIEq(0, v);
+
+	assertTrue(u8_parse_i64("9223372036854775807", &v) != NULL);
+	assertTrue(v == INT64_MAX);
+	assertTrue(u8_parse_i64("-9223372036854775808", &v) != NULL);
+	assertTrue(v == INT64_MIN);
+
+	errno = 0;
+	assertTrue(u8_parse_i64("9223372036854775808", &v) == NULL);
+	assertIEq(ERANGE, errno);
+	assertTrue(u8_parse_i64("-9223372036854775809", &v) == NULL);
+	assertTrue(u8_parse_i64("--1", &v) == NULL);
+}
@@ -0,0 +1,133 @@
+#include "common.h"
+#include <errno.h>
+#include "unic.h"
+#include "u8text.h"
+
+/** Searches a NUL-terminated string and checks the span of the match */
+static void assertSearch(const char *pattern, int flags, const char *str, long start, size_t len)
+{
+	u8regex_t re = u8regex_compile(pattern, flags);
+	assertTrue(re != NULL, " for pattern '%s'", pattern);
+
+	size_t l = 0;
+	const char *m = u8regex_search(re, str, NUL_TERMINATED, &l);
+	u8regex_free(re);
+
+	if(start < 0)
+		assertTrue(m == NULL, " for /%s/ in '%s'", pattern, str);
+	else
+	{
+		assertTrue(m != NULL, " for /%s/ in '%s'", pattern, str);
+		assertIEq(start, m - str, " for /%s/ in '%s'", pattern, str);
+		assertUEq(len, l, " for /%s/ in '%s'", pattern, str);
+	}
+}
+
+static bool fullMatch(const char *pattern, int flags, const char *str)
+{
+	u8regex_t re = u8regex_compile(pattern, flags);
+	assertTrue(re != NULL, " for pattern '%s'", pattern);
+
+	const bool res = u8regex_match(re, str, NUL_TERMINATED);
+	u8regex_free(re);
+	return res;
+}
+
+TEST(regex_leftmost_longest)
+{
+	assertSearch("a+", 0, "baaab", 1, 3);
+	assertSearch("abcd|c", 0, "abcd", 0, 4);
+	assertSearch("(a|ab)(c|bcd)", 0, "xabcd", 1, 4);
+	assertSearch("x*", 0, "abc", 0, 0);
+	assertSearch("b{2,3}", 0, "abbbbb", 1, 3);
+	assertSearch("z", 0, "abc", -1, 0);
+}
+
+TEST(regex_anchors)
+{
+	assertSearch("^ab", 0, "abab", 0, 2);
+	assertSearch("^b", 0, "abab", -1, 0);
+	assertSearch("ab$", 0, "abab", 2, 2);
+	assertSearch("^(ab)*$", 0, "abab", 0, 4);
+	assertSearch("^a$", 0, "ab", -1, 0);
+	assertTrue(u8regex_compile("^a|b", 0) == NULL);
+	assertTrue(u8regex_compile("a$|b", 0) == NULL);
+}
+
+TEST(regex_categories)
+{
+	// GREEK SMALL LETTER ALPHA, ARABIC-INDIC DIGIT SEVEN
+	assertSearch("\\p{L}+\\p{Nd}", 0, "-- " "\xCE\xB1" "b" "\xD9\xA7" " --", 3, 5);
+	assertSearch("\\P{L}+", 0, "ab12cd", 2, 2);
+	assertSearch("[[:Lu:]][[:Ll:]]+", 0, "xx " "\xC3\x84" "rger", 3, 6);
+	assertSearch("\\d+", 0, "abc 2024", 4, 4);
+	assertSearch("\\s+", 0, "a" "\xE3\x80\x80" " b", 1, 4);
+	assertTrue(fullMatch("\\w+", 0, "na" "\xC3\xAF" "ve_2"));
+	assertTrue(! fullMatch("\\w+", 0, "a-b"));
+}
+
+TEST(regex_icase)
+{
+	assertTrue(fullMatch("stra(ss|" "\xC3\x9F" ")e", U8RE_ICASE, "STRASSE"));
+	assertTrue(fullMatch("\xC3\xA4" "rger", U8RE_ICASE, "\xC3\x84" "RGER"));
+	assertTrue(! fullMatch("\xC3\xA4" "rger", 0, "\xC3\x84" "RGER"));
+	assertTrue(fullMatch("[a-c]+", U8RE_ICASE, "AbC"));
+}
+
+TEST(regex_syntax)
+{
+	assertTrue(fullMatch("a.c", 0, "a" "\xE2\x82\xAC" "c"));
+	assertTrue(! fullMatch("a.c", 0, "a\nc"));
+	assertTrue(fullMatch("a.c", U8RE_DOTALL, "a\nc"));
+	assertTrue(fullMatch("\\x{20AC}\\x41", 0, "\xE2\x82\xAC" "A"));
+	assertTrue(fullMatch("(?:ab){2}c?", 0, "abab"));
+	assertTrue(fullMatch("[]a-]+", 0, "]-a"));
+	assertTrue(fullMatch("\\.\\*", 0, ".*"));
+
+	const char *bad[] = { "(a", "a)", "*a", "a**", "[a", "\\p{Nope}", "a{3,1}", "\\q", "[z-a]", "\\x{110000}", "\\x{100000041}" };
+
+	for(size_t i = 0; i < sizeof(bad) / sizeof(*bad); ++i)
+		assertTrue(u8regex_compile(bad[i], 0) == NULL, " for pattern '%s'", bad[i]);
+
+	errno = 0;
+	assertTrue(u8regex_compile("\\x{FFFFFFFF41}", 0) == NULL);
+	assertIEq(EINVAL, errno);
+}
+
+/** Patterns that make backtracking engines explode */
+TEST(regex_linear)
+{
+	char str[101];
+	memset(str, 'a', 100);
+	str[100] = 0;
+
+	assertTrue(! fullMatch("(a*)*b", 0, str));
+	assertTrue(! fullMatch("(a|aa)*b", 0, str));
+	assertSearch("(a|a)*$", 0, str, 0, 100);
+}
+
+TEST(regex_file)
+{
+	static const char text[] = "first line\nsecond l" "\xC3\xAF" "ne\nthird";
+	u8file_t f = u8txt_load(text, sizeof(text) - 1, NULL);
+	u8regex_t re = u8regex_compile("l\\p{L}ne", 0);
+	assertTrue(f && re);
+
+	size_t len;
+	const char *m = u8txt_search(f, re, NULL, &len);
+	assertPEq(text + 6, m);
+	assertUEq(4, len);
+
+	m = u8txt_search(f, re, m + len, &len);
+	assertPEq(text + 18, m);
+	assertUEq(5, len);
+
+	u8loc_t loc;
+	assertIEq(0, u8txt_loc(f, m, &loc));
+	assertUEq(2, loc.line);
+
+	assertTrue(u8txt_search(f, re, m + len, &len) == NULL);
+
+	u8regex_free(re);
+	u8txt_free(f);
+}
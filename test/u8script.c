@@ -0,0 +1,111 @@
+#include "common.h"
+#include "unic.h"
+
+TEST(script_lookup)
+{
+	assertIEq(USCRIPT_LATIN, uchar_script('a'));
+	assertIEq(USCRIPT_COMMON, uchar_script(' '));
+	assertIEq(USCRIPT_COMMON, uchar_script('1'));
+	assertIEq(USCRIPT_GREEK, uchar_script(0x3B1));
+	assertIEq(USCRIPT_CYRILLIC, uchar_script(0x416));
+	assertIEq(USCRIPT_ARABIC, uchar_script(0x627));
+	assertIEq(USCRIPT_HAN, uchar_script(0x4E00));
+	assertIEq(USCRIPT_HAN, uchar_script(0x20000));
+	assertIEq(USCRIPT_HIRAGANA, uchar_script(0x3042));
+	// COMBINING ACUTE ACCENT
+	assertIEq(USCRIPT_INHERITED, uchar_script(0x301));
+	assertIEq(USCRIPT_UNKNOWN, uchar_script(0x378));
+	assertIEq(USCRIPT_UNKNOWN, uchar_script(0x110000));
+	assertIEq(USCRIPT_LATN, USCRIPT_LATIN);
+}
+
+TEST(script_extensions)
+{
+	// DEVANAGARI DANDA is used by many Indic scripts
+	assertIEq(USCRIPT_COMMON, uchar_script(0x964));
+	assertTrue(uchar_hasScript(0x964, USCRIPT_DEVANAGARI));
+	assertTrue(uchar_hasScript(0x964, USCRIPT_BENGALI));
+	assertTrue(!uchar_hasScript(0x964, USCRIPT_LATIN));
+	assertTrue(!uchar_hasScript(0x964, USCRIPT_COMMON));
+	// characters without extensions have just their script
+	assertTrue(uchar_hasScript('a', USCRIPT_LATIN));
+	assertTrue(!uchar_hasScript('a', USCRIPT_GREEK));
+}
+
+/** Records up to 8 runs */
+struct Runs
+{
+	unsigned n;
+	size_t bytes[8], chars[8];
+	enum unic_script scripts[8];
+};
+
+static int record(const char *run, u8size_t size, enum unic_script script, void *ctx)
+{
+	(void)run;
+	struct Runs *r = ctx;
+
+	if(r->n == 8)
+		return 1;
+
+	r->bytes[r->n] = size.byteCount;
+	r->chars[r->n] = size.charCount;
+	r->scripts[r->n++] = script;
+	return 0;
+}
+
+TEST(script_runs)
+{
+	struct Runs r = { 0 };
+	// "Hello, Ελλάδα! Привет" with a combining accent after the first Greek letter
+	assertIEq(0, u8_script_runs("Hello, " "\xCE\x95\xCC\x81\xCE\xBB\xCE\xBB\xCE\xAC\xCE\xB4\xCE\xB1" "! " "\xD0\x9F\xD1\x80\xD0\xB8", record, &r));
+
+	assertUEq(3, r.n);
+	assertIEq(USCRIPT_LATIN, r.scripts[0]);
+	assertUEq(7, r.bytes[0]);
+	assertIEq(USCRIPT_GREEK, r.scripts[1]);
+	assertUEq(9, r.chars[1]);
+	assertIEq(USCRIPT_CYRILLIC, r.scripts[2]);
+	assertUEq(3, r.chars[2]);
+	assertUEq(6, r.bytes[2]);
+}
+
+TEST(script_runs_shared)
+{
+	struct Runs r = { 0 };
+	assertIEq(0, u8_script_runs("", record, &r));
+	assertUEq(0, r.n);
+
+	// only common characters
+	assertIEq(0, u8_script_runs("12, 34.", record, &r));
+	assertUEq(1, r.n);
+	assertIEq(USCRIPT_COMMON, r.scripts[0]);
+
+	// DEVANAGARI LETTER KA, DANDA, BENGALI LETTER KA: the danda joins the first run
+	r.n = 0;
+	assertIEq(0, u8_script_runs("\xE0\xA4\x95\xE0\xA5\xA4\xE0\xA6\x95", record, &r));
+	assertUEq(2, r.n);
+	assertIEq(USCRIPT_DEVANAGARI, r.scripts[0]);
+	assertUEq(2, r.chars[0]);
+	assertIEq(USCRIPT_BENGALI, r.scripts[1]);
+
+	// a leading danda is resolved by what follows
+	r.n = 0;
+	assertIEq(0, u8_script_runs("\xE0\xA5\xA4\xE0\xA6\x95" "a", record, &r));
+	assertUEq(2, r.n);
+	assertIEq(USCRIPT_BENGALI, r.scripts[0]);
+	assertUEq(2, r.chars[0]);
+	assertIEq(USCRIPT_LATIN, r.scripts[1]);
+}
+
+TEST(script_runs_stop)
+{
+	struct Runs r = { 0 };
+	r.n = 8;
+	assertIEq(1, u8_script_runs("a" "\xCE\xB1", record, &r));
+	// sized prefixes
+	r.n = 0;
+	assertIEq(0, u8z_script_runs("ab" "\xCE\xB1", MAX_CHARS(2), record, &r));
+	assertUEq(1, r.n);
+	assertUEq(2, r.bytes[0]);
+}
@@ -0,0 +1,86 @@
+#include "common.h"
+#include "unic.h"
+
+/** Checks that a split produces exactly the given fields, in order */
+static void assertFields(u8split_t it, size_t n, const char *fields[n])
+{
+	u8slice_t s;
+
+	for(size_t i = 0; i < n; ++i)
+	{
+		assertTrue(u8split_next(&it, &s), " at field %zu", i);
+		assertUEq(strlen(fields[i]), s.size.byteCount, " at field %zu", i);
+		assertTrue(memcmp(fields[i], s.bytes, s.size.byteCount) == 0, " at field %zu", i);
+	}
+
+	assertTrue(! u8split_next(&it, &s));
+}
+
+TEST(split_keeps_empty_fields)
+{
+	const char *fields[] = { "a", "", "b" "\xC3\xBC", "" };
+	assertFields(u8_split(u8slice("a,,b" "\xC3\xBC" ",", NUL_TERMINATED), ','), 4, fields);
+
+	const char *empty[] = { "" };
+	assertFields(u8_split(u8slice("", NUL_TERMINATED), ','), 1, empty);
+}
+
+TEST(split_unicode_delimiter)
+{
+	const char *fields[] = { "x", "y", "z" };
+	// U+00A6 BROKEN BAR, once properly and once over-encoded
+	assertFields(u8_split(u8slice("x" "\xC2\xA6" "y" "\xE0\x82\xA6" "z", NUL_TERMINATED), 0xA6), 3, fields);
+}
+
+TEST(split_offsets)
+{
+	const char str[] = "\xC3\xBC" "ber,alles";
+	u8split_t it = u8_split(u8slice(str, NUL_TERMINATED), ',');
+	u8slice_t s;
+
+	assertTrue(u8split_next(&it, &s));
+	assertUEq(0, s.byteOffset);
+	assertUEq(4, s.size.charCount);
+
+	assertTrue(u8split_next(&it, &s));
+	assertPEq(str + 6, s.bytes);
+	assertUEq(6, s.byteOffset);
+	assertUEq(5, s.charOffset);
+	assertUEq(5, s.size.charCount);
+}
+
+TEST(split_ws_skips_runs)
+{
+	const char *fields[] = { "foo", "bar", "baz" };
+	// includes U+3000 IDEOGRAPHIC SPACE
+	assertFields(u8_split_ws(u8slice("  foo\t\n bar" "\xE3\x80\x80" "baz ", NUL_TERMINATED)), 3, fields);
+	assertFields(u8_split_ws(u8slice(" \r\n ", NUL_TERMINATED)), 0, NULL);
+}
+
+TEST(lines_terminators)
+{
+	const char *fields[] = { "one", "", "two", "three" };
+	assertFields(u8_lines(u8slice("one\n\ntwo\r\nthree\n", NUL_TERMINATED)), 4, fields);
+	assertFields(u8_lines(u8slice("", NUL_TERMINATED)), 0, NULL);
+
+	const char *single[] = { "x" };
+	assertFields(u8_lines(u8slice("x", NUL_TERMINATED)), 1, single);
+
+	// a final CR without LF isn't a line terminator
+	const char *cr[] = { "a\r" }, *crlf[] = { "a", "b\r" };
+	assertFields(u8_lines(u8slice("a\r", NUL_TERMINATED)), 1, cr);
+	assertFields(u8_lines(u8slice("a\r\nb\r", NUL_TERMINATED)), 2, crlf);
+}
+
+/** Splitting at a character that doesn't occur yields the input verbatim */
+TEST(split_no_delimiter, str_t, str)
+{
+	u8split_t it = u8_split(u8slice(str.bytes, EXACT_BYTES(str.size)), 0x10FFFF);
+	u8slice_t s;
+
+	assertTrue(u8split_next(&it, &s));
+	assertPEq(str.bytes, s.bytes);
+	assertUEq(str.size, s.size.byteCount);
+	assertUEq(str.count, s.size.charCount);
+	assertTrue(! u8split_next(&it, &s));
+}
@@ -0,0 +1,139 @@
+#include "common.h"
+#include "unic.h"
+#include <stdlib.h>
+
+/** Checks that every string compares equal to itself and every sized prefix compares less */
+TEST(strcmp_reflexive, str_t, str)
+{
+	assertIEq(0, u8z_strcmp(str.bytes, EXACT_BYTES(str.size), str.bytes, EXACT_BYTES(str.size)));
+	assertIEq(0, u8z_strcmpI(str.bytes, EXACT_BYTES(str.size), str.bytes, EXACT_BYTES(str.size)));
+
+	if(str.count)
+		assertTrue(u8z_strcmp(str.bytes, MAX_CHARS(str.count - 1), str.bytes, EXACT_BYTES(str.size)) < 0);
+}
+
+TEST(strcmp_codepoint_order)
+{
+	assertIEq(0, u8_strcmp("", ""));
+	assertTrue(u8_strcmp("", "a") < 0);
+	assertTrue(u8_strcmp("abc", "abd") < 0);
+	assertTrue(u8_strcmp("abd", "abc") > 0);
+	assertTrue(u8_strcmp("ab", "abc") < 0);
+	// U+00FF vs U+0100 differ only in the last byte after a shared lead
+	assertTrue(u8_strcmp("x" "\xC3\xBF", "x" "\xC4\x80") < 0);
+	// over-encoded 'a' is the same character
+	assertIEq(0, u8_strcmp("b" "\xC1\xA1", "ba"));
+	assertTrue(u8_strcmp("b" "\xC1\xA1", "bb") < 0);
+}
+
+TEST(strcmpI_folds)
+{
+	assertIEq(0, u8_strcmpI("Hello", "hELLO"));
+	assertIEq(0, u8_strcmpI("\xC3\x84" "rger", "\xC3\xA4" "RGER"));
+	assertTrue(u8_strcmpI("apple", "Banana") < 0);
+	assertTrue(u8_strcmpI("Zebra", "apple") > 0);
+	assertTrue(u8_strcmpI("abc", "ABCD") < 0);
+}
+
+/** Checks that a sorted array is ordered with respect to a comparison */
+static void assertSorted(const char **strings, size_t n, int (*cmp)(const char*, const char*))
+{
+	for(size_t i = 1; i < n; ++i)
+		assertTrue(cmp(strings[i - 1], strings[i]) <= 0, " at index %zu: '%s' > '%s'", i, strings[i - 1], strings[i]);
+}
+
+TEST(sort_small)
+{
+	const char *strings[] = { "pear", "", "\xC3\xA4pfel", "apple", "Apple", "app", "b" "\xC1\xA1", "ba", "\xE2\x82\xAC" };
+	const size_t n = sizeof(strings) / sizeof(*strings);
+
+	assertIEq(0, u8_sort(strings, n, 0));
+	assertSorted(strings, n, u8_strcmp);
+	assertSEq("", strings[0]);
+	// stable: over-encoded and proper 'ba' keep their relative order
+	assertSEq("b" "\xC1\xA1", strings[4]);
+	assertSEq("ba", strings[5]);
+
+	assertIEq(0, u8_sort(strings, n, U8SORT_BYTES));
+
+	for(size_t i = 1; i < n; ++i)
+		assertTrue(strcmp(strings[i - 1], strings[i]) <= 0, " at index %zu", i);
+
+	assertIEq(0, u8_sort(strings, n, U8SORT_FOLD));
+	assertSorted(strings, n, u8_strcmpI);
+}
+
+/** Checks that characters that are alike in several ways still compare consistently */
+TEST(strcmpI_transitive)
+{
+	// s, LONG S, t, K, k, KELVIN SIGN
+	const char *chars[] = { "s", "\xC5\xBF", "t", "K", "k", "\xE2\x84\xAA" };
+	const size_t n = sizeof(chars) / sizeof(*chars);
+
+	assertIEq(0, u8_strcmpI("s", "\xC5\xBF"));
+	assertIEq(0, u8_strcmpI("k", "\xE2\x84\xAA"));
+
+	for(size_t i = 0; i < n; ++i)
+	{
+		for(size_t j = 0; j < n; ++j)
+		{
+			const int ij = u8_strcmpI(chars[i], chars[j]);
+			assertIEq(-ij, u8_strcmpI(chars[j], chars[i]), " for %zu and %zu", i, j);
+
+			for(size_t k = 0; k < n; ++k)
+			{
+				const int jk = u8_strcmpI(chars[j], chars[k]), ik = u8_strcmpI(chars[i], chars[k]);
+
+				if(ij <= 0 && jk <= 0)
+					assertTrue(ik <= 0, " for %zu, %zu and %zu", i, j, k);
+				if(ij == 0 && jk == 0)
+					assertIEq(0, ik, " for %zu, %zu and %zu", i, j, k);
+			}
+		}
+	}
+
+	const char *sorted[] = { "t", "\xE2\x84\xAA", "\xC5\xBF", "k", "s", "K" };
+	assertIEq(0, u8_sort(sorted, n, U8SORT_FOLD));
+	assertSorted(sorted, n, u8_strcmpI);
+}
+
+/** Sorts enough strings to exercise the radix passes and the thread pool */
+TEST(sort_large)
+{
+	const size_t n = 100000;
+	const char **strings = malloc(n * sizeof(char*));
+	char *pool = malloc(n * 16);
+	assertTrue(strings && pool);
+
+	// a small alphabet of mixed encoded lengths causes deep, shared prefixes
+	static const char *alphabet[] = { "a", "b", "\xC3\xA4", "\xE2\x82\xAC", "\xF0\x9F\x98\x80" };
+	unsigned seed = 12345;
+
+	for(size_t i = 0; i < n; ++i)
+	{
+		char *s = pool + 16 * i;
+		size_t len = 0;
+
+		seed = seed * 1103515245 + 12345;
+		for(unsigned k = (seed >> 16) % 4 + 1; k--; )
+		{
+			seed = seed * 1103515245 + 12345;
+			const char *c = alphabet[(seed >> 16) % 5];
+			strcpy(s + len, c);
+			len += strlen(c);
+		}
+
+		strings[i] = s;
+	}
+
+	assertIEq(0, u8_sort(strings, n, U8SORT_PARALLEL));
+	assertSorted(strings, n, u8_strcmp);
+
+	assertIEq(0, u8_sort(strings, n, U8SORT_PARALLEL | U8SORT_BYTES));
+
+	for(size_t i = 1; i < n; ++i)
+		assertTrue(strcmp(strings[i - 1], strings[i]) <= 0, " at index %zu", i);
+
+	free(strings);
+	free(pool);
+}
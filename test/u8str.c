@@ -0,0 +1,103 @@
+#include "common.h"
+#include "unic.h"
+
+/** Checks that a string's characters can be indexed and converted back */
+TEST(str_round_trip, str_t, str)
+{
+	u8str_t s;
+	assertIEq(0, u8str_init(&s, str.bytes, EXACT_BYTES(str.size)));
+	assertUEq(str.count, s.length);
+
+	for(size_t i = 0; i < str.count; ++i)
+		assertCEq(str.chars[i], u8str_at(s, i), " at %zu", i);
+
+	assertCEq(UEOF, u8str_at(s, str.count));
+
+	char *back = malloc(str.size + 1);
+	const u8size_t n = u8str_encode(s, back, str.size, false);
+	assertTrue(n.bytesExact);
+	assertUEq(str.size, n.byteCount);
+	assertUEq(str.count, n.charCount);
+	assertTrue(memcmp(str.bytes, back, str.size) == 0);
+
+	free(back);
+	u8str_free(&s);
+}
+
+TEST(str_widths)
+{
+	const char *strs[] = { "", "plain", "Gr\xC3\xBC\xC3\x9F" "e", "\xE2\x82\xAC" "5", "a\xF0\x9F\x98\x80" };
+	const unsigned widths[] = { 1, 1, 1, 2, 4 };
+	const size_t lengths[] = { 0, 5, 5, 2, 2 };
+
+	for(size_t i = 0; i < sizeof(strs) / sizeof(*strs); ++i)
+	{
+		u8str_t s;
+		assertIEq(0, u8str_init(&s, strs[i], NUL_TERMINATED));
+		assertUEq(widths[i], s.width, " at %zu", i);
+		assertUEq(lengths[i], s.length, " at %zu", i);
+
+		char out[16];
+		assertSEq(strs[i], (u8str_encode(s, out, sizeof(out), true), out));
+		u8str_free(&s);
+	}
+
+	// an invalid byte is read as Windows-1252, an encoded surrogate is replaced
+	u8str_t s;
+	assertIEq(0, u8str_init(&s, "\x80\xED\xA0\x80", NUL_TERMINATED));
+	assertUEq(2, s.width);
+	assertCEq(0x20AC, u8str_at(s, 0));
+	assertCEq(0xFFFD, u8str_at(s, 1));
+	u8str_free(&s);
+}
+
+TEST(str_slice)
+{
+	u8str_t s;
+	assertIEq(0, u8str_init(&s, "a\xC3\xA9\xF0\x9F\x98\x80z", NUL_TERMINATED));
+	assertUEq(4, s.length);
+
+	const u8str_t t = u8str_slice(s, 1, 3);
+	assertUEq(2, t.length);
+	assertUEq(4, t.width);
+	assertCEq(0xE9, u8str_at(t, 0));
+	assertCEq(0x1F600, u8str_at(t, 1));
+	assertCEq(UEOF, u8str_at(t, 2));
+
+	char out[16];
+	assertUEq(7, u8str_encode(t, out, sizeof(out), true).byteCount);
+	assertSEq("\xC3\xA9\xF0\x9F\x98\x80", out);
+
+	// out of range bounds are clamped
+	assertUEq(0, u8str_slice(s, 3, 1).length);
+	assertUEq(1, u8str_slice(s, 3, 10).length);
+	assertUEq(0, u8str_slice(t, 5, 10).length);
+
+	// freeing a slice does nothing
+	u8str_t u = t;
+	u8str_free(&u);
+	assertCEq('a', u8str_at(s, 0));
+	u8str_free(&s);
+}
+
+TEST(str_encode_into)
+{
+	u8str_t s;
+	assertIEq(0, u8str_init(&s, "x\0\xC3\xA9", EXACT_BYTES(4)));
+	assertUEq(3, s.length);
+
+	char arena[4];
+	u8buf_t buf = u8buf_init(arena, sizeof(arena), true);
+	const u8size_t n = u8str_encode_into(s, &buf);
+	assertTrue(n.bytesExact);
+	assertUEq(5, n.byteCount);
+	assertUEq(3, n.charCount);
+
+	char *res = u8buf_finish(&buf, NULL);
+	assertSEq("x" UNUL "\xC3\xA9", res);
+
+	if(res != arena)
+		free(res);
+
+	u8str_free(&s);
+}
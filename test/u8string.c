@@ -257,3 +257,40 @@ TEST(hash_prefix)
 	assertUEq(u8z_hash(a, EXACT_CHARS(3)), u8z_hash(b, EXACT_CHARS(3)));
 	assertUNEq(u8z_hash(a, EXACT_CHARS(4)), u8z_hash(b, EXACT_CHARS(4)));
 }
+
+TEST(scan_ident)
+{
+	assertUEq(0, u8_scan_ident("").byteCount);
+	assertUEq(0, u8_scan_ident("1abc").byteCount);
+	assertUEq(0, u8_scan_ident(" abc").byteCount);
+	assertUEq(3, u8_scan_ident("abc+d").byteCount);
+	assertUEq(4, u8_scan_ident("_a_1").byteCount);
+	assertUEq(40, u8_scan_ident("a_very_long_identifier_name_of_40_bytes_(x)").byteCount);
+
+	const u8size_t n = u8_scan_ident("gr" "\xC3\xB6\xC3\x9F" "e_und_noch_ein_bisschen_mehr_text" "\xCC\x81" " = 1");
+	assertUEq(41, n.byteCount);
+	assertUEq(38, n.charCount);
+
+	assertUEq(2, u8z_scan_ident("abcdef", MAX_CHARS(2)).byteCount);
+	assertUEq(3, u8z_scan_ident("abc\0def", EXACT_BYTES(7)).byteCount);
+
+	// exact sizes are scanned in vector blocks, so stop at every position within and at the edges of a block
+	char buf[70];
+	// bytes just outside of the letter, digit and underscore ranges, and a non-identifier character
+	static const char *const stops[] = { "@", "[", "`", "{", "/", ":", "^", "-", "\xE2\x82\xAC" };
+
+	for(size_t k = 0; k < sizeof(stops) / sizeof(*stops); ++k)
+	{
+		for(size_t pos = 1; pos < 64; ++pos)
+		{
+			for(size_t i = 0; i < sizeof(buf); ++i)
+				buf[i] = "aZ_9"[i % 4];
+
+			memcpy(buf + pos, stops[k], strlen(stops[k]));
+			assertUEq(pos, u8z_scan_ident(buf, EXACT_BYTES(sizeof(buf))).byteCount, " with %s at %zu", stops[k], pos);
+		}
+	}
+
+	memset(buf, 'x', sizeof(buf));
+	assertUEq(sizeof(buf), u8z_scan_ident(buf, EXACT_BYTES(sizeof(buf))).byteCount);
+}
@@ -333,4 +333,335 @@ TEST(nullFree)
 	const char data[] = "THis is meaningless example text.";
 	u8file_t f = u8txt_load(data, sizeof(data) - 1, NULL);
 	u8txt_free(f);
-}
\ No newline at end of file
+}
+
+/** Checks that splitting the index between threads doesn't change any location */
+TEST(parallel_load)
+{
+	// mixes every sequence length with broken and cut off sequences, so that chunks may start anywhere in a character
+	static const char *const pieces[] = { "a", "\n", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\x80", "\xE2\x82", "\xF8" };
+	const size_t size = (5 << 20) + 1234;
+	char *buffer = malloc(size);
+
+	if(! buffer)
+		testFailure("Malloc failure");
+
+	for(size_t i = 0; i < size; )
+	{
+		const char *p = pieces[rand() % (sizeof(pieces) / sizeof(*pieces))];
+
+		for(; *p && i < size; ++p)
+			buffer[i++] = *p;
+	}
+
+	const unsigned prev = u8txt_threads(1);
+	u8file_t seq = u8txt_load(buffer, size, NULL);
+	u8txt_threads(4);
+	u8file_t par = u8txt_load(buffer, size, NULL);
+	u8txt_threads(prev);
+
+	assertUEq(seq->size.charCount, par->size.charCount);
+	assertUEq(seq->lines, par->lines);
+
+	for(size_t o = 0; o < size; o += 1 + rand() % 4096)
+	{
+		u8loc_t a, b;
+		assertIEq(0, u8txt_loc(seq, buffer + o, &a));
+		assertIEq(0, u8txt_loc(par, buffer + o, &b));
+		assertUEq(a.line, b.line, " at %zu", o);
+		assertUEq(a.column, b.column, " at %zu", o);
+		assertUEq(a.characterIndex, b.characterIndex, " at %zu", o);
+		assertUEq(a.charOff, b.charOff, " at %zu", o);
+	}
+
+	u8txt_free(seq);
+	u8txt_free(par);
+	free(buffer);
+}
+
+/** Checks that a tiny stride works with chunks that start within a character */
+TEST(parallel_stride)
+{
+	const size_t size = (4 << 20) + 2;
+	char *buffer = malloc(size);
+
+	if(! buffer)
+		testFailure("Malloc failure");
+
+	memcpy(buffer, "aa", 2);
+
+	for(size_t i = 2; i < size; i += 4)
+		memcpy(buffer + i, "\xF0\x9F\x98\x80", 4);
+
+	u8file_t seq = u8txt_load_ex(buffer, size, NULL, &(u8txt_opts){ .threads = 1 });
+	u8file_t par = u8txt_load_ex(buffer, size, NULL, &(u8txt_opts){ .stride = 1, .threads = 4 });
+
+	assertUEq(seq->size.charCount, par->size.charCount);
+	assertUEq(seq->lines, par->lines);
+
+	for(size_t o = 0; o < size; o += 1 + rand() % 4096)
+	{
+		u8loc_t a, b;
+		assertIEq(0, u8txt_loc(seq, buffer + o, &a));
+		assertIEq(0, u8txt_loc(par, buffer + o, &b));
+		assertUEq(a.characterIndex, b.characterIndex, " at %zu", o);
+		assertUEq(a.charOff, b.charOff, " at %zu", o);
+	}
+
+	u8txt_free(seq);
+	u8txt_free(par);
+	free(buffer);
+}
+
+/** Checks that over-encoded newlines and malformed sequences are counted like decoding does */
+TEST(malformed_load)
+{
+	// 11 characters, 4 of them newlines
+	const char piece[] = "ab\xC0\x8A" "cd\xE0\x80\x8A\xF0\x80\x80\x8A\x80\xE2\x82\n";
+	const size_t n = sizeof(piece) - 1, reps = 500;
+	char *buffer = malloc(n * reps);
+
+	if(! buffer)
+		testFailure("Malloc failure");
+
+	for(size_t i = 0; i < reps; ++i)
+		memcpy(buffer + i * n, piece, n);
+
+	u8file_t f = u8txt_load(buffer, n * reps, u8txt_cleanup_free);
+	assertUEq(11 * reps, f->size.charCount);
+	assertUEq(1 + 4 * reps, f->lines);
+
+	u8loc_t loc;
+	assertIEq(0, u8txt_loc(f, buffer + 300 * n + 5, &loc));
+	assertUEq(1 + 4 * 300 + 1, loc.line);
+	assertUEq(2, loc.column);
+	assertUEq(11 * 300 + 4, loc.characterIndex);
+	assertUEq(0, loc.charOff);
+
+	u8txt_free(f);
+}
+
+/** Checks that over-encoded newlines are found within well-formed text, but other characters ending in 8A aren't newlines */
+TEST(overlong_newline)
+{
+	// 8 characters, 4 of them newlines, and HAIR SPACE
+	const char piece[] = "x\xE2\x80\x8Ay\xE0\x80\x8Az\xF0\x80\x80\x8A\xC0\x8A\n";
+	const size_t n = sizeof(piece) - 1, reps = 100;
+	char *buffer = malloc(n * reps);
+
+	if(! buffer)
+		testFailure("Malloc failure");
+
+	for(size_t i = 0; i < reps; ++i)
+		memcpy(buffer + i * n, piece, n);
+
+	u8file_t f = u8txt_load(buffer, n * reps, u8txt_cleanup_free);
+	assertUEq(8 * reps, f->size.charCount);
+	assertUEq(1 + 4 * reps, f->lines);
+	u8txt_free(f);
+}
+
+/** Checks that lookups don't depend on the marker stride */
+TEST(custom_stride)
+{
+	const char text[] = "Zeile eins\nZw\xC3\xB6lf \xE2\x82\xAC und \xF0\x9F\x98\x80\n\ndrei\xC3\xA4\xC3\xB6\xC3\xBC\nvier";
+	const size_t size = sizeof(text) - 1;
+	u8file_t ref = u8txt_load(text, size, NULL);
+
+	for(size_t stride = 1; stride <= 9; stride += 2)
+	{
+		u8file_t f = u8txt_load_ex(text, size, NULL, &(u8txt_opts){ .stride = stride });
+		assertUEq(ref->size.charCount, f->size.charCount);
+		assertUEq(ref->lines, f->lines);
+
+		for(size_t o = 0; o < size; ++o)
+		{
+			u8loc_t a, b;
+			assertIEq(0, u8txt_loc(ref, text + o, &a));
+			assertIEq(0, u8txt_loc(f, text + o, &b));
+			assertUEq(a.line, b.line, " at %zu with stride %zu", o, stride);
+			assertUEq(a.column, b.column, " at %zu with stride %zu", o, stride);
+			assertUEq(a.characterIndex, b.characterIndex, " at %zu with stride %zu", o, stride);
+			assertUEq(a.charOff, b.charOff, " at %zu with stride %zu", o, stride);
+		}
+
+		for(size_t i = 0; i < ref->size.charCount; ++i)
+			assertPEq(u8txt_chr(ref, i, NULL), u8txt_chr(f, i, NULL), " at %zu with stride %zu", i, stride);
+
+		u8size_t a, b;
+		assertPEq(u8txt_line(ref, 2, &a), u8txt_line(f, 2, &b));
+		assertUEq(a.byteCount, b.byteCount);
+		assertPEq(u8txt_unLoc(ref, 4, 6, NULL), u8txt_unLoc(f, 4, 6, NULL));
+		assertTrue(u8txt_unLoc(f, 4, 6, NULL) != NULL);
+
+		u8txt_free(f);
+	}
+
+	u8txt_free(ref);
+}
+
+/** Checks that a lazily loaded file is only indexed as far as it's queried, with the same results */
+TEST(lazy_load)
+{
+	const size_t nLines = 2000;
+	char *buffer = malloc(nLines * 32);
+	size_t size = 0;
+
+	if(! buffer)
+		testFailure("Malloc failure");
+
+	for(size_t i = 0; i < nLines; ++i)
+		size += sprintf(buffer + size, "Zeile %zu: \xC3\xA4\xE2\x82\xAC%s", i + 1, i + 1 < nLines ? "\n" : "");
+
+	const u8txt_opts opts = { .stride = 64, .lazy = true };
+	u8file_t ref = u8txt_load(buffer, size, NULL);
+	u8file_t f = u8txt_load_ex(buffer, size, NULL, &opts);
+
+	assertTrue(! f->size.charsExact);
+	assertUEq(0, f->lines);
+
+	u8size_t a, b;
+	const char *line = u8txt_line(f, 3, &b);
+	assertPEq(u8txt_line(ref, 3, &a), line);
+	assertUEq(a.byteCount, b.byteCount);
+	assertUEq(a.charCount, b.charCount);
+	assertPrefix("Zeile 3:", line);
+
+	u8loc_t la, lb;
+	assertPEq(u8txt_chr(ref, 200, &la), u8txt_chr(f, 200, &lb));
+	assertUEq(la.line, lb.line);
+	assertUEq(la.column, lb.column);
+
+	assertIEq(0, u8txt_loc(f, buffer + 500, &lb));
+	assertIEq(0, u8txt_loc(ref, buffer + 500, &la));
+	assertUEq(la.characterIndex, lb.characterIndex);
+	assertUEq(la.line, lb.line);
+
+	// nothing so far needed the end of the file
+	assertTrue(! f->size.charsExact);
+
+	assertPEq(u8txt_unLoc(ref, 1500, 4, NULL), u8txt_unLoc(f, 1500, 4, NULL));
+	assertTrue(u8txt_unLoc(f, nLines + 1, 1, NULL) == NULL);
+
+	assertUEq(nLines, u8txt_lines(f));
+	assertTrue(u8txt_size(f).charsExact);
+	assertUEq(ref->size.charCount, f->size.charCount);
+	assertUEq(ref->lines, f->lines);
+
+	// the last line is found without knowing the line count up front
+	u8file_t g = u8txt_load_ex(buffer, size, NULL, &opts);
+	line = u8txt_line(g, nLines, &b);
+	assertPrefix("Zeile 2000:", line);
+	assertUEq(size - (line - buffer), b.byteCount);
+	assertTrue(u8txt_line(g, nLines + 1, NULL) == NULL);
+
+	u8txt_free(g);
+	u8txt_free(f);
+	u8txt_free(ref);
+	free(buffer);
+}
+
+/** Checks that lookups through the line index agree with the markers */
+TEST(line_index)
+{
+	const size_t nLines = 300;
+	char *buffer = malloc(nLines * 64);
+	size_t size = 0;
+
+	if(! buffer)
+		testFailure("Malloc failure");
+
+	// includes an overlong newline, a cut off sequence, lines longer than the stride and an empty final line
+	for(size_t i = 0; i < nLines; ++i)
+		size += sprintf(buffer + size, "%zu:%s\n", i, i % 7 == 3 ? "a\xC0\x8A" "b" : i % 5 == 1 ? "x\xE2\x82" : i % 11 == 0 ? "\xC3\xA4 lange Zeile \xE2\x82\xAC" : "");
+
+	u8file_t ref = u8txt_load_ex(buffer, size, NULL, &(u8txt_opts){ .stride = 16 });
+	u8file_t f = u8txt_load_ex(buffer, size, NULL, &(u8txt_opts){ .stride = 16, .lineIndex = true });
+	u8file_t g = u8txt_load_ex(buffer, size, NULL, &(u8txt_opts){ .stride = 16, .lineIndex = true, .lazy = true });
+
+	// the lazy index only needs the first lines
+	u8size_t a, b;
+	assertPEq(u8txt_line(ref, 5, &a), u8txt_line(g, 5, &b));
+	assertUEq(a.charCount, b.charCount);
+	assertTrue(! g->size.charsExact);
+
+	const unsigned lines = ref->lines;
+	assertUEq(nLines + nLines / 7 + 2, lines);
+
+	for(unsigned l = 1; l <= lines + 1; ++l)
+	{
+		const char *line = u8txt_line(ref, l, &a);
+		assertPEq(line, u8txt_line(f, l, &b), " in line %u", l);
+
+		if(! line)
+			continue;
+
+		assertUEq(a.byteCount, b.byteCount, " in line %u", l);
+		assertUEq(a.charCount, b.charCount, " in line %u", l);
+		assertPEq(line, u8txt_line(g, l, &b), " in line %u", l);
+		assertUEq(a.charCount, b.charCount, " in line %u", l);
+
+		for(unsigned c = 0; c <= a.charCount + 1; ++c)
+		{
+			size_t ia = 0, ib = 0;
+			const char *p = u8txt_unLoc(ref, l, c, &ia);
+			assertPEq(p, u8txt_unLoc(f, l, c, &ib), " at %u:%u", l, c);
+			assertUEq(ia, ib, " at %u:%u", l, c);
+		}
+	}
+
+	for(unsigned first = 1; first <= lines; first += 13)
+	{
+		for(unsigned last = first; last <= lines; last += 29)
+		{
+			const char *range = u8txt_lineRange(ref, first, last, &a);
+			assertPEq(range, u8txt_lineRange(f, first, last, &b), " for %u-%u", first, last);
+			assertUEq(a.byteCount, b.byteCount, " for %u-%u", first, last);
+			assertUEq(a.charCount, b.charCount, " for %u-%u", first, last);
+		}
+	}
+
+	const char *all = u8txt_lineRange(f, 1, lines, &b);
+	assertPEq(buffer, all);
+	assertUEq(size, b.byteCount);
+	assertUEq(u8txt_size(ref).charCount, b.charCount);
+	assertTrue(u8txt_lineRange(f, 2, 1, NULL) == NULL);
+	assertTrue(u8txt_lineRange(f, 1, lines + 1, NULL) == NULL);
+
+	u8txt_free(g);
+	u8txt_free(f);
+	u8txt_free(ref);
+	free(buffer);
+}
+
+/** Checks that lookups through the character index agree with the markers */
+TEST(char_index)
+{
+	const char text[] = "Zeile eins\nZw\xC3\xB6lf \xE2\x82\xAC und \xF0\x9F\x98\x80\n\xC0\x8A" "drei\xE2\x82\n\xC3\xA4\xC3\xB6\xC3\xBC\nvier\xFF";
+	const size_t size = sizeof(text) - 1;
+	u8file_t ref = u8txt_load_ex(text, size, NULL, &(u8txt_opts){ .stride = 4 });
+	const size_t chars = u8txt_size(ref).charCount;
+
+	for(size_t k = 1; k <= 13; k += 4)
+	{
+		for(int lazy = 0; lazy <= 1; ++lazy)
+		{
+			u8file_t f = u8txt_load_ex(text, size, NULL, &(u8txt_opts){ .stride = 4, .charStride = k, .lazy = lazy });
+
+			for(size_t i = 0; i <= chars; ++i)
+			{
+				u8loc_t a = {}, b = {};
+				const char *p = u8txt_chr(ref, i, &a);
+				assertPEq(p, u8txt_chr(f, i, &b), " at %zu with stride %zu", i, k);
+				assertUEq(a.line, b.line, " at %zu with stride %zu", i, k);
+				assertUEq(a.column, b.column, " at %zu with stride %zu", i, k);
+				assertUEq(a.characterIndex, b.characterIndex, " at %zu with stride %zu", i, k);
+			}
+
+			assertTrue(u8txt_chr(f, chars + 100, NULL) == NULL);
+			u8txt_free(f);
+		}
+	}
+
+	u8txt_free(ref);
+}
@@ -0,0 +1,110 @@
+#include "common.h"
+#include "unic.h"
+
+/** Checks that a string is segmented into exactly the given segments, in order */
+static void assertSegments(const char *str, size_t n, const char *segments[n])
+{
+	for(size_t i = 0; i < n; ++i)
+	{
+		const u8size_t w = u8_next_word(str);
+		assertUEq(strlen(segments[i]), w.byteCount, " at segment %zu", i);
+		assertTrue(memcmp(segments[i], str, w.byteCount) == 0, " at segment %zu", i);
+		str += w.byteCount;
+	}
+
+	assertUEq(0, u8_next_word(str).byteCount);
+}
+
+/** Checks that segments never split a string's characters and cover it exactly */
+TEST(word_cover, str_t, str)
+{
+	size_t bytes = 0, chars = 0;
+
+	while(bytes < str.size)
+	{
+		const u8size_t w = u8z_next_word(str.bytes + bytes, EXACT_BYTES(str.size - bytes));
+		assertTrue(w.byteCount > 0);
+		bytes += w.byteCount;
+		chars += w.charCount;
+	}
+
+	assertUEq(str.size, bytes);
+	assertUEq(str.count, chars);
+}
+
+TEST(word_ascii)
+{
+	const char *segments[] = { "The", " ", "quick", " ", "(", "\"", "brown", "\"", ")", " ", "fox", " ", "can't", " ", "jump", " ", "32.3", " ", "feet", ",", " ", "right", "?" };
+	assertSegments("The quick (\"brown\") fox can't jump 32.3 feet, right?", 23, segments);
+
+	const char *ids[] = { "snake_case_identifier_longer_than_a_vector", "=", "e.g", ".", " ", "a1_b2", " ", "3,5" };
+	assertSegments("snake_case_identifier_longer_than_a_vector=e.g. a1_b2 3,5", 8, ids);
+
+	// a trailing separator doesn't join
+	const char *trail[] = { "can't", "'" };
+	assertSegments("can't'", 2, trail);
+}
+
+TEST(word_lines)
+{
+	const char *segments[] = { "a", "\r\n", "\r\n", "\n", "\r", "b", "  ", "c" };
+	assertSegments("a\r\n\r\n\n\rb  c", 8, segments);
+}
+
+TEST(word_unicode)
+{
+	// COMBINING ACUTE ACCENT and SOFT HYPHEN are ignored within words
+	const char *latin[] = { "cafe" "\xCC\x81", " ", "Stra" "\xC3\x9F" "en" "\xC2\xAD" "bahn" };
+	assertSegments("cafe" "\xCC\x81" " Stra" "\xC3\x9F" "en" "\xC2\xAD" "bahn", 3, latin);
+
+	// every ideograph is a segment, katakana join up
+	const char *cjk[] = { "\xE4\xB8\x80", "\xE4\xBA\x8C", "\xE3\x82\xAB\xE3\x82\xBF\xE3\x82\xAB\xE3\x83\x8A" };
+	assertSegments("\xE4\xB8\x80\xE4\xBA\x8C\xE3\x82\xAB\xE3\x82\xBF\xE3\x82\xAB\xE3\x83\x8A", 3, cjk);
+
+	// Hebrew letters join across a double quote
+	const char *hebrew[] = { "\xD7\xA6\xD7\x94\"\xD7\x9C", " ", "\xD7\x90", "\"" };
+	assertSegments("\xD7\xA6\xD7\x94\"\xD7\x9C \xD7\x90\"", 4, hebrew);
+
+	// regional indicators pair up: DE, FR, and a lone U
+	const char *flags[] = { "\xF0\x9F\x87\xA9\xF0\x9F\x87\xAA", "\xF0\x9F\x87\xAB\xF0\x9F\x87\xB7", "\xF0\x9F\x87\xBA" };
+	assertSegments("\xF0\x9F\x87\xA9\xF0\x9F\x87\xAA" "\xF0\x9F\x87\xAB\xF0\x9F\x87\xB7" "\xF0\x9F\x87\xBA", 3, flags);
+}
+
+TEST(word_sized)
+{
+	assertUEq(3, u8z_next_word("can't", MAX_CHARS(4)).byteCount);
+	assertUEq(5, u8z_next_word("can't", MAX_CHARS(5)).byteCount);
+	assertUEq(2, u8z_next_word("ab\0cd", EXACT_BYTES(5)).byteCount);
+	assertUEq(5, u8z_next_word("ab\xCC\x81" "cd", MAX_BYTES(5)).byteCount);
+	assertUEq(4, u8z_next_word("ab\xCC\x81" "cd", MAX_CHARS(3)).byteCount);
+}
+
+TEST(words_iterator)
+{
+	const char str[] = "\xC2\xBF" "Qu" "\xC3\xA9" " tal, se" "\xC3\xB1" "or_1?";
+	u8split_t it = u8_words(u8slice(str, NUL_TERMINATED));
+	u8slice_t s;
+
+	assertTrue(u8split_next(&it, &s));
+	assertUEq(2, s.byteOffset);
+	assertUEq(1, s.charOffset);
+	assertUEq(4, s.size.byteCount);
+	assertUEq(3, s.size.charCount);
+
+	assertTrue(u8split_next(&it, &s));
+	assertPEq(str + 7, s.bytes);
+	assertUEq(5, s.charOffset);
+	assertUEq(3, s.size.charCount);
+
+	assertTrue(u8split_next(&it, &s));
+	assertUEq(12, s.byteOffset);
+	assertUEq(10, s.charOffset);
+	assertUEq(8, s.size.byteCount);
+	assertUEq(7, s.size.charCount);
+
+	assertTrue(! u8split_next(&it, &s));
+	assertTrue(! u8split_next(&it, &s));
+
+	it = u8_words(u8slice(" ... !", NUL_TERMINATED));
+	assertTrue(! u8split_next(&it, &s));
+}
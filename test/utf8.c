@@ -171,3 +171,149 @@ TEST(u8dec_underencode)
 			assertUEq(1, len);
 	}
 }
+
+typedef u8size_t (*to_units_f)(const char *str, u8size_t size, void *dst, size_t cap, bool nulTerminate);
+typedef u8size_t (*from_units_f)(const void *src, size_t size, char *dst, size_t cap, bool nulTerminate);
+
+/** Checks that transcoding to UTF-16 or UTF-32 and back reproduces a string */
+TEST(utf16_utf32_round_trip, str_t, str)
+{
+	to_units_f to[] = { u8z_to_utf16le, u8z_to_utf16be, u8z_to_utf32le, u8z_to_utf32be };
+	from_units_f from[] = { u8_from_utf16le, u8_from_utf16be, u8_from_utf32le, u8_from_utf32be };
+
+	for(size_t i = 0; i < sizeof(to) / sizeof(*to); ++i)
+	{
+		const u8size_t n = to[i](str.bytes, EXACT_BYTES(str.size), NULL, SIZE_MAX, false);
+		char *units = malloc(n.byteCount + 1), *back = malloc(str.size + 1);
+
+		assertUEq(str.count, n.charCount);
+		assertUEq(n.byteCount, to[i](str.bytes, EXACT_BYTES(str.size), units, n.byteCount, false).byteCount);
+
+		const u8size_t m = from[i](units, n.byteCount, back, str.size, false);
+		assertTrue(m.bytesExact);
+		assertUEq(str.size, m.byteCount);
+		assertUEq(str.count, m.charCount);
+		assertTrue(memcmp(str.bytes, back, str.size) == 0);
+
+		free(units);
+		free(back);
+	}
+}
+
+TEST(utf16_encoding)
+{
+	unsigned char out[32];
+	// A, e with acute, U+1D11E MUSICAL SYMBOL G CLEF
+	const u8size_t n = u8_to_utf16be("A\xC3\xA9\xF0\x9D\x84\x9E", out, sizeof(out), true);
+	assertTrue(n.bytesExact);
+	assertUEq(10, n.byteCount);
+	assertUEq(3, n.charCount);
+	assertTrue(memcmp(out, "\0A\0\xE9\xD8\x34\xDD\x1E\0\0", 10) == 0);
+
+	assertUEq(8, u8_to_utf32le("A\xC3\xA9", out, sizeof(out), false).byteCount);
+	assertTrue(memcmp(out, "A\0\0\0\xE9\0\0\0", 8) == 0);
+
+	// an encoded surrogate is replaced
+	assertUEq(4, u8_to_utf16le("\xED\xA0\x80x", out, sizeof(out), false).byteCount);
+	assertTrue(memcmp(out, "\xFD\xFFx\0", 4) == 0);
+}
+
+TEST(utf16_decoding)
+{
+	char out[32];
+	// a surrogate pair, then an unpaired low and high surrogate, then an incomplete unit
+	u8size_t n = u8_from_utf16le("\x34\xD8\x1E\xDD" "\x1E\xDD" "\x34\xD8" "a\0" "b", 11, out, sizeof(out), true);
+	assertTrue(n.bytesExact);
+	assertUEq(5, n.charCount);
+	assertSEq("\xF0\x9D\x84\x9E" "\xEF\xBF\xBD" "\xEF\xBF\xBD" "a" "\xEF\xBF\xBD", out);
+
+	// NULs are over-encoded in NUL-terminated output
+	n = u8_from_utf32be("\0\0\0a\0\0\0\0\0\x11\0\0", 12, out, sizeof(out), true);
+	assertUEq(7, n.byteCount);
+	assertSEq("a" UNUL "\xEF\xBF\xBD", out);
+	assertUEq(2, u8_from_utf32be("\0\0\0a\0\0\0\0", 8, out, sizeof(out), false).byteCount);
+}
+
+TEST(utf16_truncated)
+{
+	// long enough for the vectorized paths
+	const char str[] = "abcdefghijklmnopqrstuvwxyz0123456789" "\xC3\xA9";
+	unsigned char units[2 * sizeof(str)];
+	char back[sizeof(str)];
+
+	u8size_t n = u8_to_utf16le(str, units, 10, true);
+	assertTrue(! n.bytesExact);
+	assertUEq(10, n.byteCount);
+	assertUEq(4, n.charCount);
+	assertTrue(memcmp(units, "a\0b\0c\0d\0\0\0", 10) == 0);
+
+	// the last character doesn't fit
+	n = u8_to_utf16le(str, units, 2 * 37 - 1, false);
+	assertTrue(! n.bytesExact);
+	assertUEq(36, n.charCount);
+
+	n = u8_from_utf16le(units, 2 * 36, back, 21, true);
+	assertTrue(! n.bytesExact);
+	assertUEq(21, n.byteCount);
+	assertUEq(20, n.charCount);
+	assertSEq("abcdefghijklmnopqrst", back);
+
+	assertTrue(! u8_from_utf16le(units, 2, back, 0, true).bytesExact);
+	assertTrue(u8_from_utf16le(units, 0, back, 1, true).bytesExact);
+}
+
+TEST(cp1252_decoding)
+{
+	char out[32];
+	// EURO SIGN, a curly quote, an undefined byte, e with acute
+	u8size_t n = u8_from_cp1252("\x80 \x93x\x81\xE9", 6, out, sizeof(out), true);
+	assertTrue(n.bytesExact);
+	assertUEq(6, n.charCount);
+	assertSEq("\xE2\x82\xAC \xE2\x80\x9Cx\xC2\x81\xC3\xA9", out);
+
+	n = u8_from_latin1("\x80 \x93x\x81\xE9", 6, out, sizeof(out), true);
+	assertSEq("\xC2\x80 \xC2\x93x\xC2\x81\xC3\xA9", out);
+
+	// NULs are over-encoded in NUL-terminated output
+	assertUEq(5, u8_from_latin1("a\0b", 3, out, sizeof(out), true).byteCount);
+	assertSEq("a" UNUL "b", out);
+
+	assertTrue(! u8_from_cp1252("\x80", 1, out, 3, true).bytesExact);
+	assertUEq(3, u8_from_cp1252("\x80", 1, NULL, SIZE_MAX, false).byteCount);
+}
+
+TEST(cp1252_repair)
+{
+	char out[64];
+	// utf-8 and Windows-1252 e with acute, an over-encoded slash and an encoded surrogate
+	const u8size_t n = u8_repair_cp1252("caf\xC3\xA9 caf\xE9 \xC0\xAF \xED\xA0\x80", 17, out, sizeof(out), true);
+	assertTrue(n.bytesExact);
+	assertUEq(16, n.charCount);
+	assertSEq("caf\xC3\xA9 caf\xC3\xA9 \xC3\x80\xC2\xAF \xC3\xAD\xC2\xA0\xE2\x82\xAC", out);
+
+	assertUEq(4, u8_repair_cp1252("a" UNUL "\x9C", 4, out, sizeof(out), false).byteCount);
+	assertTrue(memcmp(out, "a\0\xC5\x93", 4) == 0);
+}
+
+TEST(cp1252_encoding)
+{
+	char out[32];
+	// EURO SIGN, e with acute, a CJK ideograph and a C1 control that is undefined in Windows-1252
+	u8size_t n = u8_to_cp1252("\xE2\x82\xAC\xC3\xA9\xE4\xB8\x80\xC2\x81\xC2\x80", out, sizeof(out), true);
+	assertTrue(n.bytesExact);
+	assertUEq(6, n.byteCount);
+	assertUEq(5, n.charCount);
+	assertSEq("\x80\xE9?\x81?", out);
+
+	n = u8_to_latin1("\xE2\x82\xAC\xC3\xA9\xE4\xB8\x80\xC2\x81\xC2\x80", out, sizeof(out), true);
+	assertSEq("?\xE9?\x81\x80", out);
+
+	// NULs can't be kept in NUL-terminated output
+	assertUEq(4, u8z_to_latin1("a\0b", EXACT_BYTES(3), out, sizeof(out), true).byteCount);
+	assertSEq("a?b", out);
+	assertUEq(3, u8z_to_latin1("a\0b", EXACT_BYTES(3), out, sizeof(out), false).byteCount);
+
+	n = u8_to_cp1252("abc\xC3\xA9", out, 4, true);
+	assertTrue(! n.bytesExact);
+	assertSEq("abc", out);
+}
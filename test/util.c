@@ -36,3 +36,36 @@ TEST(test_uchar_alike, struct Codepoint, chr)
 	assertTrue(uchar_alike(chr.codepoint, chr.simpleLower));
 	assertTrue(uchar_alike(chr.codepoint, chr.simpleUpper));
 }
+
+TEST(test_uchar_isId)
+{
+	assertTrue(uchar_isIdStart('a'));
+	assertTrue(uchar_isIdStart('Z'));
+	assertTrue(!uchar_isIdStart('_'));
+	assertTrue(!uchar_isIdStart('1'));
+	assertTrue(uchar_isIdContinue('1'));
+	assertTrue(uchar_isIdContinue('_'));
+	assertTrue(!uchar_isIdContinue('-'));
+
+	// U+00E4 LATIN SMALL LETTER A WITH DIAERESIS, U+0301 COMBINING ACUTE ACCENT
+	assertTrue(uchar_isIdStart(0xE4));
+	assertTrue(!uchar_isIdStart(0x301));
+	assertTrue(uchar_isIdContinue(0x301));
+	// U+2E2F VERTICAL TILDE is a letter, but excluded from identifiers
+	assertTrue(uchar_is(0x2E2F, UCLASS_LETTER));
+	assertTrue(!uchar_isIdStart(0x2E2F));
+	// U+4E00 CJK UNIFIED IDEOGRAPH and U+20000 within a range of ideographs
+	assertTrue(uchar_isIdStart(0x4E00));
+	assertTrue(uchar_isIdStart(0x20000));
+	assertTrue(!uchar_isIdContinue(0x110000));
+	assertTrue(!uchar_isIdContinue(0xFFFFFFFF));
+}
+
+/** Checks the bitsets against the general categories that make up the bulk of XID_Start */
+TEST(test_uchar_isId_category, struct Codepoint, chr)
+{
+	if(uchar_isIdStart(chr.codepoint))
+		assertTrue(uchar_isIdContinue(chr.codepoint));
+	if(uchar_is(chr.codepoint, UCLASS_DECIMAL_NUMBER))
+		assertTrue(uchar_isIdContinue(chr.codepoint));
+}